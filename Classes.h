@@ -14,6 +14,11 @@ http://mozilla.org/MPL/2.0/.
 //---------------------------------------------------------------------------
 class TTrack; // odcinek trajektorii
 class TEvent;
+struct TFlatAction;
+class TWorkPool;
+class TConsist; // grupa pojazdw liczona razem
+class TPhysicsThread; // wtek fizyki
+class TWorld;
 class TTrain; // pojazd sterowany
 class TDynamicObject; // pojazd w scenerii
 class TGroundNode; // statyczny obiekt scenerii
@@ -28,6 +33,8 @@ class TTextSound; // d
 class TEventLauncher;
 class TTraction; // drut
 class TTractionPowerSource; // zasilanie drutw
+class TPowerNet; // schemat zastpczy sieci trakcyjnej
+struct TPantContact; // styk podniesionego pantografu z drutem
 
 class TMoverParameters;
 namespace _mover
@@ -0,0 +1,889 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#include "system.hpp"
+#include "classes.hpp"
+#pragma hdrstop
+
+#include "Consist.h"
+#include "DynObj.h"
+#include "Globals.h"
+#include "Logs.h"
+#include "Timer.h"
+#include <fstream>
+
+//---------------------------------------------------------------------------
+#pragma package(smart_init)
+/*
+Siy na sprzgach skadu liczone jedn ptl.
+T_MoverParameters::CouplerForce() liczy si osobno dla kadego koca sprzgu,
+sigajc przez wskanik do ssiada, a potrzebne wartoci le porozrzucane
+w duych obiektach Mover. Tutaj dla kadego poczenia niewirtualnego zbierane s
+do tablic: odlego sprzgw, przesunicia, prdkoci, sztywnoci i tumienie.
+Sia jest liczona raz na poczenie, dla obu kocw naraz: kady koniec ma wasne
+poprzednie ugicie (histereza) i wasny zwrot, tak jak przy dwch wywoaniach
+CouplerForce(). Sprzgi wirtualne
+(skanowanie, samoczynne sprzganie) zostaj liczone w Mover po staremu.
+Z poczenia licz tylko pojazdy z wczon fizyk, pojazd z wyczon dostaje
+jedynie si, jak wczeniej od ssiada.
+
+Cakowanie pjawne (integrator implicit): jawne cakowanie w Mover przy sztywnych
+sprzgach wymaga kroku 0.01s. Po policzeniu si wypadkowych, dla kadego acucha
+pojazdw poczonych sprzgami ukadane s rwnania liniowego wstecznego Eulera
+na przyrost prdkoci: (M+dt*C+1.5*dt*dt*K)*dV = dt*F, gdzie C i K to pochodne
+si na sprzgach po prdkoci i przesuniciu (1.5*dt, bo przesunicie liczy Mover
+metod Adamsa-Bashfortha). Ukad jest trjdiagonalny i rozwizywany w O(n).
+Wynik jest przekazywany przez podmian FTotal, wic Mover dalej sam przesuwa
+pojazd, hamuje do zatrzymania, wykoleja i liczy zderzenia.
+
+Przewd gwny skadu (consistpipe): w UpdatePipePressure() kady pojazd przelewa
+powietrze do ssiadw jawnie, po kolei, wic fala cinienia w dugim skadzie
+przesuwa si o jeden wagon na krok. Tu przepyw przez sprzg jest linearyzowany
+(przewodno G=PF/dp przy biecych cinieniach) i dla acucha wagonw poczonych
+pneumatycznie rozwizywany jest niejawnie ukad trjdiagonalny:
+Cap*(p'-p)=dt*suma(G*(p'ssiada-p')). Wynik trafia do zbiornikw przewodu jako
+przepyw, a zawory rozrzdcze w UpdatePipePressure() odpowiadaj ju na cinienie
+po wyrwnaniu, zamiast liczy przepywy do ssiadw.
+
+Skad oddalony od kamery i pojazdu uytkownika (physicslod) jest liczony jako
+jedna masa punktowa: acuch pojazdw poczonych sprzgami dostaje wspln
+prdko z zachowaniem pdu, V'=(suma(M*V)+dt*suma(F))/suma(M), gdzie siy na
+sprzgach wewntrz acucha znosz si. Ugicia sprzgw pozostaj takie, jakie
+byy przy przeczeniu, wic po powrocie do penego modelu siy startuj z tego
+samego stanu. Grupa jest liczona raz na klatk krokami do 0.05s, a druty nad
+pantografami s szukane raz na klatk, wic pojazdy pobieraj prd z sieci
+(Ground::DistantUpdate()).
+
+Porwnanie z cakowaniem jawnym (Compare(), przy -benchmark albo w DebugMode): skad
+prbny (lokomotywa 80t i 40 wagonw po 60t) jest liczony wzorami z Mover bez pojazdw,
+na tablicach pocze, dla hamowania nagego, ruszania i szarpnicia. Odniesieniem jest
+cakowanie jawne z krokiem 0.001s, a do logu trafiaj rnice si na sprzgach, prdkoci
+i drogi dla kroku jawnego 0.01s i 0.05s oraz pjawnego 0.01s i 0.05s.
+PipeCompare() tak samo porwnuje przewd gwny lokomotywy i 60 wagonw (hamowanie nage
+i odhamowanie) z przepywami wagon po wagonie z krokiem 0.001s: czas dojcia zmiany cinienia
+do ostatniego wagonu, cinienie w nim oraz czas kroku obu sposobw.
+*/
+
+const double CouplerTune = 0.1; // skalowanie tumiennoci, jak w mover.pas
+const int iCompareCars = 41; // ilo pojazdw skadu prbnego w Compare()
+const double fCompareTime[3] = {40.0, 30.0, 10.0}; //[s] czas przebiegw prbnych
+const char *cCompareName[3] = {"braking", "start", "shock"};
+const int iPipeCars = 61; // lokomotywa i 60 wagonw w PipeCompare()
+const double fPipeTime[2] = {30.0, 60.0}; //[s] czas przebiegw prbnych przewodu
+const char *cPipeName[2] = {"emergency", "release"};
+std::ofstream ConsistLog; // zapis przebiegu si w skadzie do porwna
+
+TConsist::TConsist()
+{
+    iSize = iLinks = iCars = 0;
+    pA = pB = NULL;
+    cA = cB = NULL;
+    fData = fCarData = NULL;
+    iLink = iOrder = NULL;
+    cDone = NULL;
+};
+
+TConsist::~TConsist()
+{
+    delete[] pA;
+    delete[] pB;
+    delete[] cA;
+    delete[] cB;
+    delete[] fData;
+    delete[] fCarData;
+    delete[] iLink;
+    delete[] iOrder;
+    delete[] cDone;
+};
+
+void TConsist::Resize(int n)
+{ // powikszenie tablic do (n) pocze
+    delete[] pA;
+    delete[] pB;
+    delete[] cA;
+    delete[] cB;
+    delete[] fData;
+    iSize = n;
+    pA = new TMoverParameters *[n];
+    pB = new TMoverParameters *[n];
+    cA = new char[n];
+    cB = new char[n];
+    fData = new double[22 * n];
+    fCoupleDist = fData;
+    fMoveA = fData + n;
+    fMoveB = fData + 2 * n;
+    fVelA = fData + 3 * n;
+    fVelB = fData + 4 * n;
+    fDist = fData + 5 * n;
+    fSpringC = fData + 6 * n;
+    fSpringB = fData + 7 * n;
+    fDmaxC = fData + 8 * n;
+    fDmaxB = fData + 9 * n;
+    fBeta = fData + 10 * n;
+    fFmax = fData + 11 * n;
+    fDir = fData + 12 * n;
+    fNewDist = fData + 13 * n;
+    fAbsDV = fData + 14 * n;
+    fForce = fData + 15 * n;
+    fStiff = fData + 16 * n;
+    fDamp = fData + 17 * n;
+    fLinkG = fData + 18 * n;
+    fDistB = fData + 19 * n;
+    fPatch = fData + 20 * n;
+    fForceB = fData + 21 * n;
+};
+
+void TConsist::CarsResize(int n)
+{ // powikszenie tablic pojazdw
+    delete[] fCarData;
+    delete[] iLink;
+    delete[] iOrder;
+    delete[] cDone;
+    iCars = n;
+    fCarData = new double[9 * n];
+    fDiag = fCarData;
+    fRhs = fCarData + n;
+    fSub = fCarData + 2 * n;
+    fCp = fCarData + 3 * n;
+    fDp = fCarData + 4 * n;
+    fCap = fCarData + 5 * n;
+    fPipeG = fCarData + 6 * n; // 2 na pojazd
+    fSign = fCarData + 8 * n;
+    iLink = new int[2 * n];
+    iOrder = new int[n];
+    cDone = new char[n];
+};
+
+void TConsist::Gather(TDynamicObject **cars, int n)
+{ // zebranie pocze niewirtualnych z (n) pojazdw grupy
+    TMoverParameters *a, *b;
+    int i, j, k, nb;
+    double p; // poprawka kierunku dla pojazdu odwrconego
+    if (n > iSize) // pocze jest mniej ni pojazdw
+        Resize(n + 16);
+    iLinks = 0;
+    for (i = 0; i < n; ++i)
+    {
+        a = cars[i]->MoverParameters;
+        a->iCouplerSolved = 0; // mogo zosta, jeli UpdateForce() nie zostao wywoane
+        if (!a->PhysicActivation)
+            continue; // poczenie policzy ssiad, jeli ma wczon fizyk
+        for (j = 0; j < 2; ++j)
+        {
+            b = (TMoverParameters *)a->Couplers[j].Connected;
+            if (!b || (a->Couplers[j].CouplingFlag == ctrain_virtual))
+                continue; // wirtualne zostaj w Mover
+            nb = a->Couplers[j].ConnectedNr;
+            if (nb > 1)
+                continue;
+            if ((b->Couplers[nb].Connected != a) ||
+                (b->Couplers[nb].CouplingFlag == ctrain_virtual))
+                continue; // poczenie niesymetryczne
+            if (b->PhysicActivation && (b < a))
+                continue; // oba licz, wic tylko jeden raz
+            k = iLinks++;
+            p = (j != nb) ? 1.0 : -1.0; // DirPatch() z mover.pas
+            pA[k] = a;
+            pB[k] = b;
+            cA[k] = j;
+            cB[k] = nb;
+            fCoupleDist[k] = a->Couplers[j].CoupleDist;
+            fMoveA[k] = a->dMoveLen;
+            fMoveB[k] = b->dMoveLen * p;
+            fVelA[k] = a->V;
+            fVelB[k] = p * b->V;
+            fDist[k] = a->Couplers[j].Dist;
+            fDistB[k] = b->Couplers[nb].Dist;
+            fPatch[k] = p;
+            fSpringC[k] = a->Couplers[j].SpringKC + b->Couplers[nb].SpringKC;
+            fSpringB[k] = a->Couplers[j].SpringKB + b->Couplers[nb].SpringKB;
+            fDmaxC[k] = a->Couplers[j].DmaxC + b->Couplers[nb].DmaxC;
+            fDmaxB[k] = a->Couplers[j].DmaxB + b->Couplers[nb].DmaxB;
+            fBeta[k] = (a->Couplers[j].beta + b->Couplers[nb].beta) / 2.0;
+            fFmax[k] = (a->Couplers[j].FmaxC + a->Couplers[j].FmaxB + b->Couplers[nb].FmaxC +
+                        b->Couplers[nb].FmaxB) *
+                       CouplerTune / 2.0;
+            fDir[k] = j ? 1.0 : -1.0; // DirF() z mover.pas
+        }
+    }
+};
+
+void TConsist::Forces()
+{ // obliczenie si dla wszystkich pocze, bez odwoa do pojazdw
+    int k;
+    double d, dd, dv, s, h, e, c;
+    for (k = 0; k < iLinks; ++k)
+    { // tak samo jak w T_MoverParameters::CouplerForce()
+        d = fCoupleDist[k] + 10.0 * (fDir[k] * (fMoveA[k] - fMoveB[k])); // nowe ugicie
+        dv = fVelA[k] - fVelB[k];
+        dd = fabs(d) - fabs(fDist[k]); // McZapkie-191103: poprawka na histerez
+        s = (d > 0.0) ? fSpringC[k] : fSpringB[k]; // rozciganie sprzgu albo ciskanie zderzakw
+        h = (dd > 0.0) ? 1.0 : fBeta[k]; // przy odpraniu sprysto jest tumiona
+        e = (-s * d / 2.0) * fDir[k]; // sprysto w kierunku (A)
+        c = fFmax[k] * dv * fBeta[k]; // tumienie
+        if (d == 0.0)
+            fForce[k] = fForceB[k] = 0.0;
+        else
+        { // koniec (B) ma wasne poprzednie ugicie, a jego DirF() i prdko wzgldna to
+            // wartoci dla (A) pomnoone przez -DirPatch()
+            fForce[k] = e * h - c;
+            fForceB[k] = -fPatch[k] * (e * ((fabs(d) > fabs(fDistB[k])) ? 1.0 : fBeta[k]) - c);
+        }
+        fNewDist[k] = d;
+        fAbsDV[k] = fabs(dv);
+        fStiff[k] = 10.0 * s * h / 2.0; // w CouplerForce() przesunicie jest mnoone przez 10
+        fDamp[k] = fFmax[k] * fBeta[k];
+    }
+};
+
+static void CouplerSide(TMoverParameters *m, int n, double f, double d, double dv, double dmaxc,
+                        double dmaxb)
+{ // zapisanie wyniku do jednego koca poczenia, dwiki jak w CouplerForce()
+    TCoupling &c = m->Couplers[n];
+    if ((d < -0.001) && (c.Dist >= -0.001) && (dv > 0.010)) // 090503: dwiki pracy zderzakw
+    {
+        if (SetFlag(m->SoundFlag, sound_bufferclamp))
+            if (dv > 0.5)
+                SetFlag(m->SoundFlag, sound_loud);
+    }
+    else if ((d > 0.002) && (c.Dist <= 0.002) && (dv > 0.005)) // 090503: dwiki pracy sprzgu
+    {
+        if (c.CouplingFlag > 0) // sam zderzak nie ma czym szarpn
+            if (SetFlag(m->SoundFlag, sound_couplerstretch))
+                if (dv > 0.1)
+                    SetFlag(m->SoundFlag, sound_loud);
+    }
+    c.Dist = d;
+    c.CheckCollision = (d > 0.0) ? (d > dmaxc) : (-d > dmaxb); // zderzenie
+    c.CForce = f;
+    m->iCouplerSolved |= 1 << n; // ComputeTotalForce() nie bdzie ju liczy
+};
+
+void TConsist::Scatter()
+{ // rozesanie wynikw do pojazdw
+    for (int k = 0; k < iLinks; ++k)
+    {
+        CouplerSide(pA[k], cA[k], fForce[k], fNewDist[k], fAbsDV[k], fDmaxC[k], fDmaxB[k]);
+        if (pB[k]->PhysicActivation)
+            CouplerSide(pB[k], cB[k], fForceB[k], fNewDist[k], fAbsDV[k], fDmaxC[k], fDmaxB[k]);
+        else // uzgadnianie prawa Newtona
+            pB[k]->Couplers[cB[k]].CForce = -fForce[k];
+    }
+};
+
+void TConsist::CouplerForces(TDynamicObject **cars, int n)
+{ // siy na sprzgach dla (n) pojazdw grupy, przed TDynamicObject::UpdateForce()
+    Gather(cars, n);
+    Forces();
+    Scatter();
+};
+
+void TConsist::Thomas(int m)
+{ // algorytm Thomasa dla (m) pojazdw w kolejnoci (iOrder); macierz symetryczna, wic nad
+    // przektn w wierszu (t) jest to samo co pod ni w (t+1); wynik w (fDp)
+    int t;
+    double w = fDiag[iOrder[0]];
+    fCp[0] = (m > 1) ? fSub[1] / w : 0.0;
+    fDp[0] = fRhs[iOrder[0]] / w;
+    for (t = 1; t < m; ++t)
+    {
+        w = fDiag[iOrder[t]] - fSub[t] * fCp[t - 1];
+        fCp[t] = (t + 1 < m) ? fSub[t + 1] / w : 0.0;
+        fDp[t] = (fRhs[iOrder[t]] - fSub[t] * fDp[t - 1]) / w;
+    }
+    for (t = m - 2; t >= 0; --t)
+        fDp[t] -= fCp[t] * fDp[t + 1];
+};
+
+int TConsist::Order(int i)
+{ // kolejno pojazdw acucha zaczynajcego si od pojazdu (i), elementy pod przektn oraz
+    // zwroty pojazdw wzgldem pierwszego; zwraca ilo pojazdw
+    int j, k, c, d, m = 0;
+    double s = 1.0;
+    j = i;
+    c = (iLink[2 * i] < 0) ? 1 : 0; // wychodzimy sprzgiem, na ktrym jest poczenie
+    k = -1;
+    while (!cDone[j])
+    { // uoenie kolejnoci i elementw pod przektn
+        cDone[j] = 1;
+        iOrder[m] = j;
+        fSign[m] = s;
+        fSub[m++] = (k < 0) ? 0.0 : fLinkG[k];
+        k = iLink[2 * j + c];
+        if (k < 0)
+            break; // koniec acucha
+        if (pA[k]->iConsistNo == j)
+        {
+            j = pB[k]->iConsistNo;
+            d = cB[k];
+        }
+        else
+        {
+            j = pA[k]->iConsistNo;
+            d = cA[k];
+        }
+        if (c == d)
+            s = -s; // wejcie tym samym sprzgiem - pojazd odwrcony
+        c = 1 - d; // dalej przeciwnym sprzgiem
+    }
+    return m;
+};
+
+void TConsist::Apply(TDynamicObject **cars, int m, double dt)
+{ // FTotal dobrane tak, aby wzory w Mover day przyrosty prdkoci z (fDp)
+    TMoverParameters *v;
+    double a;
+    for (int t = 0; t < m; ++t)
+    {
+        v = cars[iOrder[t]]->MoverParameters;
+        a = (2.0 * fDp[t] / dt + v->AccS) / 3.0; // przyspieszenie, ktre zapamita Mover
+        v->FTotal = v->TotalMass * (2.0 * a - v->AccS);
+    }
+};
+
+void TConsist::Chain(TDynamicObject **cars, int i, double dt)
+{ // rozwizanie ukadu dla acucha zaczynajcego si od pojazdu (i)
+    int m = Order(i);
+    Thomas(m); // (fDp) zawiera teraz przyrosty prdkoci
+    Apply(cars, m, dt);
+};
+
+void TConsist::RigidChain(TDynamicObject **cars, int i, double dt)
+{ // acuch zaczynajcy si od pojazdu (i) jako jedna masa
+    TMoverParameters *v;
+    int t, m = Order(i);
+    double mass = 0.0, p = 0.0, f = 0.0, vel;
+    for (t = 0; t < m; ++t)
+    { // pd i siy w kierunku pierwszego pojazdu
+        v = cars[iOrder[t]]->MoverParameters;
+        mass += v->TotalMass;
+        p += fSign[t] * v->TotalMass * v->V;
+        f += fSign[t] * v->FTotal; // siy na sprzgach wewntrz acucha si znosz
+    }
+    vel = (p + dt * f) / mass; // wsplna prdko po kroku
+    for (t = 0; t < m; ++t)
+        fDp[t] = fSign[t] * vel - cars[iOrder[t]]->MoverParameters->V;
+    Apply(cars, m, dt);
+};
+
+int TConsist::LinkCars(TDynamicObject **cars, int n)
+{ // przygotowanie pojazdw i pocze do rozwizywania acuchw; zwraca ilo pojazdw
+    // liczonych razem, pozostae liczy Mover po staremu
+    TMoverParameters *v;
+    int i, k, a, b, r = 0;
+    if (n > iCars)
+        CarsResize(n + 16);
+    for (i = 0; i < n; ++i)
+    {
+        v = cars[i]->MoverParameters;
+        cDone[i] = 1;
+        v->iConsistNo = -1;
+        if (!cars[i]->bEnabled || !v->PhysicActivation || (v->TotalMass <= 0.0) ||
+            TestFlag(v->DamageFlag, dtrain_out))
+            continue; // te liczy Mover po staremu
+        v->iConsistNo = i;
+        cDone[i] = 0;
+        iLink[2 * i] = iLink[2 * i + 1] = -1;
+        ++r;
+    }
+    for (k = 0; k < iLinks; ++k)
+    {
+        fLinkG[k] = 0.0;
+        a = pA[k]->iConsistNo;
+        b = pB[k]->iConsistNo;
+        if ((a >= 0) && (b >= 0))
+        {
+            iLink[2 * a + cA[k]] = k;
+            iLink[2 * b + cB[k]] = k;
+        }
+    }
+    return r;
+};
+
+void TConsist::Rigid(TDynamicObject **cars, int n, double dt)
+{ // ruch oddalonego skadu jako mas punktowych, po UpdateForce() i przed przesuniciem
+    // pojazdw; poczenia musz by zebrane przez CouplerForces() w tym samym kroku
+    int i;
+    if (!LinkCars(cars, n))
+        return;
+    for (i = 0; i < n; ++i) // najpierw od kocw acuchw
+        if (!cDone[i] && ((iLink[2 * i] < 0) || (iLink[2 * i + 1] < 0)))
+            RigidChain(cars, i, dt);
+    for (i = 0; i < n; ++i)
+        if (!cDone[i])
+            RigidChain(cars, i, dt);
+};
+
+void TConsist::Integrate(TDynamicObject **cars, int n, double dt)
+{ // pjawne cakowanie ruchu wzdunego, po UpdateForce() i przed przesuniciem pojazdw;
+    // poczenia musz by zebrane przez CouplerForces() w tym samym kroku
+    TMoverParameters *v;
+    int i, k, a, b;
+    double g;
+    if (!LinkCars(cars, n))
+        return;
+    for (i = 0; i < n; ++i)
+        if (!cDone[i])
+        {
+            v = cars[i]->MoverParameters;
+            fDiag[i] = v->TotalMass;
+            fRhs[i] = dt * v->FTotal;
+        }
+    for (k = 0; k < iLinks; ++k)
+    {
+        g = dt * (fDamp[k] + 1.5 * dt * fStiff[k]); // pochodna popdu siy po prdkoci
+        a = pA[k]->iConsistNo;
+        b = pB[k]->iConsistNo;
+        if (a >= 0)
+            fDiag[a] += g;
+        if (b >= 0)
+            fDiag[b] += g; // pojazd z wyczon fizyk jest jak nieruchoma ciana
+        if ((a >= 0) && (b >= 0)) // numery pocze ustawione ju w LinkCars()
+            fLinkG[k] = (cA[k] != cB[k]) ? -g : g; // z poprawk na pojazd odwrcony
+    }
+    for (i = 0; i < n; ++i) // najpierw od kocw acuchw
+        if (!cDone[i] && ((iLink[2 * i] < 0) || (iLink[2 * i + 1] < 0)))
+            Chain(cars, i, dt);
+    for (i = 0; i < n; ++i) // zamknite w ptl (nie powinno by) liczone od dowolnego
+        if (!cDone[i])
+            Chain(cars, i, dt);
+};
+
+void TConsist::PipeChain(TDynamicObject **cars, int i)
+{ // rozwizanie przewodu gwnego dla acucha zaczynajcego si od pojazdu (i)
+    TMoverParameters *v;
+    int j, c, m = 0, t;
+    double g = 0.0, dv;
+    j = i;
+    c = (iLink[2 * i] < 0) ? 1 : 0;
+    while (!cDone[j])
+    {
+        cDone[j] = 1;
+        iOrder[m] = j;
+        fSub[m++] = -g;
+        if (iLink[2 * j + c] < 0)
+            break; // koniec acucha
+        g = fPipeG[2 * j + c];
+        v = cars[j]->MoverParameters;
+        j = iLink[2 * j + c];
+        c = 1 - v->Couplers[c].ConnectedNr; // dalej przeciwnym sprzgiem
+    }
+    Thomas(m); // (fDp) zawiera teraz nowe cinienia
+    for (t = 0; t < m; ++t)
+    {
+        v = cars[iOrder[t]]->MoverParameters;
+        dv = fCap[iOrder[t]] * (fDp[t] - v->PipePress); // objto, ktra napyna
+        if (dv * dv > 0.00000000000001)
+            v->Physic_ReActivation(); // jak w GetDVc()
+        v->Pipe->Flow(dv);
+        v->bPipeSolved = true;
+    }
+};
+
+static double PipeG(double p1, double p2, double g)
+{ // przewodno poczenia o przekroju zastpczym (g) przy cinieniach (p1) i (p2), czyli
+    // przepyw PF() podzielony przez rnic cinie
+    if (fabs(p2 - p1) > 0.000001)
+        return PF(p1, p2, g, 0.25) / (p2 - p1);
+    double ph = Max0R(p1, p2) + 1; // granica PF() przy maej rnicy cinie
+    return 197 * g * 2 * sqrt(0.25 * (ph - 0.25)) / 0.25;
+};
+
+void TConsist::PipeSolve(TDynamicObject **cars, int n, double dt)
+{ // niejawne wyrwnanie cinie w przewodzie gwnym, po UpdateForce() i przed przesuniciem
+    // pojazdw, w ktrym UpdatePipePressure() pominie ju przepywy do ssiadw
+    TMoverParameters *v, *w;
+    int i, j, b;
+    double cap, g;
+    if (n > iCars)
+        CarsResize(n + 16);
+    for (i = 0; i < n; ++i)
+    {
+        v = cars[i]->MoverParameters;
+        fCap[i] = (Max0R(v->Dim.L, 14) + 0.5) * v->Spg; // tak jak Pipe.CreateCap() w mover.pas
+        v->iConsistNo = (fCap[i] > 0.0) ? i : -1; // bez przewodu zostaje po staremu
+        cDone[i] = (fCap[i] > 0.0) ? 0 : 1;
+        iLink[2 * i] = iLink[2 * i + 1] = -1;
+    }
+    for (i = 0; i < n; ++i)
+    {
+        if (cDone[i])
+            continue;
+        v = cars[i]->MoverParameters;
+        v->PipePress = v->Pipe->P(); // bez przepyww jeszcze nie doliczonych
+        cap = fCap[i];
+        fDiag[i] = cap; // przewodnoci bd doliczone niej
+        fRhs[i] = cap * v->PipePress;
+        for (b = 0; b < 2; ++b)
+        {
+            w = (TMoverParameters *)v->Couplers[b].Connected;
+            if (!w || !TestFlag(v->Couplers[b].CouplingFlag, ctrain_pneumatic))
+                continue;
+            j = w->iConsistNo;
+            if ((j < 0) || (j >= n) ? true : cars[j]->MoverParameters != w)
+                continue; // nie ma go w grupie - zostaje GetDVc()
+            iLink[2 * i + b] = j;
+        }
+    }
+    for (i = 0; i < n; ++i)
+        for (b = 0; b < 2; ++b)
+            if ((j = iLink[2 * i + b]) >= 0)
+            { // przewodno poczenia, z obu stron tak samo
+                v = cars[i]->MoverParameters;
+                w = cars[j]->MoverParameters;
+                if (iLink[2 * j + v->Couplers[b].ConnectedNr] != i)
+                { // poczenie tylko z jednej strony - niech liczy si po staremu
+                    iLink[2 * i + b] = -1;
+                    continue;
+                }
+                // GetDVc() kadego z kocw przelewa poow, z wasnym przekrojem
+                g = PipeG(v->PipePress, w->PipePress,
+                          0.5 * (v->Spg / (1 + 0.015 / v->Spg * v->Dim.L) +
+                                 w->Spg / (1 + 0.015 / w->Spg * w->Dim.L)));
+                fPipeG[2 * i + b] = dt * g;
+                fDiag[i] += dt * g;
+            }
+    for (i = 0; i < n; ++i) // najpierw od kocw acuchw
+        if (!cDone[i] && ((iLink[2 * i] < 0) || (iLink[2 * i + 1] < 0)))
+            PipeChain(cars, i);
+    for (i = 0; i < n; ++i)
+        if (!cDone[i])
+            PipeChain(cars, i);
+};
+
+void TConsist::Log(TMoverParameters *m)
+{ // zapis stanu skadu z pojazdem (m) do "consistlog.csv", do porwnywania metod cakowania;
+    // w linii: czas, prdko, cinienie w przewodzie gwnym na obu kocach, sia najmniejsza
+    // i najwiksza oraz siy na kolejnych sprzgach [kN] (dodatnia rozciga)
+    static double fLast = -1.0;
+    double t = Timer::GetSimulationTime();
+    if (fabs(t - fLast) < 0.1)
+        return; // 10 razy na sekund
+    fLast = t;
+    if (!ConsistLog.is_open())
+    {
+        ConsistLog.open("consistlog.csv");
+        ConsistLog << "time;integrator;step;vel;pipehead;pipetail;fmin;fmax;forces\n";
+    }
+    int c = 0, n = 0;
+    T_MoverParameters *p = m, *q;
+    while ((n < 1000) && p->Couplers[c].Connected && p->Couplers[c].CouplingFlag)
+    { // przejcie na koniec od strony sprzgu 0
+        q = p->Couplers[c].Connected;
+        c = 1 - p->Couplers[c].ConnectedNr; // w nastpnym idziemy przeciwnym sprzgiem
+        p = q;
+        ++n;
+    }
+    c = 1 - c; // z powrotem przez cay skad
+    double f, fmin = 0.0, fmax = 0.0, pipe = p->PipePress; // cinienie w przewodzie na kocu
+    AnsiString s;
+    for (n = 0; (n < 1000) && p->Couplers[c].Connected && p->Couplers[c].CouplingFlag; ++n)
+    {
+        f = 0.001 * (c ? -p->Couplers[c].CForce : p->Couplers[c].CForce);
+        if (f < fmin)
+            fmin = f;
+        if (f > fmax)
+            fmax = f;
+        s += ";" + FloatToStrF(f, ffFixed, 10, 2);
+        q = p->Couplers[c].Connected;
+        c = 1 - p->Couplers[c].ConnectedNr;
+        p = q;
+    }
+    ConsistLog << FloatToStrF(t, ffFixed, 10, 2).c_str() << ";"
+               << (Global::iIntegrator ? "implicit;" : "explicit;")
+               << FloatToStrF(Global::fPhysicsStep, ffFixed, 7, 3).c_str() << ";"
+               << FloatToStrF(m->Vel, ffFixed, 7, 2).c_str() << ";"
+               << FloatToStrF(pipe, ffFixed, 7, 3).c_str() << ";"
+               << FloatToStrF(p->PipePress, ffFixed, 7, 3).c_str() << ";"
+               << FloatToStrF(fmin, ffFixed, 10, 2).c_str() << ";"
+               << FloatToStrF(fmax, ffFixed, 10, 2).c_str() << s.c_str() << "\n";
+};
+
+void TConsist::LogClose()
+{
+    if (ConsistLog.is_open())
+        ConsistLog.close();
+};
+
+void TConsist::CompareRun(int test, bool implicit, double dt, double *r)
+{ // przebieg prbny (test): 0 - hamowanie nage z 72km/h z fal hamowania wzdu skadu,
+    // 1 - ruszanie cikiego skadu, 2 - szarpnicie i najechanie lokomotyw; klatka 0.1s jak w
+    // symulacji: odlegoci sprzgw z pocztku klatki, a przesunicia narastaj w krokach;
+    // wynik (r): najwiksze ciskanie i rozciganie [kN], prdko [m/s] i droga [m] lokomotywy,
+    // numer kroku, w ktrym rozbiego si cakowanie (0, gdy stabilne)
+    const int n = iCompareCars;
+    double x[n], v[n], acc[n], move[n], mass[n], stand[n], ftrain[n], ftotal[n];
+    double t, a, f, g, dl, vprev, accprev;
+    int i, k, s, steps = int(fCompareTime[test] / dt + 0.5), frame = int(0.1 / dt + 0.5);
+    iLinks = n - 1;
+    for (i = 0; i < n; ++i)
+    {
+        mass[i] = i ? 60000.0 : 80000.0;
+        x[i] = -15.0 * i; // zderzaki si stykaj
+        v[i] = test ? 0.0 : 20.0;
+        acc[i] = move[i] = 0.0;
+        iOrder[i] = i;
+    }
+    for (k = 0; k < iLinks; ++k)
+    { // sprzgi jak w typowych .fiz, sumy dla obu kocw poczenia
+        fDist[k] = fDistB[k] = 0.0;
+        fPatch[k] = 1.0;
+        fSpringC[k] = 2.0 * 1.5e6;
+        fSpringB[k] = 2.0 * 2.5e6;
+        fBeta[k] = 0.5;
+        fFmax[k] = (2.0 * 850e3 + 2.0 * 1400e3) * CouplerTune / 2.0;
+        fDir[k] = 1.0; // sprzg 1 pojazdu (k) ze sprzgiem 0 pojazdu (k+1)
+    }
+    r[0] = r[1] = r[4] = 0.0;
+    for (s = 0; s < steps; ++s)
+    {
+        t = s * dt;
+        if (s % frame == 0)
+            for (i = 0; i < n; ++i)
+                move[i] = 0.0; // CoupleDist() na pocztku klatki
+        for (k = 0; k < iLinks; ++k)
+        {
+            fCoupleDist[k] = x[k] - x[k + 1] - 15.0 - (move[k] - move[k + 1]);
+            fMoveA[k] = move[k];
+            fMoveB[k] = move[k + 1];
+            fVelA[k] = v[k];
+            fVelB[k] = v[k + 1];
+        }
+        Forces();
+        for (k = 0; k < iLinks; ++k)
+        {
+            fDist[k] = fDistB[k] = fNewDist[k];
+            f = -0.001 * fForce[k]; // dodatnia rozciga
+            if (f < r[0])
+                r[0] = f;
+            if (f > r[1])
+                r[1] = f;
+        }
+        for (i = 0; i < n; ++i)
+        { // siy jak w ComputeTotalForce(): (ftrain) z napdem i sprzgami, (stand) opory
+            stand[i] = 0.002 * mass[i] * 9.81; // opory toczenia
+            ftrain[i] = (i < iLinks ? fForce[i] : 0.0) + (i ? fForceB[i - 1] : 0.0);
+            switch (test)
+            {
+            case 0: // fala hamowania 250m/s, pena sia po 4s
+                f = t - 0.06 * i; // czas od dojcia fali do pojazdu
+                if (f > 0.0)
+                    stand[i] += 0.08 * mass[i] * 9.81 * (f < 4.0 ? f / 4.0 : 1.0);
+                break;
+            case 1: // 300kN narastajce przez 2s
+                if (!i)
+                    ftrain[i] += 300e3 * (t < 2.0 ? t / 2.0 : 1.0);
+                break;
+            case 2: // 400kN przez 1s, potem 400kN wstecz przez 1s
+                if (!i)
+                    ftrain[i] += (t < 1.0) ? 400e3 : ((t < 2.0) ? -400e3 : 0.0);
+                break;
+            }
+            ftotal[i] = ftrain[i] - (v[i] > 0.0 ? stand[i] : (v[i] < 0.0 ? -stand[i] : 0.0));
+        }
+        if (implicit)
+        { // jak Integrate() i Apply() dla jednego acucha
+            for (i = 0; i < n; ++i)
+            {
+                fDiag[i] = mass[i];
+                fRhs[i] = dt * ftotal[i];
+            }
+            fSub[0] = 0.0;
+            for (k = 0; k < iLinks; ++k)
+            {
+                g = dt * (fDamp[k] + 1.5 * dt * fStiff[k]);
+                fDiag[k] += g;
+                fDiag[k + 1] += g;
+                fSub[k + 1] = -g;
+            }
+            Thomas(n);
+            for (i = 0; i < n; ++i)
+            {
+                a = (2.0 * fDp[i] / dt + acc[i]) / 3.0;
+                ftotal[i] = mass[i] * (2.0 * a - acc[i]);
+            }
+        }
+        for (i = 0; i < n; ++i)
+        { // jak w T_MoverParameters::ComputeMovement()
+            accprev = acc[i];
+            acc[i] = (ftotal[i] / mass[i] + accprev) / 2.0;
+            vprev = v[i];
+            v[i] += (3.0 * acc[i] - accprev) * dt / 2.0;
+            if ((v[i] * vprev <= 0.0) && (stand[i] > fabs(ftrain[i])))
+                v[i] = 0.0; // zahamowany
+            dl = (3.0 * v[i] - vprev) * dt / 2.0;
+            x[i] += dl;
+            move[i] += dl;
+            if (!(fabs(v[i]) < 100.0)) // take NaN
+                r[4] = s + 1;
+        }
+        if (r[4] > 0.0)
+            break; // dalej nie ma sensu liczy
+    }
+    r[2] = v[0];
+    r[3] = x[0];
+};
+
+void TConsist::Compare()
+{ // porwnanie cakowania pjawnego z jawnym na skadzie prbnym, wyniki do logu
+    const double step[4] = {0.01, 0.05, 0.01, 0.05}; // dwa jawne, dwa pjawne
+    TConsist c;
+    double ref[5], r[5], e;
+    AnsiString s;
+    int j, test;
+    c.Resize(iCompareCars);
+    c.CarsResize(iCompareCars);
+    for (test = 0; test < 3; ++test)
+    {
+        c.CompareRun(test, false, 0.001, ref);
+        WriteLog("Integrator compare " + AnsiString(cCompareName[test]) +
+                 ": explicit 0.001s reference, force " + FloatToStrF(ref[0], ffFixed, 7, 1) +
+                 ".." + FloatToStrF(ref[1], ffFixed, 7, 1) + "kN, vel " +
+                 FloatToStrF(ref[2], ffFixed, 7, 3) + "m/s, dist " +
+                 FloatToStrF(ref[3], ffFixed, 7, 2) + "m");
+        for (j = 0; j < 4; ++j)
+        {
+            c.CompareRun(test, j > 1, step[j], r);
+            s = "Integrator compare " + AnsiString(cCompareName[test]) +
+                (j > 1 ? ": implicit " : ": explicit ") + FloatToStrF(step[j], ffFixed, 5, 3) +
+                "s, ";
+            if (r[4] > 0.0)
+                s += "unstable after " + FloatToStrF(r[4] * step[j], ffFixed, 7, 2) + "s";
+            else
+            {
+                e = fabs(r[0] - ref[0]);
+                if (e < fabs(r[1] - ref[1]))
+                    e = fabs(r[1] - ref[1]);
+                s += "force error " + FloatToStrF(e, ffFixed, 7, 1) + "kN, vel error " +
+                     FloatToStrF(fabs(r[2] - ref[2]), ffFixed, 7, 3) + "m/s, dist error " +
+                     FloatToStrF(fabs(r[3] - ref[3]), ffFixed, 7, 2) + "m";
+            }
+            WriteLog(s);
+        }
+    }
+};
+
+void TConsist::PipeCompareRun(int test, bool implicit, double dt, double *r)
+{ // przebieg prbny przewodu gwnego (test): 0 - hamowanie nage z 0.5MPa, 1 - odhamowanie
+    // od 0.35MPa zaworem maszynisty; przepywy wagon po wagonie jak GetDVc() w kolejnych
+    // UpdatePipePressure(), albo niejawnie jak PipeSolve(); bez rozdzielaczy, z nieszczelnoci;
+    // wynik (r): czas dojcia zmiany 0.05MPa do ostatniego wagonu [s], cinienie w ostatnim
+    // wagonie w poowie i na kocu przebiegu [MPa], czas kroku [us], rozbieno (1, 0 gdy nie)
+    const int n = iPipeCars;
+    double vol[n], dvol[n], cap[n], s[n], pp[n];
+    double own, dv, src, p0, g;
+    int i, k, st, steps = int(fPipeTime[test] / dt + 0.5);
+    LARGE_INTEGER f, t0, t1;
+    for (i = 0; i < n; ++i)
+    { // jak w mover.pas: przekrj 0.792 dla lokomotywy i 0.507 dla wagonw
+        double spg = i ? 0.507 : 0.792, l = i ? 14.0 : 16.0;
+        cap[i] = (Max0R(l, 14) + 0.5) * spg;
+        s[i] = spg / (1 + 0.015 / spg * l);
+        vol[i] = cap[i] * (test ? 0.35 : 0.5);
+        dvol[i] = 0.0;
+        pp[i] = vol[i] / cap[i];
+        iOrder[i] = i;
+    }
+    p0 = pp[n - 1];
+    r[0] = -1.0;
+    r[4] = 0.0;
+    QueryPerformanceCounter(&t0);
+    for (st = 0; st < steps; ++st)
+    {
+        if (implicit)
+        { // jak PipeSolve(): ukad trjdiagonalny dla cinie na pocztku kroku
+            for (i = 0; i < n; ++i)
+            {
+                pp[i] = vol[i] / cap[i];
+                fDiag[i] = cap[i];
+                fRhs[i] = cap[i] * pp[i];
+            }
+            fSub[0] = 0.0;
+            for (k = 0; k + 1 < n; ++k)
+            {
+                g = dt * PipeG(pp[k], pp[k + 1], 0.5 * (s[k] + s[k + 1]));
+                fDiag[k] += g;
+                fDiag[k + 1] += g;
+                fSub[k + 1] = -g;
+            }
+            Thomas(n);
+            for (i = 0; i < n; ++i)
+                dvol[i] += cap[i] * (fDp[i] - pp[i]);
+        }
+        for (i = 0; i < n; ++i)
+        { // jak UpdatePipePressure(): zawr maszynisty, nieszczelno, potem ssiedzi
+            src = 0.0;
+            if (!i)
+                src = test ? dt * PF(pp[0], 0.5, 0.5, 0.25) : -dt * PF(0, pp[0], 0.15, 0.25);
+            dvol[i] += src - pp[i] * 0.001 * dt;
+            vol[i] += dvol[i];
+            dvol[i] = 0.0;
+            pp[i] = vol[i] / cap[i];
+            if (implicit)
+                continue; // przepywy do ssiadw s ju doliczone
+            own = 0.0;
+            for (k = i - 1; k <= i + 1; k += 2)
+                if ((k >= 0) && (k < n))
+                { // GetDVc(): poowa przepywu z wasnym przekrojem, ssiad dostaje przeciwny
+                    dv = 0.5 * dt * PF(pp[i], pp[k], s[i], 0.25);
+                    dvol[k] -= dv;
+                    own += dv;
+                }
+            vol[i] += own;
+            pp[i] = vol[i] / cap[i];
+        }
+        if ((r[0] < 0.0) && (fabs(pp[n - 1] - p0) > 0.05))
+            r[0] = (st + 1) * dt;
+        if (st + 1 == steps / 2)
+            r[1] = pp[n - 1];
+        if (!(fabs(pp[n - 1]) < 1.0)) // take NaN
+        {
+            r[4] = 1.0;
+            break;
+        }
+    }
+    QueryPerformanceCounter(&t1);
+    QueryPerformanceFrequency(&f);
+    r[2] = pp[n - 1];
+    r[3] = 1e6 * double(t1.QuadPart - t0.QuadPart) / (double(f.QuadPart) * (st ? st : 1));
+};
+
+void TConsist::PipeCompare()
+{ // porwnanie niejawnego przewodu gwnego z przepywami wagon po wagonie, wyniki do logu
+    const double step[3] = {0.01, 0.01, 0.05}; // wagon po wagonie, dwa niejawne
+    TConsist c;
+    double ref[5], r[5];
+    AnsiString s;
+    int j, test;
+    c.CarsResize(iPipeCars);
+    for (test = 0; test < 2; ++test)
+    {
+        c.PipeCompareRun(test, false, 0.001, ref);
+        WriteLog("Pipe compare " + AnsiString(cPipeName[test]) +
+                 ": per car 0.001s reference, last car after " +
+                 FloatToStrF(ref[0], ffFixed, 7, 2) + "s, " + FloatToStrF(ref[1], ffFixed, 7, 4) +
+                 ".." + FloatToStrF(ref[2], ffFixed, 7, 4) + "MPa");
+        for (j = 0; j < 3; ++j)
+        {
+            c.PipeCompareRun(test, j > 0, step[j], r);
+            s = "Pipe compare " + AnsiString(cPipeName[test]) +
+                (j > 0 ? ": implicit " : ": per car ") + FloatToStrF(step[j], ffFixed, 5, 3) +
+                "s, ";
+            if (r[4] > 0.0)
+                s += "unstable";
+            else
+                s += "arrival error " + FloatToStrF(fabs(r[0] - ref[0]), ffFixed, 7, 2) +
+                     "s, pressure error " +
+                     FloatToStrF(Max0R(fabs(r[1] - ref[1]), fabs(r[2] - ref[2])), ffFixed, 7, 4) +
+                     "MPa";
+            WriteLog(s + ", " + AnsiString(iPipeCars - 1) + " wagons " +
+                     FloatToStrF(r[3], ffFixed, 7, 2) + " us/step");
+        }
+    }
+};
@@ -0,0 +1,90 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef ConsistH
+#define ConsistH
+
+#include <system.hpp>
+#include "Classes.h"
+//---------------------------------------------------------------------------
+class TConsist
+{ // Ra: niezalena grupa pojazdw (skad), dla ktrej siy na sprzgach liczone s razem;
+    // dane z pojazdw s zbierane do cigych tablic, liczone jedn ptl i rozsyane z powrotem
+  private:
+    int iSize; // pojemno tablic
+    int iLinks; // ilo pocze w biecym kroku
+    TMoverParameters **pA; // pojazd liczcy si (ma wczon fizyk)
+    TMoverParameters **pB; // pojazd po drugiej stronie sprzgu
+    char *cA, *cB; // numery sprzgw w (pA) i (pB)
+    double *fData; // wsplny blok dla poniszych tablic
+    double *fCoupleDist; // odlego pomidzy sprzgami
+    double *fMoveA, *fMoveB; // przesunicia od przeliczenia odlegoci, (B) w kierunku (A)
+    double *fVelA, *fVelB; // prdkoci, (B) w kierunku (A)
+    double *fDist; // poprzednie ugicie sprzgu (A) (dla histerezy)
+    double *fDistB; // poprzednie ugicie sprzgu (B), Mover liczy histerez kadego koca osobno
+    double *fPatch; // zwrot (B) wzgldem (A): 1 albo -1 dla pojazdu odwrconego
+    double *fSpringC, *fSpringB; // suma sztywnoci sprzgw i zderzakw
+    double *fDmaxC, *fDmaxB; // suma ugi, po ktrych nastpuje zderzenie
+    double *fBeta; // rednia tumienno
+    double *fFmax; // sia tumienia
+    double *fDir; // kierunek siy dla sprzgu (A): -1 dla sprzgu 0, 1 dla sprzgu 1
+    double *fNewDist; // wynik: nowe ugicie
+    double *fAbsDV; // wynik: modu rnicy prdkoci
+    double *fForce; // wynik: sia na sprzgu pojazdu (A)
+    double *fForceB; // wynik: sia na sprzgu pojazdu (B), w jego ukadzie
+    double *fStiff; // wynik: sztywno poczenia w biecym stanie (pochodna siy po przesuniciu)
+    double *fDamp; // wynik: tumienie poczenia (pochodna siy po prdkoci)
+    double *fLinkG; // element pozadiagonalny ukadu dla poczenia
+    void Resize(int n);
+    void Gather(TDynamicObject **cars, int n);
+    void Forces();
+    void Scatter();
+    // dane pojazdw do cakowania pjawnego, indeksowane jak (cars)
+    int iCars; // pojemno tablic
+    double *fCarData; // wsplny blok dla poniszych tablic
+    double *fDiag; // przektna ukadu (masa i pochodne si)
+    double *fRhs; // prawa strona: popd siy wypadkowej w kroku
+    double *fSub; // element pod przektn dla kolejnych pojazdw acucha
+    double *fCp; // wspczynniki przejcia w przd algorytmu Thomasa
+    double *fDp;
+    double *fCap; // pojemno przewodu gwnego w pojedzie
+    double *fPipeG; // przewodno przewodu gwnego do ssiada na sprzgach 0 i 1
+    double *fSign; // zwrot pojazdu w acuchu wzgldem pierwszego (1 albo -1)
+    int *iLink; // numery pocze na sprzgach 0 i 1 (-1 gdy brak)
+    int *iOrder; // kolejno pojazdw w acuchu
+    char *cDone; // czy pojazd ju przeliczony
+    void CarsResize(int n);
+    void Thomas(int m);
+    int LinkCars(TDynamicObject **cars, int n);
+    int Order(int i);
+    void Apply(TDynamicObject **cars, int m, double dt);
+    void Chain(TDynamicObject **cars, int i, double dt);
+    void RigidChain(TDynamicObject **cars, int i, double dt);
+    void PipeChain(TDynamicObject **cars, int i);
+    void CompareRun(int test, bool implicit, double dt, double *r);
+    void PipeCompareRun(int test, bool implicit, double dt, double *r);
+
+  public:
+    TConsist();
+    ~TConsist();
+    void CouplerForces(TDynamicObject **cars, int n);
+    void Integrate(TDynamicObject **cars, int n, double dt);
+    void Rigid(TDynamicObject **cars, int n, double dt);
+    void PipeSolve(TDynamicObject **cars, int n, double dt);
+    static void Log(TMoverParameters *m);
+    static void LogClose();
+    static void Compare();
+    static void PipeCompare();
+    int Links()
+    {
+        return iLinks;
+    };
+};
+//---------------------------------------------------------------------------
+#endif
@@ -16,6 +16,7 @@ http://mozilla.org/MPL/2.0/.
 #include "PoKeys55.h"
 #include "LPT.h"
 #include "MWD.h"        // maciek001: obsluga portu COM
+#include "Replay.h"
 
 //---------------------------------------------------------------------------
 #pragma package(smart_init)
@@ -343,6 +344,8 @@ void Console::BitsUpdate(int mask)
 
 bool Console::Pressed(int x)
 { // na razie tak - czyta si tylko klawiatura
+    if (Replay::Playing()) // przy odtwarzaniu stan klawiatury jest z nagrania
+        return Global::bActive && Replay::Pressed(x);
     return Global::bActive && (GetKeyState(x) < 0);
 };
 
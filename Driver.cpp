@@ -26,6 +26,8 @@ http://mozilla.org/MPL/2.0/.
 #include "MemCell.h"
 #include "World.h"
 #include "dir.h"
+#include "SaveState.h"
+#include "TrackGraph.h"
 
 #define LOGVELOCITY 0
 #define LOGORDERS 0
@@ -388,6 +390,43 @@ void TController::TableClear()
     eSignSkip = NULL; // nic nie pomijamy
 };
 
+void TController::State()
+{ // zapis albo odtworzenie stanu AI (TSaveState)
+    // sterowanie (AIControllFlag) zostaje takie, jakie jest, tabelka prdkoci jest budowana od
+    // nowa skanowaniem toru
+    double *d[] = {&VelDesired, &VelSignal, &VelLimit, &VelSignalLast, &VelSignalNext,
+                   &VelLimitLast, &VelRoad, &VelNext, &VelforDriver, &AccDesired, &AccPreferred,
+                   &fAccDesiredAv, &ActualProximityDist, &fProximityDist, &FirstSemaphorDist,
+                   &fStopTime, &WaitingTime, &WaitingExpireTime, &fWarningDuration,
+                   &fLastStopExpDist, &fBrakeTime, &fReady, &fActionTime, &ReactionTime,
+                   &LastReactionTime, &fShuntVelocity, &fVelMax};
+    int *i[] = {&OrderPos, &OrderTop, &iDrivigFlags, &iDirection, &iDirectionOrder,
+                &iVehicleCount, &iCoupler, &iDriverFailCount, &iEngineActive, &iStationStart,
+                &iRouteWanted};
+    bool *l[] = {&Ready, &Need_TryAgain, &Need_BrakeRelease, &HelpMeFlag};
+    int k;
+    for (k = 0; k < int(sizeof(d) / sizeof(d[0])); ++k)
+        TSaveState::Field(d[k], sizeof(double));
+    for (k = 0; k < int(sizeof(i) / sizeof(i[0])); ++k)
+        TSaveState::Field(i[k], sizeof(int));
+    for (k = 0; k < int(sizeof(l) / sizeof(l[0])); ++k)
+        TSaveState::Field(l[k], sizeof(bool));
+    TSaveState::Field(OrderList, sizeof(OrderList));
+    TSaveState::Field(&eAction, sizeof(eAction));
+    TSaveState::Field(&eStopReason, sizeof(eStopReason));
+    TSaveState::Field(&vCommandLocation, sizeof(vCommandLocation));
+    TSaveState::Text(asNextStop);
+    int station = TrainParams ? TrainParams->StationIndex : 0;
+    TSaveState::Field(&station, sizeof(station));
+    if (!TSaveState::Loading())
+        return;
+    if (TrainParams)
+        TrainParams->StationIndex = station; // stacje ju odhaczone w rozkadzie
+    OrderPos = (OrderPos >= 0) && (OrderPos < maxorders) ? OrderPos : 0;
+    OrderTop = (OrderTop >= 0) && (OrderTop < maxorders) ? OrderTop : 0;
+    TableClear(); // przeskanowanie od nowego pooenia
+};
+
 TEvent * TController::CheckTrackEvent(double fDirection, TTrack *Track)
 { // sprawdzanie eventw na podanym torze do podstawowego skanowania
     TEvent *e = (fDirection > 0) ? Track->evEvent2 : Track->evEvent1;
@@ -5065,6 +5104,11 @@ TTrack * TController::BackwardTraceRoute(double &fDistance, double &fDirection,
     }
     while (s < fDistance)
     {
+        // tory, na ktrych nic nie zatrzyma skanowania, przeskakiwane po grafie
+        Track = TTrackGraph::Pass(Track, fDirection, s, fCurrentDistance, fDistance,
+                                  graph_events | graph_busy);
+        if (s >= fDistance)
+            break; // caa odlego przeskanowana
         // Track->ScannedFlag=true; //do pokazywania przeskanowanych torw
         pTrackFrom = Track; // zapamitanie aktualnego odcinka
         s += fCurrentDistance; // doliczenie kolejnego odcinka do przeskanowanej dugoci
@@ -212,6 +212,10 @@ class TController
     {
         return eAction;
     }
+    bool Shunting()
+    { // czy aktualny rozkaz jest manewrowy
+        return (OrderList[OrderPos] & Shunt) != 0;
+    }
     bool AIControllFlag; // rzeczywisty/wirtualny maszynista
     int iRouteWanted; // oczekiwany kierunek jazdy (0-stop,1-lewo,2-prawo,3-prosto) np. odpala
     // migacz lub czeka na stan zwrotnicy
@@ -328,6 +332,7 @@ class TController
   public:
     void JumpToNextOrder();
     void JumpToFirstOrder();
+    void State();
     void OrderPush(TOrders NewOrder);
     void OrderNext(TOrders NewOrder);
     inline TOrders OrderCurrentGet();
@@ -32,6 +32,7 @@ http://mozilla.org/MPL/2.0/.
 #include "Camera.h" //bo likwidujemy trzsienie
 #include "Console.h"
 #include "Traction.h"
+#include "SaveState.h"
 #pragma package(smart_init)
 
 // Ra: taki zapis funkcjonuje lepiej, ale moe nie jest optymalny
@@ -67,6 +68,7 @@ void TAnimPant::AKP_4E()
     PantWys = fLenL1 * sin(fAngleL) + fLenU1 * sin(fAngleU) + fHeight; // wysoko pocztkowa
     PantTraction = PantWys;
     hvPowerWire = NULL;
+    fWireParam = 0.5;
     fWidthExtra = 0.381; //(2.032m-1.027)/2
     // poza obszarem roboczym jest aproksymacja aman o 5 odcinkach
     fHeightExtra[0] = 0.0; //+0.0762
@@ -1115,6 +1117,42 @@ void TDynamicObject::ABuCheckMyTrack()
     iAxleFirst = 0; // pojazd powizany z przedni osi - Axle0
 }
 
+void TDynamicObject::State()
+{ // zapis albo odtworzenie stanu pojazdu (TSaveState)
+    // obecno (Mechanik) jest sprawdzana przez TGround::State() przed odczytem
+    MoverParameters->State();
+    Axle0.State();
+    Axle1.State();
+    TSaveState::Field(&iAxleFirst, sizeof(iAxleFirst));
+    // pooenie jest liczone w Move() tylko przy ruchu, wic zapisujemy wynik
+    TSaveState::Field(&vPosition, sizeof(vPosition));
+    TSaveState::Field(&vFront, sizeof(vFront));
+    TSaveState::Field(&vUp, sizeof(vUp));
+    TSaveState::Field(&vLeft, sizeof(vLeft));
+    TSaveState::Field(&modelRot, sizeof(modelRot));
+    TSaveState::Field(&mMatrix, sizeof(mMatrix));
+    TSaveState::Field(&fAdjustment, sizeof(fAdjustment));
+    if (Mechanik)
+        Mechanik->State();
+    if (!TSaveState::Loading())
+        return;
+    TTrack *t = GetTrack(); // pojazd ma by na licie toru z osi wic
+    if (t != MyTrack)
+    {
+        if (MyTrack)
+            MyTrack->RemoveDynamicObject(this);
+        if (t)
+            t->AddDynamicObject(this);
+    }
+    if (MyTrack) // osie zostay przestawione
+        MyTrack->DynamicsDirty();
+    TLocation loc; // jak w Init(), do obliczania sprzgw
+    loc.X = -vPosition.x;
+    loc.Y = vPosition.z;
+    loc.Z = vPosition.y;
+    MoverParameters->Loc = loc;
+}
+
 // Ra: w poniszej funkcji jest problem ze sprzgami
 TDynamicObject * TDynamicObject::ABuFindObject(TTrack *Track, int ScanDir,
                                                          Byte &CouplFound, double &dist)
@@ -1149,7 +1187,27 @@ TDynamicObject * TDynamicObject::ABuFindObject(TTrack *Track, int ScanDir,
             MyTranslation = 0; // szukanie w kierunku Point2 (od zera) - jestemy w Point1
         else
             MyTranslation = MinDist; // szukanie w kierunku Point1 (do zera) - jestemy w Point2
-        if (ScanDir >= 0)
+        if ((Track->iCategoryFlag & 254) == 0)
+        { // na torze kolejowym pojazdy si nie mijaj, wystarczy ssiad z uporzdkowanej listy
+            iMinDist = Track->DynamicFind(MyTranslation, ScanDir, this);
+            if (iMinDist >= 0)
+            {
+                TestDist = Track->Dynamics[iMinDist]->RaTranslationGet() - MyTranslation;
+                if (ScanDir < 0)
+                    TestDist = -TestDist;
+                if ((ScanDir >= 0) ? (TestDist <= MinDist) : (TestDist < MinDist))
+                { // jak w ptlach poniej: zwroty zgodne ze skanowaniem daj sprzg 1
+                    CouplFound = ((Track->Dynamics[iMinDist]->RaDirectionGet() > 0) ==
+                                  (ScanDir >= 0)) ?
+                                     1 :
+                                     0;
+                    MinDist = TestDist;
+                }
+                else
+                    iMinDist = -1;
+            }
+        }
+        else if (ScanDir >= 0)
         { // jeli szukanie w kierunku Point2
             for (int i = 0; i < Track->iNumDynamics; i++)
             { // ptla po pojazdach
@@ -1545,6 +1603,10 @@ TDynamicObject::TDynamicObject()
     bBrakeAcc = false;
     NextConnected = PrevConnected = NULL;
     NextConnectedNo = PrevConnectedNo = 2; // ABu: Numery sprzegow. 2=nie podczony
+    iIsland = -1; // jeszcze nie w licie
+    iSnaps = 0; // migawek pooenia jeszcze nie byo
+    bDistant = false; // peny model, dopki Ground nie sprawdzi odlegoci
+    fIdleTime = fIdlePipe = fIdleBrake = fIdleForce = 0.0;
     CouplCounter = 50; // bdzie sprawdza na pocztku
     asName = "";
     bEnabled = true;
@@ -1740,6 +1802,20 @@ TDynamicObject::Init(AnsiString Name, // nazwa pojazdu, np. "EU07-424"
     MoverParameters->BrakeLevelSet(
         MoverParameters->BrakeCtrlPos); // poprawienie hamulca po ewentualnym
     // przestawieniu przez Pascal
+    if (Global::bLookupTables && MoverParameters->Hamulec)
+    { // tarcie klockw i przyczepno z tablic wsplnych dla materiau ciernego
+        MoverParameters->pFriction =
+            TFrictionTable::Find(MoverParameters->Hamulec, MoverParameters->BrakeMethod);
+        if (!MoverParameters->pFriction->bReported)
+        { // raport odchyek tablic od wzorw, raz dla materiau
+            WriteLog("Friction table for " + Type_Name + " (material " +
+                     AnsiString(MoverParameters->BrakeMethod & 127) + "): max error " +
+                     FloatToStrF(MoverParameters->pFriction->fError, ffFixed, 9, 6) +
+                     ", adhesion max error " +
+                     FloatToStrF(TFrictionTable::fAdhesionError, ffFixed, 9, 6));
+            MoverParameters->pFriction->bReported = true;
+        }
+    }
 
     // dodatkowe parametry yB
     MoreParams += "."; // wykonuje o jedn iteracj za mao, wic trzeba mu doda
@@ -2112,9 +2188,12 @@ void TDynamicObject::Move(double fDistance)
         // na tym samym torze
         if (MoverParameters->Vel >
             2) //|[km/h]| nie ma sensu zmiana osi, jesli pojazd drga na postoju
-            iAxleFirst = (MoverParameters->V >= 0.0) ?
-                             1 :
-                             0; //[m/s] ?1:0 - aktywna druga o w kierunku jazdy
+            if (iAxleFirst != ((MoverParameters->V >= 0.0) ? 1 : 0))
+            { //[m/s] ?1:0 - aktywna druga o w kierunku jazdy
+                iAxleFirst ^= 1;
+                if (MyTrack) // pooenie pojazdu na torze liczone jest teraz od innej osi
+                    MyTrack->DynamicsDirty();
+            }
         // aktualnie eventy aktywuje druga o, eby AI nie wyczao sobie semafora
         // za szybko
     }
@@ -3167,7 +3246,8 @@ bool TDynamicObject::Update(double dt, double dt1)
                     // wstawi do GetVoltage()
                     {
                         MoverParameters->PantFrontVolt =
-                            p->hvPowerWire->VoltageGet(MoverParameters->Voltage, fPantCurrent);
+                            p->hvPowerWire->VoltageGet(MoverParameters->Voltage, fPantCurrent,
+                                                       p->fWireParam);
                         fCurrent -= fPantCurrent; // taki prd pynie przez powyszy pantograf
                     }
                     else
@@ -3192,7 +3272,8 @@ bool TDynamicObject::Update(double dt, double dt1)
                     // wstawi do GetVoltage()
                     {
                         MoverParameters->PantRearVolt =
-                            p->hvPowerWire->VoltageGet(MoverParameters->Voltage, fPantCurrent);
+                            p->hvPowerWire->VoltageGet(MoverParameters->Voltage, fPantCurrent,
+                                                       p->fWireParam);
                         fCurrent -= fPantCurrent; // taki prd pynie przez powyszy pantograf
                     }
                     else
@@ -3459,8 +3540,8 @@ bool TDynamicObject::Update(double dt, double dt1)
 	return true; // Ra: chyba tak?
 }
 
-bool TDynamicObject::FastUpdate(double dt)
-{
+bool TDynamicObject::FastUpdate(double dt, bool load)
+{ // (load)=false w wtkach pomocniczych, model adunku zmienia si potem w wtku gwnym
     if (dt == 0.0)
         return true; // Ra: pauza
     double dDOMoveLen;
@@ -3493,11 +3574,58 @@ bool TDynamicObject::FastUpdate(double dt)
     // ResetdMoveLen();
     FastMove(dDOMoveLen);
 
-    if (MoverParameters->LoadStatus)
+    if (load ? MoverParameters->LoadStatus : false)
         LoadUpdate(); // zmiana modelu adunku
     return true; // Ra: chyba tak?
 }
 
+bool TDynamicObject::Idle(double dt)
+{ // czy pojazd moe zosta pominity w przeliczaniu fizyki, (dt) - czas od poprzedniego sprawdzenia;
+    // fizyka musi by ju wyczona w Mover (stoi bez obsadzonej kabiny), a cinienia w hamulcu i
+    // siy na sprzgach nie mog si zmienia; hamulec moe by odhamowany albo zahamowany
+    if (Mechanik || MechInside || (this == Global::pUserDynamic) ||
+        MoverParameters->PhysicActivation || (MoverParameters->CabNo != 0) ||
+        !MoverParameters->CommandIn.Command.IsEmpty()) // nie wykonana komenda te budzi
+    {
+        fIdleTime = 0.0;
+        return false;
+    }
+    if ((Axle0.GetTrack() ? bool(Axle0.GetTrack()->evEventall0) : false) ||
+        (Axle1.GetTrack() ? bool(Axle1.GetTrack()->evEventall0) : false))
+    { // eventall0 jest wyzwalany przez stojcy pojazd w Move(0), scenerie wykrywaj tak postj
+        fIdleTime = 0.0;
+        return false;
+    }
+    double f = fabs(MoverParameters->Couplers[0].CForce) + fabs(MoverParameters->Couplers[1].CForce);
+    if ((fabs(MoverParameters->PipePress - fIdlePipe) > 0.0001) ||
+        (fabs(MoverParameters->BrakePress - fIdleBrake) > 0.0001) || (fabs(f - fIdleForce) > 1.0))
+    { // zmiana cinienia albo siy - liczenie czasu od nowa
+        fIdlePipe = MoverParameters->PipePress;
+        fIdleBrake = MoverParameters->BrakePress;
+        fIdleForce = f;
+        fIdleTime = 0.0;
+        return false;
+    }
+    fIdleTime += dt;
+    return (fIdleTime > 1.0); // sekunda spokoju, aby nie usypia zaraz po zatrzymaniu
+};
+
+bool TDynamicObject::VirtualContact()
+{ // czy przez sprzg wirtualny (bez poczenia) moe nastpi zderzenie w cigu klatki; takie
+    // zetknicie liczy Mover jawnie, wic wymaga krtkiego kroku
+    TCoupling *c;
+    for (int i = 0; i < 2; ++i)
+    {
+        c = MoverParameters->Couplers + i;
+        if (c->Connected ? c->CouplingFlag == ctrain_virtual : false)
+            if (c->CoupleDist < 50.0) // dalej nie dojedzie w klatce
+                if ((c->CoupleDist < 0.1) ||
+                    (fabs(MoverParameters->V) + fabs(c->Connected->V) > 0.01))
+                    return true; // styka si albo ktry jedzie
+    }
+    return false;
+};
+
 // McZapkie-040402: liczenie pozycji uwzgledniajac wysokosc szyn itp.
 // vector3 TDynamicObject::GetPosition()
 //{//Ra: pozycja pojazdu jest liczona zaraz po przesuniciu
@@ -3607,12 +3735,12 @@ void TDynamicObject::Render()
             // if (Global::pWorld->) //tu trzeba by ustawi animacje na modelu
             // zewntrznym
             glLoadIdentity(); // zacz od macierzy jedynkowej
-            Global::pCamera->SetCabMatrix(vPosition); // specjalne ustawienie kamery
+            Global::pCamera->SetCabMatrix(vRenderPos); // specjalne ustawienie kamery
         }
         else
-            glTranslated(vPosition.x, vPosition.y,
-                         vPosition.z); // standardowe przesunicie wzgldem pocztku scenerii
-        glMultMatrixd(mMatrix.getArray());
+            glTranslated(vRenderPos.x, vRenderPos.y,
+                         vRenderPos.z); // standardowe przesunicie wzgldem pocztku scenerii
+        glMultMatrixd(mRenderMatrix.getArray());
         if (fShade > 0.0)
         { // Ra: zmiana oswietlenia w tunelu, wykopie
             GLfloat ambientLight[4] = {0.5f, 0.5f, 0.5f, 1.0f};
@@ -3716,6 +3844,31 @@ void TDynamicObject::Render()
     } // yB - koniec mieszania z grafika
 };
 
+void TDynamicObject::Snapshot(int k)
+{ // zapisanie pooenia po krokach fizyki (wtek fizyki)
+    vSnapPos[k] = vPosition;
+    mSnapMatrix[k] = mMatrix;
+    if (iSnaps < 2)
+        ++iSnaps;
+};
+
+void TDynamicObject::Interpolate(int k0, int k1, double a)
+{ // pooenie do renderowania midzy migawkami (k0) i (k1); k0<0 - bez wtku fizyki
+    if ((k0 < 0) || (iSnaps < 2))
+    { // biecy stan
+        vRenderPos = vPosition;
+        mRenderMatrix = mMatrix;
+        return;
+    }
+    vRenderPos = vSnapPos[k0] + (vSnapPos[k1] - vSnapPos[k0]) * a;
+    // obrt midzy migawkami jest may, wic wystarczy liniowo po elementach
+    const double *m0 = mSnapMatrix[k0].readArray();
+    const double *m1 = mSnapMatrix[k1].readArray();
+    double *m = mRenderMatrix.getArray();
+    for (int i = 0; i < 16; ++i)
+        m[i] = m0[i] + (m1[i] - m0[i]) * a;
+};
+
 void TDynamicObject::RenderSounds()
 { // przeliczanie dwikw, bo bdzie
     // sycha bez wywietlania sektora z
@@ -4094,12 +4247,12 @@ void TDynamicObject::RenderAlpha()
                 return;
             }
             glLoadIdentity(); // zacz od macierzy jedynkowej
-            Global::pCamera->SetCabMatrix(vPosition); // specjalne ustawienie kamery
+            Global::pCamera->SetCabMatrix(vRenderPos); // specjalne ustawienie kamery
         }
         else
-            glTranslated(vPosition.x, vPosition.y,
-                         vPosition.z); // standardowe przesunicie wzgldem pocztku scenerii
-        glMultMatrixd(mMatrix.getArray());
+            glTranslated(vRenderPos.x, vRenderPos.y,
+                         vRenderPos.z); // standardowe przesunicie wzgldem pocztku scenerii
+        glMultMatrixd(mRenderMatrix.getArray());
         if (fShade > 0.0)
         { // Ra: zmiana oswietlenia w tunelu, wykopie
             GLfloat ambientLight[4] = {0.5f, 0.5f, 0.5f, 1.0f};
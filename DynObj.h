@@ -94,6 +94,7 @@ class TAnimPant
     double fAngleU; // Ra: aktualny kt ramienia grnego
     double NoVoltTime; // czas od utraty kontaktu z drutem
     TTraction *hvPowerWire; // aktualnie podczepione druty, na razie tu
+    double fWireParam; // pooenie styku na dugoci przsa <0;1>, do rozdziau prdu w sieci
     float fWidthExtra; // dodatkowy rozmiar poziomy poza cz robocz (fWidth)
     float fHeightExtra[5]; //amana symulujca ksztat nabienika
     // double fHorizontal; //Ra 2015-01: pooenie drutu wzgldem osi pantografu
@@ -164,6 +165,12 @@ class TDynamicObject
     AnsiString asTrack; // nazwa toru pocztkowego; wywali?
     AnsiString asDestination; // dokd pojazd ma by kierowany "(stacja):(tor)"
     matrix4x4 mMatrix; // macierz przeksztacenia do renderowania modeli
+    vector3 vSnapPos[3]; // pozycje zapisane przez wtek fizyki
+    matrix4x4 mSnapMatrix[3]; // macierze zapisane przez wtek fizyki
+    vector3 vRenderPos; // pozycja do renderowania (interpolowana)
+    matrix4x4 mRenderMatrix; // macierz do renderowania (interpolowana)
+    int iSnaps; // ilo zapisanych migawek (do 2), nowe pojazdy nie maj z czego interpolowa
+    bool bDistant; // skad daleko od kamery, liczony jako masa punktowa
     TMoverParameters *MoverParameters; // parametry fizyki ruchu oraz przeliczanie
     // TMoverParameters *pControlled; //wskanik do sterowanego czonu silnikowego
     TDynamicObject *NextConnected; // pojazd podczony od strony sprzgu 1 (kabina -1)
@@ -171,6 +178,12 @@ class TDynamicObject
     int NextConnectedNo; // numer sprzgu podczonego z tyu
     int PrevConnectedNo; // numer sprzgu podczonego z przodu
     double fScanDist; // odlego skanowania torw na obecno innych pojazdw
+    int iIsland; // numer w licie pojazdw przy podziale na niezalene grupy (TGround)
+  private: // stan do usypiania stojcych pojazdw
+    double fIdleTime; // czas bez zmian stanu [s]
+    double fIdlePipe; // cinienie w przewodzie gwnym przy ostatnim sprawdzeniu
+    double fIdleBrake; // cinienie w cylindrze hamulcowym przy ostatnim sprawdzeniu
+    double fIdleForce; // suma si na sprzgach przy ostatnim sprawdzeniu
 
   public: // modele skadowe pojazdu
     TModel3d *mdModel; // model puda
@@ -407,12 +420,17 @@ class TDynamicObject
     bool UpdateForce(double dt, double dt1, bool FullVer);
     void LoadUpdate();
     bool Update(double dt, double dt1);
-    bool FastUpdate(double dt);
+    bool FastUpdate(double dt, bool load = true);
+    bool Idle(double dt);
+    bool VirtualContact();
     void Move(double fDistance);
+    void State();
     void FastMove(double fDistance);
     void Render();
     void RenderAlpha();
     void RenderSounds();
+    void Snapshot(int k);
+    void Interpolate(int k0, int k1, double a);
     inline vector3 GetPosition()
     {
         return vPosition;
@@ -88,8 +88,19 @@ USEUNIT("Forth.cpp");
 USEUNIT("Console\LPT.cpp");
 USEUNIT("Console\MWD.cpp");
 USEUNIT("PyInt.cpp");
+USEUNIT("Replay.cpp");
+USEUNIT("EvProfile.cpp");
+USEUNIT("WorkPool.cpp");
+USEUNIT("Consist.cpp");
+USEUNIT("PhysThread.cpp");
+USEUNIT("SaveState.cpp");
+USEUNIT("TrackGraph.cpp");
+USEUNIT("PowerNet.cpp");
+USEUNIT("PowerTelemetry.cpp");
 //---------------------------------------------------------------------------
 #include "World.h"
+#include "Replay.h"
+#include "SaveState.h"
 
 HDC hDC = NULL; // Private GDI Device Context
 HGLRC hRC = NULL; // Permanent Rendering Context
@@ -453,14 +464,28 @@ LRESULT CALLBACK WndProc(HWND hWnd, // handle for this window
                          LPARAM lParam) // additional message information
 {
     TRect rect;
+    if (Replay::Playing() && !Replay::bFeeding)
+    { // podczas odtwarzania wejcia pochodz tylko z nagrania
+        if (Replay::IsInput(uMsg, wParam) || (uMsg == WM_COPYDATA) || (uMsg == WM_MOUSEMOVE))
+            return 0;
+    }
+    else if (Replay::Recording())
+        if (Replay::IsInput(uMsg, wParam))
+            Replay::Message(uMsg, wParam, lParam);
     switch (uMsg) // check for windows messages
     {
     case WM_PASTE: //[Ctrl]+[V] potrzebujemy do innych celw
         return 0;
     case WM_COPYDATA: // obsuga danych przesanych przez program sterujcy
         pDane = (PCOPYDATASTRUCT)lParam;
+        if (Replay::Recording())
+            Replay::Data(pDane->dwData, pDane->cbData, pDane->lpData);
         if (pDane->dwData == 'EU07') // sygnatura danych
+        { // polecenia zmieniaj stan scenerii
+            World.Lock();
             World.OnCommandGet((DaneRozkaz *)(pDane->lpData));
+            World.Unlock();
+        }
         break;
     case WM_ACTIVATE: // watch for window activate message
         // case WM_ACTIVATEAPP:
@@ -487,7 +512,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, // handle for this window
         switch (wParam) // check system calls
         {
         case 61696: // F10
+            World.Lock();
             World.OnKeyDown(VK_F10);
+            World.Unlock();
             return 0;
         case SC_SCREENSAVE: // screensaver trying to start?
         case SC_MONITORPOWER: // monitor trying to enter powersave?
@@ -510,6 +537,8 @@ LRESULT CALLBACK WndProc(HWND hWnd, // handle for this window
         GetCursorPos(&mouse);
         if (Global::bActive && ((mouse.x != mx) || (mouse.y != my)))
         {
+            if (Replay::Recording())
+                Replay::Mouse(double(mouse.x - mx) * 0.005, double(mouse.y - my) * 0.01);
             World.OnMouseMove(double(mouse.x - mx) * 0.005, double(mouse.y - my) * 0.01);
             SetCursorPos(mx, my);
         }
@@ -526,7 +555,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, // handle for this window
         {
             if (wParam != 17) // bo nacinicia [Ctrl] nie ma po co przekazywa
                 if (wParam != 145) //[Scroll Lock] te nie
+                { // klawisze poza kabin zmieniaj stan scenerii, kabinowe id kolejk
+                    World.Lock();
                     World.OnKeyDown(wParam);
+                    World.Unlock();
+                }
             switch (wParam)
             {
             case VK_ESCAPE: //[Esc] pauzuje tylko bez Debugmode
@@ -549,7 +582,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, // handle for this window
                     Global::iTextMode = VK_F1; // to wywietli zegar i informacj
                 break;
             case VK_F7:
-                if (DebugModeFlag)
+                if (DebugModeFlag && !Console::Pressed(VK_CONTROL)) // [Ctrl]+[F7] to statystyki
                 { // siatki wywietlane tyko w trybie testowym
                     Global::bWireFrame = !Global::bWireFrame;
                     ++Global::iReCompile; // odwiey siatki
@@ -618,6 +651,31 @@ LRESULT CALLBACK WndProc(HWND hWnd, // handle for this window
     return DefWindowProc(hWnd, uMsg, wParam, lParam);
 };
 
+void ReplayFeed()
+{ // przekazanie do okna wej nagranych przed kolejn klatk
+    static TReplayInput r; // spory bufor, nie na stosie
+    COPYDATASTRUCT cds;
+    Replay::bFeeding = true;
+    while (Replay::Next(r))
+        switch (r.cType)
+        {
+        case replay_message:
+            WndProc(hWnd, r.uMsg, r.wParam, r.lParam);
+            break;
+        case replay_data:
+            cds.dwData = r.dwData;
+            cds.cbData = r.cbData;
+            cds.lpData = r.cData;
+            WndProc(hWnd, WM_COPYDATA, 0, (LPARAM)&cds);
+            break;
+        case replay_mouse:
+            if (Global::bActive)
+                World.OnMouseMove(r.fX, r.fY);
+            break;
+        }
+    Replay::bFeeding = false;
+};
+
 int WINAPI WinMain(HINSTANCE hInstance, // instance
                    HINSTANCE hPrevInstance, // previous instance
                    LPSTR lpCmdLine, // command line parameters
@@ -676,10 +734,38 @@ int WINAPI WinMain(HINSTANCE hInstance, // instance
                 else
                     Global::iConvertModels = -7; // z optymalizacj, bananami i prawidowym Opacity
             }
+            else if (str == AnsiString("-record"))
+            { // nagrywanie wej sesji do pliku
+                Replay::asFile = Parser->GetNextSymbol();
+                Replay::iModeRequested = 1;
+            }
+            else if (str == AnsiString("-replay"))
+            { // odtworzenie nagranej sesji
+                Replay::asFile = Parser->GetNextSymbol();
+                Replay::iModeRequested = 2;
+            }
+            else if (str == AnsiString("-replayfast"))
+                Replay::bFast = true; // odtwarzanie bez czekania na ekran
+            else if (str == AnsiString("-fastforward"))
+            { // przewinicie czasu o podan ilo minut po wczytaniu
+                Global::fFastForward = Parser->GetNextSymbol().ToDouble();
+            }
+            else if (str == AnsiString("-benchmark"))
+            { // pomiar: ile sekund symulacji na sekund, bez renderowania, potem wyjcie
+                Global::fBenchmark = Parser->GetNextSymbol().ToDouble();
+            }
+            else if (str == AnsiString("-savestate"))
+                TSaveState::asFile = Parser->GetNextSymbol(); // plik dla [Ctrl]+[F11]
+            else if (str == AnsiString("-loadstate"))
+            { // wczytanie zapisanego stanu po wczytaniu scenerii
+                TSaveState::asFile = Parser->GetNextSymbol();
+                TSaveState::bLoadRequested = true;
+            }
             else
-                Error(
-                    "Program usage: EU07 [-s sceneryfilepath] [-v vehiclename] [-modifytga] [-e3d]",
-                    !Global::iWriteLogEnabled);
+                Error("Program usage: EU07 [-s sceneryfilepath] [-v vehiclename] [-modifytga] "
+                      "[-e3d] [-record file] [-replay file] [-replayfast] [-fastforward minutes] "
+                      "[-benchmark seconds] [-savestate file] [-loadstate file]",
+                      !Global::iWriteLogEnabled);
         }
         delete Parser; // ABu 050205: tego wczesniej nie bylo
     }
@@ -688,6 +774,7 @@ int WINAPI WinMain(HINSTANCE hInstance, // instance
         csp=csp.Delete(csp.Pos(AnsiString(strrchr(Global::szSceneryFile,'/')))+1,csp.Length());
         Global::asCurrentSceneryPath=csp;
     */
+    Replay::Open(); // odtwarzanie podmienia sceneri i pojazd z nagwka nagrania
 
     fullscreen = Global::bFullScreen;
     WindowWidth = Global::iWindowWidth;
@@ -747,14 +834,22 @@ int WINAPI WinMain(HINSTANCE hInstance, // instance
                 // DrawGLScene()
                 // if (!pause)
                 // if (Global::bInactivePause?Global::bActive:true) //tak nie, bo spada z gry
+                if (Replay::Playing())
+                    ReplayFeed(); // wejcia nagrane przed t klatk
+                // przy wtku fizyki Update() blokuje sceneri tylko na czas jej zmian,
+                // a rysowanie idzie rwnolegle z fizyk
                 if (World.Update()) // Was There A Quit Received?
-                    SwapBuffers(hDC); // Swap Buffers (Double Buffering)
+                {
+                    if (Replay::SwapNeeded()) // przy szybkim odtwarzaniu nie czekamy na ekran
+                        SwapBuffers(hDC); // Swap Buffers (Double Buffering)
+                }
                 else
                     done = true; //[F10] or DrawGLScene signalled a quit
             }
         }
         Console::Off(); // wyczenie konsoli (komunikacji zwrotnej)
     }
+    Replay::Close(); // dopisanie koca nagrania
     SystemParametersInfo(SPI_SETKEYBOARDSPEED, iOldSpeed, NULL, 0);
     SystemParametersInfo(SPI_SETKEYBOARDDELAY, iOldDelay, NULL, 0);
     delete pConsole; // deaktywania sterownika
@@ -0,0 +1,181 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#include "system.hpp"
+#include "classes.hpp"
+#pragma hdrstop
+
+#include "EvProfile.h"
+#include "Event.h"
+#include "Globals.h"
+#include "Timer.h"
+#include "Logs.h"
+
+#include <fstream>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+//---------------------------------------------------------------------------
+#pragma package(smart_init)
+/*
+Statystyka eventw scenerii.
+W kadym evencie liczone jest: dodanie do kolejki, wykonanie, niespeniony warunek.
+Po wczeniu (eventprofile yes) mierzony jest take czas wykonania (czny i najduszy),
+a ostatnie wykonania s zapamitywane do osi czasu. Klawisze [Ctrl]+[F7] (w trybie debug albo
+przy wczonym pomiarze) zapisuj:
+1. eventprofile.csv - zestawienie wg nazw (eventy o tej samej nazwie s sumowane),
+   posortowane malejco wg cznego czasu.
+2. eventtrace.json - o czasu w formacie Chrome Trace (chrome://tracing, Perfetto).
+*/
+
+const int iSampleMax = 65536; // ilo pamitanych wykona
+
+__int64 EventProfile::iFirst = 0;
+double EventProfile::fTick = 0.0;
+TEventSample *EventProfile::pSamples = NULL;
+int EventProfile::iSamples = 0;
+
+__int64 EventProfile::Start()
+{ // pocztek wykonania eventu
+    __int64 t = 0;
+    if (Global::bEventProfile)
+        QueryPerformanceCounter((LARGE_INTEGER *)&t);
+    return t;
+};
+
+void EventProfile::Stop(TEvent *e, __int64 start)
+{ // koniec wykonania eventu
+    ++e->iProfLaunched;
+    if (!Global::bEventProfile)
+        return;
+    __int64 t;
+    QueryPerformanceCounter((LARGE_INTEGER *)&t);
+    if (!pSamples)
+    { // pierwsze wykonanie
+        __int64 f;
+        QueryPerformanceFrequency((LARGE_INTEGER *)&f);
+        fTick = 1.0e6 / double(f);
+        iFirst = start;
+        pSamples = new TEventSample[iSampleMax];
+    }
+    double ms = 0.001 * fTick * double(t - start);
+    e->fProfTime += ms;
+    if (ms > e->fProfMax)
+        e->fProfMax = ms;
+    TEventSample *s = pSamples + (iSamples++ % iSampleMax);
+    s->evEvent = e;
+    s->iBegin = start;
+    s->iEnd = t;
+    s->fTime = Timer::GetTime();
+};
+
+struct TEventTotal
+{ // zsumowane dane eventw o jednej nazwie
+    AnsiString asName;
+    int iQueued, iLaunched, iFailed;
+    double fTime, fMax;
+};
+
+bool EventTotalCompare(const TEventTotal &a, const TEventTotal &b)
+{ // malejco wg czasu, a przy braku pomiaru wg iloci wykona
+    if (a.fTime != b.fTime)
+        return a.fTime > b.fTime;
+    return a.iLaunched > b.iLaunched;
+};
+
+AnsiString JsonText(const AnsiString &s)
+{ // nazwy eventw mog zawiera dowolne znaki
+    AnsiString r;
+    for (int i = 1; i <= s.Length(); ++i)
+        if ((s[i] == '"') || (s[i] == '\\'))
+            r += AnsiString("\\") + s[i];
+        else if ((unsigned char)s[i] >= ' ')
+            r += s[i];
+    return r;
+};
+
+bool EventProfile::Dump(TEvent *root)
+{ // zapis statystyki oraz osi czasu
+    std::map<AnsiString, int> index;
+    std::vector<TEventTotal> list;
+    std::map<AnsiString, int>::iterator it;
+    TEventTotal *t;
+    int i;
+    for (TEvent *e = root; e; e = e->evNext2)
+    {
+        it = index.find(e->asName);
+        if (it == index.end())
+        { // pierwszy z t nazw
+            index[e->asName] = list.size();
+            TEventTotal n;
+            n.asName = e->asName;
+            n.iQueued = n.iLaunched = n.iFailed = 0;
+            n.fTime = n.fMax = 0.0;
+            list.push_back(n);
+            t = &list.back();
+        }
+        else
+            t = &list[it->second];
+        t->iQueued += e->iProfQueued;
+        t->iLaunched += e->iProfLaunched;
+        t->iFailed += e->iProfFailed;
+        t->fTime += e->fProfTime;
+        if (e->fProfMax > t->fMax)
+            t->fMax = e->fProfMax;
+    }
+    std::sort(list.begin(), list.end(), EventTotalCompare);
+    std::ofstream csv("eventprofile.csv");
+    if (!csv.is_open())
+    {
+        ErrorLog("Cannot write eventprofile.csv");
+        return false;
+    }
+    csv << "name;queued;launched;failed;total_ms;max_ms;avg_us\n";
+    for (i = 0; i < int(list.size()); ++i)
+        if (list[i].iQueued || list[i].iLaunched)
+            csv << list[i].asName.c_str() << ";" << list[i].iQueued << ";" << list[i].iLaunched
+                << ";" << list[i].iFailed << ";"
+                << FloatToStrF(list[i].fTime, ffFixed, 10, 3).c_str() << ";"
+                << FloatToStrF(list[i].fMax, ffFixed, 10, 3).c_str() << ";"
+                << FloatToStrF(list[i].iLaunched ? 1000.0 * list[i].fTime / list[i].iLaunched : 0.0,
+                               ffFixed, 10, 1)
+                       .c_str()
+                << "\n";
+    csv.close();
+    std::ofstream json("eventtrace.json");
+    if (!json.is_open())
+    {
+        ErrorLog("Cannot write eventtrace.json");
+        return false;
+    }
+    json << "{\"traceEvents\":[";
+    int n = iSamples < iSampleMax ? iSamples : iSampleMax; // ile jest w buforze
+    for (i = 0; i < n; ++i)
+    { // od najstarszego
+        TEventSample *s = pSamples + ((iSamples - n + i) % iSampleMax);
+        json << (i ? ",\n" : "\n") << "{\"name\":\"" << JsonText(s->evEvent->asName).c_str()
+             << "\",\"cat\":\"event\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+             << FloatToStrF(fTick * double(s->iBegin - iFirst), ffFixed, 15, 1).c_str()
+             << ",\"dur\":" << FloatToStrF(fTick * double(s->iEnd - s->iBegin), ffFixed, 15, 1).c_str()
+             << ",\"args\":{\"time\":" << FloatToStrF(s->fTime, ffFixed, 15, 3).c_str() << "}}";
+    }
+    json << "\n]}\n";
+    json.close();
+    WriteLog("Event profile: " + AnsiString(int(list.size())) + " names, " + AnsiString(n) +
+             " samples saved");
+    return true;
+};
+
+void EventProfile::Free()
+{
+    delete[] pSamples;
+    pSamples = NULL;
+    iSamples = 0;
+};
@@ -0,0 +1,39 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef EvProfileH
+#define EvProfileH
+
+#include <system.hpp>
+#include "Classes.h"
+//---------------------------------------------------------------------------
+struct TEventSample
+{ // jedno wykonanie eventu na osi czasu
+    TEvent *evEvent;
+    __int64 iBegin, iEnd; // takty licznika QueryPerformanceCounter
+    double fTime; // czas symulacji
+};
+
+class EventProfile
+{ // Ra: klasa statyczna zbierajca statystyk wykonywania eventw
+    // liczniki s w samych eventach (zawsze), czas jest mierzony tylko po wczeniu
+    // (eventprofile yes w eu07.ini), ostatnie wykonania s pamitane w buforze cyklicznym
+  private:
+    static __int64 iFirst; // pocztek osi czasu
+    static double fTick; // dugo taktu licznika w mikrosekundach
+    static TEventSample *pSamples; // bufor cykliczny wykona
+    static int iSamples; // ilo zapisanych wykona (liczc nadpisane)
+  public:
+    static __int64 Start(); // zwraca pocztek pomiaru, bo wykonania mog si zagnieda
+    static void Stop(TEvent *e, __int64 start);
+    static bool Dump(TEvent *root); // zapis do eventprofile.csv i eventtrace.json
+    static void Free();
+};
+//---------------------------------------------------------------------------
+#endif
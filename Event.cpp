@@ -49,10 +49,17 @@ TEvent::TEvent(AnsiString m)
     // Current->Params[8].asGroundNode=m; //to si ustawi w InitEvents
     // Current->Params[9].asMemCell=m->MemCell;
     fRandomDelay = 0.0; // standardowo nie bdzie dodatkowego losowego opnienia
+    bPassThrough = false; // ustawiane w InitEvents
+    faFlat[0] = faFlat[1] = NULL; // listy rozwinite tworzone po InitEvents
+    iFlatCount[0] = iFlatCount[1] = 0;
+    iProfQueued = iProfLaunched = iProfFailed = 0; // statystyka
+    fProfTime = fProfMax = 0.0;
 };
 
 TEvent::~TEvent()
 {
+    delete[] faFlat[0];
+    delete[] faFlat[1];
     switch (Type)
     { // sprztanie
     case tp_Multiple:
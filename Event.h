@@ -78,6 +78,15 @@ union TParam
     TTractionPowerSource *psPower;
 };
 
+const int iFlatMax = 256; // maksymalna dugo rozwinitej listy eventu multiple
+
+struct TFlatAction
+{ // pozycja rozwinitej (spaszczonej) listy eventu multiple
+    TEvent *evEvent; // event do dodania do kolejki albo rozwinity przelotowy multiple
+    int iGate; // pozycja przelotowego multiple, od ktrego zaley ta pozycja (-1 bezporednio)
+    int iLevel; // poziom zagniedenia, czyli w ktrym kroku kolejki zostaaby dodana (od 1)
+};
+
 class TEvent // zmienne: ev*
 { // zdarzenie
   private:
@@ -99,6 +108,14 @@ class TEvent // zmienne: ev*
     AnsiString asNodeName; // McZapkie-100302 - dodalem zeby zapamietac nazwe toru
     TEvent *evJoined; // kolejny event z t sam nazw - od wersji 378
     double fRandomDelay; // zakres dodatkowego opnienia
+    bool bPassThrough; // multiple bez warunku i opnienia, mona go rozwin u wywoujcego
+    TFlatAction *faFlat[2]; // listy rozwinite dla warunku niespenionego [0] i spenionego [1]
+    int iFlatCount[2]; // iloci pozycji w listach
+    int iProfQueued; // ile razy dodany do kolejki (statystyka dla EventProfile)
+    int iProfLaunched; // ile razy wykonany
+    int iProfFailed; // ile razy warunek nie by speniony
+    double fProfTime; // czny czas wykonania [ms]
+    double fProfMax; // najdusze wykonanie [ms]
   public: // metody
     TEvent(AnsiString m = "");
     ~TEvent();
@@ -100,6 +100,22 @@ GLfloat Global::darkLight[] = {0.03f, 0.03f, 0.03f, 1.0f}; //
 GLfloat Global::lightPos[4];
 bool Global::bRollFix = true; // czy wykona przeliczanie przechyki
 bool Global::bJoinEvents = false; // czy grupowa eventy o tych samych nazwach
+bool Global::bFlattenEvents = false; // rozwinicie zmienia kolejno wzgldem innych eventw
+bool Global::bEventProfile = false; // czy mierzy czas wykonywania eventw
+int Global::iPhysicsThreads = 0; // fizyka domylnie w jednym wtku
+bool Global::bSleepDynamic = false; // wszystkie skady przeliczane, jak byo
+bool Global::bConsistForces = true; // siy na sprzgach liczone dla skadw (TConsist)
+int Global::iIntegrator = 0; // cakowanie jawne, jak byo
+double Global::fPhysicsStep = 0.0; // krok fizyki dobierany do integratora
+bool Global::bConsistLog = false; // bez zapisu si w skadzie
+bool Global::bConsistPipe = false; // przewd gwny liczony po staremu, wagon po wagonie
+bool Global::bLookupTables = false; // tarcie i przyczepno liczone ze wzorw
+bool Global::bPhysicsThread = false; // fizyka liczona w ptli okna
+bool Global::bPowerNet = false; // napicie z dwch najbliszych zasilaczy, jak byo
+double Global::fPowerTelemetry = 0.0; // bez zbierania obcienia zasilaczy
+double Global::fPhysicsLod = 0.0; // 0 - wszystkie skady liczone penym modelem
+double Global::fFastForward = 0.0; // bez przewijania
+double Global::fBenchmark = 0.0; // bez pomiaru
 int Global::iHiddenEvents = 1; // czy czy eventy z torami poprzez nazw toru
 
 // parametry uytkowe (jak komu pasuje)
@@ -524,6 +540,34 @@ void Global::ConfigParse(TQueryParserComp *qp, cParser *cp)
         else if (str ==
                  AnsiString("joinduplicatedevents")) // czy grupowa eventy o tych samych nazwach
             bJoinEvents = (GetNextSymbol().LowerCase() == AnsiString("yes"));
+        else if (str == AnsiString("flattenevents")) // czy rozwija acuchy eventw multiple
+            bFlattenEvents = (GetNextSymbol().LowerCase() == AnsiString("yes"));
+        else if (str == AnsiString("eventprofile")) // pomiar czasu eventw, zapis [Ctrl]+[F7]
+            bEventProfile = (GetNextSymbol().LowerCase() == AnsiString("yes"));
+        else if (str == AnsiString("physicsthreads")) // ilo wtkw do liczenia fizyki
+            iPhysicsThreads = GetNextSymbol().ToIntDef(0);
+        else if (str == AnsiString("sleepdynamic")) // usypianie stojcych skadw
+            bSleepDynamic = (GetNextSymbol().LowerCase() == AnsiString("yes"));
+        else if (str == AnsiString("consistforces")) // siy na sprzgach liczone dla skadw
+            bConsistForces = (GetNextSymbol().LowerCase() == AnsiString("yes"));
+        else if (str == AnsiString("integrator")) // explicit albo implicit (pjawny dla skadw)
+            iIntegrator = (GetNextSymbol().LowerCase() == AnsiString("implicit")) ? 1 : 0;
+        else if (str == AnsiString("physicsstep")) // najwikszy krok fizyki [s], 0 - wg integratora
+            fPhysicsStep = GetNextSymbol().ToDouble();
+        else if (str == AnsiString("consistlog")) // zapis si w skadzie do consistlog.csv
+            bConsistLog = (GetNextSymbol().LowerCase() == AnsiString("yes"));
+        else if (str == AnsiString("consistpipe")) // przewd gwny liczony dla skadw
+            bConsistPipe = (GetNextSymbol().LowerCase() == AnsiString("yes"));
+        else if (str == AnsiString("lookuptables")) // tablice tarcia klockw i przyczepnoci
+            bLookupTables = (GetNextSymbol().LowerCase() == AnsiString("yes"));
+        else if (str == AnsiString("physicsthread")) // fizyka w osobnym wtku
+            bPhysicsThread = (GetNextSymbol().LowerCase() == AnsiString("yes"));
+        else if (str == AnsiString("powernet")) // sie trakcyjna liczona metod wzow
+            bPowerNet = (GetNextSymbol().LowerCase() == AnsiString("yes"));
+        else if (str == AnsiString("powertelemetry")) // okres prbkowania zasilaczy [s]
+            fPowerTelemetry = GetNextSymbol().ToDouble();
+        else if (str == AnsiString("physicslod")) // odlego uproszczonej fizyki skadw [m]
+            fPhysicsLod = GetNextSymbol().ToDouble();
         else if (str == AnsiString("hiddenevents")) // czy czy eventy z torami poprzez nazw toru
             iHiddenEvents = GetNextSymbol().ToIntDef(0);
         else if (str == AnsiString("pause")) // czy po wczytaniu ma by pauza?
@@ -805,6 +849,8 @@ TDynamicObject * Global::CouplerNearest()
 
 bool Global::AddToQuery(TEvent *event, TDynamicObject *who)
 {
+    if (pWorld->EventToPhysics(event, who))
+        return true; // doda wtek fizyki przed kolejnym krokiem
     return pGround->AddToQuery(event, who);
 };
 //---------------------------------------------------------------------------
@@ -305,6 +305,22 @@ class Global
 									   // informacje podczas kalibracji
     static double fBrakeStep; // krok zmiany hamulca dla klawiszy [Num3] i [Num9]
     static bool bJoinEvents; // czy grupowa eventy o tych samych nazwach
+    static bool bFlattenEvents; // czy rozwija przelotowe eventy multiple przy wczytywaniu
+    static bool bEventProfile; // czy mierzy czas wykonywania eventw
+    static int iPhysicsThreads; // ilo wtkw fizyki (0 i 1 - bez podziau, -1 - wg procesorw)
+    static bool bSleepDynamic; // czy usypia stojce skady bez obsady
+    static bool bConsistForces; // czy liczy siy na sprzgach dla caych skadw
+    static int iIntegrator; // cakowanie ruchu: 0 - jawne w Mover, 1 - pjawne dla skadw
+    static double fPhysicsStep; // najwikszy krok fizyki [s]
+    static bool bConsistLog; // zapis si w skadzie prowadzonego pojazdu
+    static bool bConsistPipe; // czy przewd gwny liczy niejawnie dla caych skadw
+    static bool bLookupTables; // czy tarcie klockw i przyczepno bra z tablic
+    static bool bPhysicsThread; // czy fizyka w osobnym wtku, niezalenie od FPS
+    static bool bPowerNet; // czy napicia sieci trakcyjnej liczy wzowo (TPowerNet)
+    static double fPowerTelemetry; //[s] okres prbkowania obcienia zasilaczy, 0 - wyczone
+    static double fPhysicsLod; //[m] odlego, od ktrej skady AI s liczone jako masa punktowa
+    static double fFastForward; //[min] przewinicie czasu po wczytaniu scenerii (-fastforward)
+    static double fBenchmark; //[s] czas symulacji do zmierzenia bez renderowania (-benchmark)
     static bool bSmudge; // czy wywietla smug, a pojazd uytkownika na kocu
     static AnsiString asTranscript[5]; // napisy na ekranie (widoczne)
     static TTranscripts tranTexts; // obiekt obsugujcy stenogramy dwikw na ekranie
@@ -40,6 +40,15 @@ http://mozilla.org/MPL/2.0/.
 #include "Driver.h"
 #include "Console.h"
 #include "Names.h"
+#include "mctools.hpp"
+#include "EvProfile.h"
+#include "WorkPool.h"
+#include "Consist.h"
+#include "Replay.h"
+#include "SaveState.h"
+#include "TrackGraph.h"
+#include "PowerNet.h"
+#include "PowerTelemetry.h"
 
 #define _PROBLEND 1
 //---------------------------------------------------------------------------
@@ -1111,9 +1120,7 @@ void TSubRect::LoadNodes()
                         // miejsce w tablicach normalnych i teksturowania si marnuje...
                     }
                     break;
-                case TP_TRACK:
-                    if (n->iNumVerts) // bo tory zabezpieczajce s niewidoczne
-                        n->pTrack->RaArrayFill(m_pVNT + n->iVboPtr, m_pVNT);
+                case TP_TRACK: // wszystkie naraz w TracksFill(), bo mona je liczy w wtkach
                     break;
                 case TP_TRACTION:
                     if (n->iNumVerts) // druty mog by niewidoczne...?
@@ -1122,12 +1129,68 @@ void TSubRect::LoadNodes()
                 }
             n = n->nNext2; // nastpny z sektora
         }
+        TracksFill(m_pVNT, Global::pGround->Pool(), false);
         BuildVBOs();
     }
     if (Global::bManageNodes)
         ResourceManager::Register(this); // dodanie do automatu zwalniajcego pami
 }
 
+const int iTrackFillMin = 8; // dla mniejszej iloci torw wtki si nie opacaj
+
+struct TTrackFill
+{ // tory sektora do wypenienia siatek
+    TTrack **pTracks;
+    int *pOffsets; // pocztki zakresw torw w (pBase)
+    CVertNormTex *pBase;
+};
+
+void TrackFillJob(void *data, int k)
+{ // zadanie dla wtku: (k)-ty tor sektora
+    TTrackFill *f = (TTrackFill *)data;
+    f->pTracks[k]->RaArrayFill(f->pBase + f->pOffsets[k], f->pBase);
+};
+
+int TSubRect::TracksFill(CVertNormTex *base, TWorkPool *pool, bool own)
+{ // wypenienie siatek torw sektora, zwraca ilo wierzchokw
+    // kady tor pisze tylko do swojego zakresu tablicy, wic tory mog by liczone w wtkach
+    // (own) - zakresy od zera wg RaArrayPrepare() zamiast (iVboPtr) z LoadNodes(),
+    // przy (base==NULL) tylko zliczenie
+    TGroundNode *node;
+    TTrackFill f;
+    int n = 0, v = 0, k;
+    for (node = nRootNode; node; node = node->nNext2)
+        if (node->iType == TP_TRACK)
+            ++n;
+    if (!n)
+        return 0;
+    f.pTracks = new TTrack *[n];
+    f.pOffsets = new int[n];
+    f.pBase = base;
+    n = 0;
+    for (node = nRootNode; node; node = node->nNext2)
+        if (node->iType == TP_TRACK)
+        {
+            k = own ? node->pTrack->RaArrayPrepare() : node->iNumVerts;
+            if (!k)
+                continue; // bo tory zabezpieczajce s niewidoczne
+            f.pTracks[n] = node->pTrack;
+            f.pOffsets[n++] = own ? v : node->iVboPtr;
+            v += k;
+        }
+    if (base)
+    {
+        if (pool && (n >= iTrackFillMin))
+            pool->Run(TrackFillJob, &f, n);
+        else
+            for (k = 0; k < n; ++k)
+                TrackFillJob(&f, k);
+    }
+    delete[] f.pTracks;
+    delete[] f.pOffsets;
+    return v;
+};
+
 bool TSubRect::StartVBO()
 { // pocztek rysowania elementw z VBO w sektorze
     SetLastUsage(Timer::GetSimulationTime()); // te z tyu bd niepotrzebnie zwalniane
@@ -1320,7 +1383,22 @@ TGround::TGround()
     for (int i = 0; i < TP_LAST; i++)
         nRootOfType[i] = NULL; // zerowanie tablic wyszukiwania
     bDynamicRemove = false; // na razie nic do usunicia
+    bDynamicRemoveLater = false; // przy wtku fizyki usuwa wtek okna
     sTracks = new TNames(); // nazwy torw - na razie tak
+    pPool = NULL; // wtki tworzone przy wczytaniu scenerii
+    bPoolAll = false;
+    pPowerNet = NULL; // tworzona w InitTraction()
+    pIslandList = pIslandCars = NULL;
+    pIslandParent = pIslandNo = pIslandFirst = pIslandAwake = pIslandDistant = NULL;
+    pActive = NULL;
+    pConsists = NULL;
+    pContacts = NULL;
+    pPending = NULL;
+    iContacts = iContactsSize = 0;
+    iIslandSize = iIslands = iIslandsAwake = iIslandsDistant = iActive = iSleeping = iDistant = 0;
+    iPhysicsTicks = 0;
+    iPhysicsSteps = 0;
+    fPhysicsTime = 0.0;
 }
 
 TGround::~TGround()
@@ -1331,6 +1409,16 @@ TGround::~TGround()
 void TGround::Free()
 {
     TEvent *tmp;
+    EventProfile::Free(); // o czasu wskazuje na eventy
+    PowerTelemetry::Free(); // przed usuniciem zasilaczy
+    TTrackGraph::Free(); // przed usuniciem torw
+    delete pPowerNet; // przed usuniciem przse
+    pPowerNet = NULL;
+    delete[] pContacts; // wskazuj na pantografy pojazdw
+    delete[] pPending;
+    pContacts = NULL;
+    pPending = NULL;
+    iContacts = iContactsSize = 0;
     for (TEvent *Current = RootEvent; Current;)
     {
         tmp = Current;
@@ -1357,7 +1445,21 @@ void TGround::Free()
     iNumNodes = 0;
     // RootNode=NULL;
     nRootDynamic = NULL;
+    TFrictionTable::Free(); // po usuniciu pojazdw
     delete sTracks;
+    delete pPool;
+    pPool = NULL;
+    bPoolAll = false;
+    delete[] pIslandList;
+    delete[] pIslandCars;
+    delete[] pIslandParent;
+    delete[] pIslandNo;
+    delete[] pIslandFirst;
+    delete[] pIslandAwake;
+    delete[] pIslandDistant;
+    delete[] pActive;
+    delete[] pConsists;
+    iIslandSize = 0;
 }
 
 TGroundNode * TGround::DynamicFindAny(AnsiString asNameToFind)
@@ -1389,7 +1491,7 @@ void TGround::DynamicList(bool all)
 TGroundNode * TGround::FindGroundNode(AnsiString asNameToFind, TGroundNodeType iNodeType)
 { // wyszukiwanie obiektu o podanej nazwie i konkretnym typie
     if ((iNodeType == TP_TRACK) || (iNodeType == TP_MEMCELL) || (iNodeType == TP_MODEL))
-    { // wyszukiwanie w drzewie binarnym
+    { // wyszukiwanie w tablicy mieszajcej
         return (TGroundNode *)sTracks->Find(iNodeType, asNameToFind.c_str());
     }
     // standardowe wyszukiwanie liniowe
@@ -1718,7 +1820,7 @@ TGroundNode * TGround::AddGroundNode(cParser *parser)
         { // dodanie do wyszukiwarki
             if (sTracks->Update(TP_MEMCELL, tmp->asName.c_str(),
                                 tmp)) // najpierw sprawdzi, czy ju jest
-            { // przy zdublowaniu wskanik zostanie podmieniony w drzewku na pniejszy (zgodno
+            { // przy zdublowaniu wskanik zostanie podmieniony w tablicy na pniejszy (zgodno
                 // wsteczna)
                 ErrorLog("Duplicated memcell: " + tmp->asName); // to zgasza duplikat
             }
@@ -1745,7 +1847,7 @@ TGroundNode * TGround::AddGroundNode(cParser *parser)
         { // dodanie do wyszukiwarki
             if (sTracks->Update(TP_TRACK, tmp->asName.c_str(),
                                 tmp)) // najpierw sprawdzi, czy ju jest
-            { // przy zdublowaniu wskanik zostanie podmieniony w drzewku na pniejszy (zgodno
+            { // przy zdublowaniu wskanik zostanie podmieniony w tablicy na pniejszy (zgodno
                 // wsteczna)
                 if (tmp->pTrack->iCategoryFlag & 1) // jeli jest zdublowany tor kolejowy
                     ErrorLog("Duplicated track: " + tmp->asName); // to zgasza duplikat
@@ -1991,7 +2093,7 @@ TGroundNode * TGround::AddGroundNode(cParser *parser)
         { // dodanie do wyszukiwarki
             if (sTracks->Update(TP_MODEL, tmp->asName.c_str(),
                                 tmp)) // najpierw sprawdzi, czy ju jest
-            { // przy zdublowaniu wskanik zostanie podmieniony w drzewku na pniejszy (zgodno
+            { // przy zdublowaniu wskanik zostanie podmieniony w tablicy na pniejszy (zgodno
                 // wsteczna)
                 ErrorLog("Duplicated model: " + tmp->asName); // to zgasza duplikat
             }
@@ -2225,7 +2327,7 @@ TSubRect * TGround::GetSubRect(int iCol, int iRow)
 
 TEvent * TGround::FindEvent(const AnsiString &asEventName)
 {
-    return (TEvent *)sTracks->Find(0, asEventName.c_str()); // wyszukiwanie w drzewie
+    return (TEvent *)sTracks->Find(0, asEventName.c_str()); // wyszukiwanie w tablicy nazw
     /* //powolna wyszukiwarka
      for (TEvent *Current=RootEvent;Current;Current=Current->Next2)
      {
@@ -2238,7 +2340,7 @@ TEvent * TGround::FindEvent(const AnsiString &asEventName)
 
 TEvent * TGround::FindEventScan(const AnsiString &asEventName)
 { // wyszukanie eventu z opcj utworzenia niejawnego dla komrek skanowanych
-    TEvent *e = (TEvent *)sTracks->Find(0, asEventName.c_str()); // wyszukiwanie w drzewie eventw
+    TEvent *e = (TEvent *)sTracks->Find(0, asEventName.c_str()); // wyszukiwanie w tablicy eventw
     if (e)
         return e; // jak istnieje, to w porzdku
     if (asEventName.SubString(asEventName.Length() - 4, 5) ==
@@ -2315,6 +2417,7 @@ void TGround::FirstInit()
     WriteLog("InitTraction OK");
     WriteLog("InitEvents");
     InitEvents();
+    FlattenEvents(); // rozwinicie przelotowych eventw multiple
     WriteLog("InitEvents OK");
     WriteLog("InitLaunchers");
     InitLaunchers();
@@ -2362,12 +2465,217 @@ void TGround::FirstInit()
     WriteLog("FirstInit is done");
 };
 
+void TGround::PoolAll()
+{ // wtki na wszystkich procesorach (przewijanie czasu), jeli nie zostay utworzone przy
+    // wczytaniu; podzia na grupy jest niezaleny od iloci wtkw, wic wynik si nie zmienia
+    if (pPool || Replay::Recording() || Replay::Playing())
+        return;
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    if (si.dwNumberOfProcessors > 1)
+    {
+        pPool = new TWorkPool(si.dwNumberOfProcessors);
+        bPoolAll = true;
+    }
+};
+
+void TGround::PoolFree()
+{ // usunicie wtkw utworzonych przez PoolAll(); pula z wczytania scenerii zostaje
+    if (!bPoolAll)
+        return;
+    delete pPool;
+    pPool = NULL;
+    bPoolAll = false;
+};
+
+void TGround::MeshBenchmark()
+{ // pomiar: siatki torw sektora z najwiksz iloci wierzchokw torw (dua stacja),
+    // wypeniane w jednym wtku oraz w puli; wyniki musz by identyczne
+    TSubRect *s, *best = NULL;
+    int c, r, i, v, max = 0;
+    for (c = 0; c < iNumRects; ++c)
+        for (r = 0; r < iNumRects; ++r)
+            for (i = 0; i < iNumSubRects * iNumSubRects; ++i)
+                if ((s = Rects[c][r].FastGetRect(i % iNumSubRects, i / iNumSubRects)) != NULL)
+                    if ((v = s->TracksFill(NULL, NULL, true)) > max)
+                    {
+                        max = v;
+                        best = s;
+                    }
+    if (!best)
+        return;
+    best->LoadNodes(); // zwrotnice zapamituj pooenie iglic w VBO, wic ukad musi by ten sam
+    int size = best->m_nVertexCount; // tablica caego sektora, wypeniane s tylko tory
+    if (size <= 0)
+        return;
+    TWorkPool *pool = pPool; // przy wczytaniu mogo nie by potrzeby tworzenia wtkw
+    if (!pool)
+    {
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        if (si.dwNumberOfProcessors > 1)
+            pool = new TWorkPool(si.dwNumberOfProcessors);
+    }
+    const int repeat = 20;
+    CVertNormTex *a = new CVertNormTex[size];
+    CVertNormTex *b = new CVertNormTex[size];
+    memset(a, 0, size * sizeof(CVertNormTex));
+    memset(b, 0, size * sizeof(CVertNormTex));
+    LARGE_INTEGER t0, t1, t2, f;
+    QueryPerformanceCounter(&t0);
+    for (i = 0; i < repeat; ++i)
+        best->TracksFill(a, NULL, false);
+    QueryPerformanceCounter(&t1);
+    for (i = 0; i < repeat; ++i)
+        best->TracksFill(b, pool, false);
+    QueryPerformanceCounter(&t2);
+    QueryPerformanceFrequency(&f);
+    bool same = !memcmp(a, b, size * sizeof(CVertNormTex));
+    delete[] a;
+    delete[] b;
+    WriteLog("Track mesh fill: " + AnsiString(max) + " vertices x " + AnsiString(repeat) +
+             ", serial " +
+             FloatToStrF(1000.0 * (t1.QuadPart - t0.QuadPart) / f.QuadPart, ffFixed, 7, 2) +
+             " ms, " + AnsiString(pool ? pool->Threads() : 1) + " threads " +
+             FloatToStrF(1000.0 * (t2.QuadPart - t1.QuadPart) / f.QuadPart, ffFixed, 7, 2) +
+             " ms, " + AnsiString(same ? "identical" : "DIFFERENT"));
+    if (pool != pPool)
+        delete pool;
+};
+
+bool TGround::State()
+{ // zapis albo odtworzenie stanu scenerii (TSaveState)
+    // false, gdy zapis nie pasuje do scenerii - sprawdzane przed zmian czegokolwiek
+    TGroundNode *Current;
+    int count[4] = {0, 0, 0, 0}, saved[4]; // tory, komrki, zasilacze, pojazdy
+    TSaveState::TrackClear();
+    for (Current = nRootOfType[TP_TRACK]; Current; Current = Current->nNext, ++count[0])
+        TSaveState::TrackAdd(Current->pTrack);
+    for (Current = nRootOfType[TP_MEMCELL]; Current; Current = Current->nNext)
+        ++count[1];
+    for (Current = nRootOfType[TP_TRACTIONPOWERSOURCE]; Current; Current = Current->nNext)
+        ++count[2];
+    for (Current = nRootDynamic; Current; Current = Current->nNext)
+        ++count[3];
+    memcpy(saved, count, sizeof(count));
+    TSaveState::Field(saved, sizeof(saved));
+    if (memcmp(saved, count, sizeof(count)))
+        return false;
+    for (Current = nRootDynamic; Current; Current = Current->nNext)
+    { // pojazdy musz by te same i z t sam obsad
+        AnsiString name = Current->DynamicObject->asName;
+        bool crew = (Current->DynamicObject->Mechanik != NULL), c = crew;
+        TSaveState::Text(name);
+        TSaveState::Field(&c, sizeof(c));
+        if ((name != Current->DynamicObject->asName) || (c != crew))
+            return false;
+    }
+    double t = Timer::GetSimulationTime();
+    TSaveState::Field(&t, sizeof(t));
+    TSaveState::Field(&GlobalTime->GameTime, sizeof(double));
+    TSaveState::Field(&GlobalTime->dd, sizeof(int));
+    TSaveState::Field(&GlobalTime->hh, sizeof(int));
+    TSaveState::Field(&GlobalTime->mm, sizeof(int));
+    TSaveState::Field(&GlobalTime->mr, sizeof(double));
+    if (TSaveState::Loading())
+        Timer::SetSimulationTime(t);
+    for (Current = nRootOfType[TP_TRACK]; Current; Current = Current->nNext)
+        if (Current->pTrack->eType == tt_Switch)
+        { // zwrotnice przed pojazdami, bo osie bior segment z toru
+            int s = Current->pTrack->GetSwitchState();
+            TSaveState::Field(&s, sizeof(s));
+            if (TSaveState::Loading() && (s >= 0) && (s != Current->pTrack->GetSwitchState()))
+                Current->pTrack->Switch(s);
+        }
+    for (Current = nRootOfType[TP_MEMCELL]; Current; Current = Current->nNext)
+        Current->MemCell->State();
+    std::vector<TTractionPowerSource *> repower; // zasilacze, ktrym odczyt zmieni stan
+    for (Current = nRootOfType[TP_TRACTIONPOWERSOURCE]; Current; Current = Current->nNext)
+        if (Current->psTractionPowerSource->State())
+            repower.push_back(Current->psTractionPowerSource);
+    for (unsigned int i = 0; i < repower.size(); ++i)
+        TractionRepower(repower[i]); // obszary zasilania przse jak przy zapisie
+    TPowerNet::State(pPowerNet);
+    for (Current = nRootDynamic; Current; Current = Current->nNext)
+        Current->DynamicObject->State();
+    // kolejka eventw: nazwa, numer wrd eventw o tej samej nazwie, czas i aktywator
+    TEvent *e;
+    int n = 0;
+    for (e = QueryRootEvent; e; e = e->evNext)
+        ++n;
+    TSaveState::Field(&n, sizeof(n));
+    if (!TSaveState::Loading())
+    {
+        for (e = QueryRootEvent; e; e = e->evNext)
+        {
+            AnsiString name = e->asName;
+            AnsiString activator = e->Activator ? e->Activator->asName : AnsiString("");
+            int k = 0;
+            for (TEvent *j = FindEvent(name); j && (j != e); j = j->evJoined)
+                ++k;
+            TSaveState::Text(name);
+            TSaveState::Field(&k, sizeof(k));
+            TSaveState::Field(&e->fStartTime, sizeof(double));
+            TSaveState::Field(&e->iQueued, sizeof(int));
+            TSaveState::Text(activator);
+        }
+        return true;
+    }
+    for (e = QueryRootEvent; e; e = e->evNext)
+        e->iQueued = 0; // dotychczasowa kolejka jest porzucana
+    QueryRootEvent = NULL;
+    while (n-- > 0)
+    {
+        AnsiString name, activator;
+        int k, queued;
+        double start;
+        TSaveState::Text(name);
+        TSaveState::Field(&k, sizeof(k));
+        TSaveState::Field(&start, sizeof(start));
+        TSaveState::Field(&queued, sizeof(queued));
+        TSaveState::Text(activator);
+        for (e = FindEvent(name); e && (k > 0); --k)
+            e = e->evJoined;
+        if (!e)
+        {
+            WriteLog("State: event " + name + " not found");
+            continue;
+        }
+        Current = activator.IsEmpty() ? NULL : DynamicFindAny(activator);
+        e->Activator = Current ? Current->DynamicObject : NULL;
+        e->fStartTime = start;
+        e->iQueued = queued;
+        if (QueryRootEvent ? e->fStartTime >= QueryRootEvent->fStartTime : false)
+            QueryRootEvent->AddToQuery(e); // kolejka jest posortowana wzgldem (fStartTime)
+        else
+        {
+            e->evNext = QueryRootEvent;
+            QueryRootEvent = e;
+        }
+    }
+    return true;
+};
+
 bool TGround::Init(AnsiString asFile, HDC hDC)
 { // gwne wczytywanie scenerii
     if (asFile.LowerCase().SubString(1, 7) == "scenery")
         asFile.Delete(1, 8); // Ra: usunicie niepotrzebnych znakw - zgodno wstecz z 2003
     WriteLog("Loading scenery from " + asFile);
     Global::pGround = this;
+    if (!pPool)
+    { // wtki do rwnolegego liczenia fizyki niezalenych skadw
+        int n = Global::iPhysicsThreads;
+        if (n < 0)
+        { // wg iloci procesorw
+            SYSTEM_INFO si;
+            GetSystemInfo(&si);
+            n = si.dwNumberOfProcessors;
+        }
+        if (Replay::Recording() || Replay::Playing())
+            n = 0; // kolejno losowania w fizyce musi by powtarzalna
+        if (n > 1)
+            pPool = new TWorkPool(n);
+    }
     // pTrain=NULL;
     pOrigin = aRotate = vector3(0, 0, 0); // zerowanie przesunicia i obrotu
     AnsiString str = "";
@@ -2863,10 +3171,8 @@ bool TGround::Init(AnsiString asFile, HDC hDC)
     }
 
     delete parser;
-    sTracks->Sort(TP_TRACK); // finalne sortowanie drzewa torw
-    sTracks->Sort(TP_MEMCELL); // finalne sortowanie drzewa komrek pamici
-    sTracks->Sort(TP_MODEL); // finalne sortowanie drzewa modeli
-    sTracks->Sort(0); // finalne sortowanie drzewa eventw
+    if (DebugModeFlag) // tablice nazw nie wymagaj sortowania, mona tylko sprawdzi wydajno
+        sTracks->LogStats();
     if (!bInitDone)
         FirstInit(); // jeli nie byo w scenerii
     if (Global::pTerrainCompact)
@@ -3174,6 +3480,155 @@ bool TGround::InitEvents()
     return true;
 }
 
+inline bool FlatSelected(TEvent *e, bool b, int i)
+{ // czy (i)-ty event z listy multiple zostanie dodany do kolejki przy warunku (b)
+    return e->Params[i].asEvent ? (b != bool(e->iFlags & (conditional_else << i))) : false;
+};
+
+int TGround::EventFlatten(TEvent *e, bool b, TFlatAction *f, int &depth)
+{ // rozwinicie listy eventu multiple (e) dla warunku (b) w kolejnoci, w jakiej by si wykonay
+    // zwraca ilo pozycji, 0 gdy nie ma czego rozwija, -1 przy ptli, -2 przy powtrzeniu
+    int i, j, k, n = 0;
+    bool through = false; // czy jest jakikolwiek przelotowy do rozwinicia
+    for (i = 0; i < 8; ++i)
+        if (FlatSelected(e, b, i))
+        {
+            if (e->Params[i].asEvent == e)
+                return 0; // rekurencja z opnieniem zostaje obsuona po staremu
+            for (j = 0; j < n; ++j)
+                if (f[j].evEvent == e->Params[i].asEvent)
+                    return -2; // powtrzony na licie
+            f[n].evEvent = e->Params[i].asEvent;
+            f[n].iGate = -1;
+            f[n++].iLevel = 1;
+        }
+    depth = 1;
+    for (k = 0; k < n; ++k) // (n) ronie w trakcie, wic wychodzi przeszukiwanie wszerz
+        if (f[k].evEvent->bPassThrough)
+        { // przelotowy multiple wykonaby si w kolejnym kroku - jego lista idzie na koniec
+            TEvent *m = f[k].evEvent;
+            bool bm = (m->iFlags <= update_only); // warunek bez testw jest stay
+            through = true;
+            for (i = 0; i < 8; ++i)
+                if (FlatSelected(m, bm, i))
+                    if (m->Params[i].asEvent != m) // bez opnienia sam si nie doda
+                    {
+                        if (m->Params[i].asEvent == e)
+                            return -1; // ptla bez opnienia
+                        for (j = 0; j < n; ++j)
+                            if (f[j].evEvent == m->Params[i].asEvent)
+                                return -2; // osigalny dwiema drogami, kolejno by si zmienia
+                        if (n >= iFlatMax)
+                            return -2; // za duo
+                        f[n].evEvent = m->Params[i].asEvent;
+                        f[n].iGate = k;
+                        f[n].iLevel = f[k].iLevel + 1;
+                        if (f[n].iLevel > depth)
+                            depth = f[n].iLevel;
+                        ++n;
+                    }
+        }
+    return through ? n : 0;
+};
+
+void TGround::FlattenEvents()
+{ // oznaczenie przelotowych eventw multiple i rozwinicie list tych, ktre je wywouj
+    TFlatAction f[iFlatMax];
+    TEvent *Current, *e;
+    int n, b, depth;
+    int multiple = 0, through = 0, flat = 0, loops = 0, shared = 0, total = 0;
+    int fanmax = 0, depthmax = 0, joined = 0, joinmax = 0;
+    for (Current = RootEvent; Current; Current = Current->evNext2)
+    { // przelotowy: bez warunku, bez opnienia, o unikalnej nazwie
+        if (Current->evJoined)
+        { // statystyka acuchw eventw o tych samych nazwach
+            for (n = 1, e = Current->evJoined; e; e = e->evJoined)
+                ++n;
+            ++joined;
+            if (n > joinmax)
+                joinmax = n;
+        }
+        if (Current->Type != tp_Multiple)
+            continue;
+        ++multiple;
+        Current->bPassThrough = Global::bFlattenEvents &&
+                                !(Current->iFlags & ~conditional_anyelse) &&
+                                (Current->fDelay == 0.0) && (Current->fRandomDelay == 0.0) &&
+                                !Current->evJoined;
+        if (Current->bPassThrough)
+            ++through;
+    }
+    if (through)
+        for (Current = RootEvent; Current; Current = Current->evNext2)
+            if (Current->Type == tp_Multiple)
+                for (b = (Current->iFlags & conditional_anyelse) ? 0 : 1; b < 2; ++b)
+                { // lista dla niespenionego warunku potrzebna tylko, gdy jest else
+                    n = EventFlatten(Current, b, f, depth);
+                    if (n > 0)
+                    {
+                        Current->faFlat[b] = new TFlatAction[n];
+                        memcpy(Current->faFlat[b], f, n * sizeof(TFlatAction));
+                        Current->iFlatCount[b] = n;
+                        ++flat;
+                        total += n;
+                        if (n > fanmax)
+                            fanmax = n;
+                        if (depth > depthmax)
+                            depthmax = depth;
+                    }
+                    else if (n == -1)
+                    {
+                        WriteLog("Zero delay event loop through multiple " + Current->asName);
+                        ++loops;
+                    }
+                    else if (n < 0)
+                        ++shared;
+                }
+    WriteLog("Events: " + AnsiString(multiple) + " multiple, " + AnsiString(through) +
+             " pass-through, " + AnsiString(flat) + " flattened (fan-out avg " +
+             FloatToStrF(flat ? double(total) / flat : 0.0, ffFixed, 7, 1) + " max " +
+             AnsiString(fanmax) + ", depth " + AnsiString(depthmax) + "), " + AnsiString(loops) +
+             " loops, " + AnsiString(shared) + " not flattened, " + AnsiString(joined) +
+             " joined (max " + AnsiString(joinmax) + ")");
+};
+
+void TGround::FlatToQuery(TEvent *e, bool b)
+{ // dodanie do kolejki rozwinitej listy eventu multiple
+    // przelotowy, ktry ju jest w kolejce albo jest wyczony, blokuje swoje pozycje tak samo,
+    // jak AddToQuery() zablokowaoby jego dodanie
+    // bez rozwijania kady poziom byby dodawany do kolejki klatk pniej, wic pozycja z poziomu
+    // (n) czeka dodatkowo (n-0.5) klatki; p klatki zapasu na nierwny czas kolejnych klatek
+    TFlatAction *f = e->faFlat[b];
+    bool open[iFlatMax];
+    TEvent *m;
+    double frame = Timer::GetDeltaTime(); // czas klatki, o ktry przesuwa si kady poziom
+    int step; // w ktrej klatce od teraz zostaby wykonany
+    for (int k = 0; k < e->iFlatCount[b]; ++k)
+    {
+        open[k] = false;
+        if (f[k].iGate >= 0 ? !open[f[k].iGate] : false)
+            continue; // nadrzdny nie zostaby wykonany
+        m = f[k].evEvent;
+        if (!m->bPassThrough)
+        { // normalnie doda, z opnieniem za pominite poziomy
+            step = f[k].iLevel;
+            if ((m->Type == tp_AddValues) && (m->fDelay == 0.0))
+                --step; // AddValues wykonuje si ju przy dodaniu, czyli klatk wczeniej
+            AddToQuery(m, e->Activator, f[k].iLevel > 1 ? (step - 0.5) * frame : 0.0);
+        }
+        else if (m->bEnabled && !m->iQueued)
+        { // przelotowy wykonuje si w miejscu
+            open[k] = true;
+            m->Activator = e->Activator;
+            ++m->iProfQueued; // statystyka jak dla dodanego i wykonanego z kolejki
+            ++m->iProfLaunched;
+            if (Global::iMultiplayer) // dajemy zna do serwera o wykonaniu
+                if ((m->iFlags & conditional_anyelse) == 0) // jednoznaczne tylko, gdy nie byo else
+                    WyslijEvent(m->asName, m->Activator ? m->Activator->GetName() : AnsiString(""));
+        }
+    }
+};
+
 void TGround::InitTracks()
 { //czenie torw ze sob i z eventami
     TGroundNode *Current, *Model;
@@ -3343,6 +3798,7 @@ void TGround::InitTracks()
         }
         p = p->Next();
     }
+    TTrackGraph::Build(nRootOfType[TP_TRACK]); // do skanowania AI (BackwardTraceRoute)
     // for (Current=nRootOfType[TP_TRACK];Current;Current=Current->nNext)
     // if (Current->pTrack->eType==tt_Cross)
     //  Current->pTrack->ConnectionsLog(); //zalogowanie informacji o poczeniach
@@ -3553,6 +4009,22 @@ void TGround::InitTraction()
             }
     }
     delete[] nEnds; // nie potrzebne ju
+    TractionAreas(); // zapamitanie obszarw zasilaczy
+    if (Global::bPowerNet)
+    { // schemat zastpczy sieci po ustaleniu wszystkich pocze
+        int n = 0;
+        for (nCurrent = nRootOfType[TP_TRACTION]; nCurrent; nCurrent = nCurrent->nNext)
+            ++n;
+        TTraction **spans = new TTraction *[n + 1];
+        n = 0;
+        for (nCurrent = nRootOfType[TP_TRACTION]; nCurrent; nCurrent = nCurrent->nNext)
+            spans[n++] = nCurrent->hvTraction;
+        delete pPowerNet;
+        pPowerNet = new TPowerNet();
+        pPowerNet->Build(spans, n);
+        delete[] spans;
+    }
+    PowerTelemetry::Init(nRootOfType[TP_TRACTIONPOWERSOURCE]); // rwnie bez zbierania prbek
 };
 
 void TGround::TrackJoin(TGroundNode *Current)
@@ -3753,6 +4225,8 @@ TTraction * TGround::TractionNearestFind(vector3 &p, int dir, TGroundNode *n)
     {
         n->hvTraction->ResistanceCalc(dir, nBest->hvTraction->fResistance[zg],
                                       nBest->hvTraction->psPower[zg]);
+        n->hvTraction->hvJoin = nBest->hvTraction; // zwora w schemacie zastpczym (TPowerNet)
+        n->hvTraction->iJoin = zg; // rwnie do przeliczenia po awarii zasilacza
         // testowo skrzywienie przsa tak, aby pokaza skd ma zasilanie
         // if (dir) //1 gdy cig dalszy jest od strony Point2
         // n->hvTraction->pPoint3=0.25*(nBest->pCenter+3*(zg?nBest->hvTraction->pPoint4:nBest->hvTraction->pPoint3));
@@ -3762,17 +4236,208 @@ TTraction * TGround::TractionNearestFind(vector3 &p, int dir, TGroundNode *n)
     return (nBest ? nBest->hvTraction : NULL);
 };
 
-bool TGround::AddToQuery(TEvent *Event, TDynamicObject *Node)
-{
+void TGround::TractionAreas()
+{ // zapamitanie stron przse zasilanych z kadego zasilacza, aby po awarii przelicza tylko je
+    TGroundNode *n;
+    TTractionPowerSource *ps;
+    int e;
+    for (n = nRootOfType[TP_TRACTIONPOWERSOURCE]; n; n = n->nNext)
+    {
+        ps = n->psTractionPowerSource;
+        ps->iArea = 0;
+        ps->bLive = ps->Live(); // zmiany bd liczone od stanu po wczytaniu
+    }
+    for (n = nRootOfType[TP_TRACTION]; n; n = n->nNext)
+        for (e = 0; e < 2; ++e)
+            if (n->hvTraction->psPower[e])
+                ++n->hvTraction->psPower[e]->iArea;
+    for (n = nRootOfType[TP_TRACTIONPOWERSOURCE]; n; n = n->nNext)
+    {
+        ps = n->psTractionPowerSource;
+        delete[] ps->hvArea;
+        delete[] ps->iAreaSide;
+        ps->hvArea = new TTraction *[ps->iArea + 1];
+        ps->iAreaSide = new int[ps->iArea + 1];
+        ps->iArea = 0; // teraz jako licznik wypenienia
+    }
+    for (n = nRootOfType[TP_TRACTION]; n; n = n->nNext)
+        for (e = 0; e < 2; ++e)
+            if ((ps = n->hvTraction->psPower[e]) != NULL)
+            {
+                ps->hvArea[ps->iArea] = n->hvTraction;
+                ps->iAreaSide[ps->iArea++] = e;
+            }
+};
+
+int TGround::TractionRepower(TTractionPowerSource *ps)
+{ // przeliczenie zasilania przse po wyczeniu albo zaczeniu zasilacza (ps)
+    // czyszczone s obszary tego zasilacza i zasilaczy wyczonych, a nastpnie wypeniane od
+    // czynnych przse zasilanych i od granic obszarw; zwraca ilo przeliczonych stron przse
+    TGroundNode *n;
+    TTractionPowerSource *q, *p;
+    TTraction *t, *s;
+    int i, e, k, sides = 0;
+    bool changed;
+    double r, w;
+    ps->bLive = ps->Live();
+    if (ps->bSection)
+    { // sekcja nie jest rdem, jej odczenie wycza tylko przsa sekcji
+        ps->bIsolated = !ps->bLive;
+        return 0;
+    }
+    for (n = nRootOfType[TP_TRACTIONPOWERSOURCE]; n; n = n->nNext)
+    {
+        q = n->psTractionPowerSource;
+        if ((q == ps) || !q->bLive)
+            for (i = 0; i < q->iArea; ++i)
+            {
+                q->hvArea[i]->psPower[q->iAreaSide[i]] = NULL;
+                q->hvArea[i]->fResistance[q->iAreaSide[i]] = -1.0;
+                ++sides;
+            }
+    }
+    for (n = nRootOfType[TP_TRACTIONPOWERSOURCE]; n; n = n->nNext)
+    { // przsa zasilane bezporednio z czynnych zasilaczy, zanim ruszy wypenianie
+        q = n->psTractionPowerSource;
+        if ((q == ps) || !q->bLive)
+            for (i = 0; i < q->iArea; ++i)
+            {
+                t = q->hvArea[i];
+                if (t->psPowered ? t->psPowered->bLive : false)
+                {
+                    t->psPower[0] = t->psPower[1] = t->psPowered;
+                    t->fResistance[0] = t->fResistance[1] = 0.0;
+                }
+            }
+    }
+    for (n = nRootOfType[TP_TRACTIONPOWERSOURCE]; n; n = n->nNext)
+    {
+        q = n->psTractionPowerSource;
+        if ((q == ps) || !q->bLive)
+            for (i = 0; i < q->iArea; ++i)
+                if (q->hvArea[i]->psPowered ? q->hvArea[i]->psPowered->bLive : false)
+                    q->hvArea[i]->ResistanceCalc(); // zatrzyma si na przsach ju ustalonych
+    }
+    do
+    { // pozostae strony dostaj zasilacz od ssiada spoza obszaru, albo przez poczenie
+        // segmentw naprania, ktre moe wymaga kolejnego przebiegu
+        changed = false;
+        for (n = nRootOfType[TP_TRACTIONPOWERSOURCE]; n; n = n->nNext)
+        {
+            q = n->psTractionPowerSource;
+            if ((q == ps) || !q->bLive)
+                for (i = 0; i < q->iArea; ++i)
+                {
+                    t = q->hvArea[i];
+                    e = q->iAreaSide[i];
+                    if (t->psPower[e])
+                        continue; // ju ustalona
+                    p = NULL;
+                    if ((s = t->hvNext[e]) != NULL)
+                    { // zasilacz ssiada od jego przeciwnej strony
+                        k = t->iNext[e] ^ 1;
+                        if (s->psPower[k] ? s->fResistance[k] >= 0.0 : false)
+                        {
+                            p = s->psPower[k];
+                            r = s->fResistivity * Length3(s->vParametric);
+                            r = (s->psPowered == p) ? 0.5 * r : s->fResistance[k] + r;
+                            w = r + t->fResistivity * Length3(t->vParametric); // dla dalszych
+                        }
+                    }
+                    else if (t->hvJoin ? t->hvJoin->fResistance[t->iJoin] >= 0.0 : false)
+                    { // tak jak w TractionNearestFind(), bez doliczania przsa kocowego
+                        p = t->hvJoin->psPower[t->iJoin];
+                        w = r = t->hvJoin->fResistance[t->iJoin];
+                    }
+                    if (p)
+                    {
+                        t->fResistance[e] = r;
+                        t->ResistanceCalc(e ^ 1, w, p);
+                        changed = true;
+                    }
+                }
+        }
+    } while (changed);
+    return sides;
+};
+
+void TGround::TractionBenchmark()
+{ // pomiar przeliczenia po wyczeniu zasilacza z najwikszym obszarem i po jego zaczeniu,
+    // po zaczeniu zasilanie przse musi by takie samo jak po wczytaniu; na koniec
+    // przywracany jest stan sprzed pomiaru, take przy niezgodnociach
+    TGroundNode *n;
+    TTractionPowerSource *ps = NULL;
+    AnsiString name;
+    for (n = nRootOfType[TP_TRACTIONPOWERSOURCE]; n; n = n->nNext)
+        if (!n->psTractionPowerSource->bSection && n->psTractionPowerSource->bLive)
+            if (ps ? n->psTractionPowerSource->iArea > ps->iArea : true)
+            {
+                ps = n->psTractionPowerSource;
+                name = n->asName;
+            }
+    if (!ps)
+        return;
+    int i = 0, k, errors = 0, sides[2];
+    for (n = nRootOfType[TP_TRACTION]; n; n = n->nNext)
+        ++i;
+    TTractionPowerSource **power = new TTractionPowerSource *[i + i];
+    float *res = new float[i + i];
+    i = 0;
+    for (n = nRootOfType[TP_TRACTION]; n; n = n->nNext)
+        for (k = 0; k < 2; ++k)
+        {
+            power[i] = n->hvTraction->psPower[k];
+            res[i++] = n->hvTraction->fResistance[k];
+        }
+    double u = ps->VoltageNominal();
+    bool live = ps->bLive, isolated = ps->bIsolated;
+    LARGE_INTEGER t0, t1, t2, f;
+    QueryPerformanceCounter(&t0);
+    ps->VoltageSet(0.0); // tak jak wyczenie eventem
+    sides[0] = TractionRepower(ps);
+    QueryPerformanceCounter(&t1);
+    ps->VoltageSet(u);
+    sides[1] = TractionRepower(ps);
+    QueryPerformanceCounter(&t2);
+    i = 0;
+    for (n = nRootOfType[TP_TRACTION]; n; n = n->nNext)
+        for (k = 0; k < 2; ++k, ++i)
+            if (power[i] != n->hvTraction->psPower[k])
+                ++errors;
+            else if (res[i] >= 0.0 ? fabs(res[i] - n->hvTraction->fResistance[k]) > 0.001 : false)
+                ++errors; // na poczeniu segmentw rezystancja po wczytaniu nie jest ustalona
+    i = 0;
+    for (n = nRootOfType[TP_TRACTION]; n; n = n->nNext)
+        for (k = 0; k < 2; ++k, ++i)
+        { // zasilanie przse jak po wczytaniu
+            n->hvTraction->psPower[k] = power[i];
+            n->hvTraction->fResistance[k] = res[i];
+        }
+    ps->bLive = live;
+    ps->bIsolated = isolated;
+    delete[] power;
+    delete[] res;
+    QueryPerformanceFrequency(&f);
+    WriteLog("Traction repower: \"" + name + "\" failure " +
+             FloatToStrF(1000.0 * double(t1.QuadPart - t0.QuadPart) / f.QuadPart, ffFixed, 7, 3) +
+             " ms (" + AnsiString(sides[0]) + " sides), restore " +
+             FloatToStrF(1000.0 * double(t2.QuadPart - t1.QuadPart) / f.QuadPart, ffFixed, 7, 3) +
+             " ms (" + AnsiString(sides[1]) + " sides), mismatches " + AnsiString(errors));
+};
+
+bool TGround::AddToQuery(TEvent *Event, TDynamicObject *Node, double fWait)
+{ // (fWait) - dodatkowe opnienie pozycji z rozwinitej listy multiple
     if (Event->bEnabled) // jeli moe by dodany do kolejki (nie uywany w skanowaniu)
         if (!Event->iQueued) // jeli nie dodany jeszcze do kolejki
         { // kolejka eventw jest posortowana wzgldem (fStartTime)
             Event->Activator = Node;
-            if (Event->Type == tp_AddValues ? (Event->fDelay == 0.0) : false)
+            ++Event->iProfQueued; // statystyka
+            if (Event->Type == tp_AddValues ? (Event->fDelay == 0.0) && (fWait == 0.0) : false)
             { // eventy AddValues trzeba wykonywa natychmiastowo, inaczej kolejka moe zgubi
                 // jakie dodawanie
                 // Ra: kopiowanie wykonania tu jest bez sensu, lepiej by byo wydzieli funkcj
                 // wykonujc eventy i j wywoa
+                __int64 t0 = EventProfile::Start();
                 if (EventConditon(Event))
                 { // teraz mog by warunki do tych eventw
                     Event->Params[5].asMemCell->UpdateValues(
@@ -3797,6 +4462,9 @@ bool TGround::AddToQuery(TEvent *Event, TDynamicObject *Node)
                                  AnsiString(Event->Params[1].asdouble) + " " +
                                  AnsiString(Event->Params[2].asdouble));
                 }
+                else
+                    ++Event->iProfFailed;
+                EventProfile::Stop(Event, t0);
                 Event =
                     Event
                         ->evJoined; // jeli jest kolejny o takiej samej nazwie, to idzie do kolejki
@@ -3805,8 +4473,8 @@ bool TGround::AddToQuery(TEvent *Event, TDynamicObject *Node)
             { // standardowe dodanie do kolejki
                 WriteLog("EVENT ADDED TO QUEUE: " + Event->asName +
                          (Node ? AnsiString(" by " + Node->asName) : AnsiString("")));
-                Event->fStartTime =
-                    fabs(Event->fDelay) + Timer::GetTime(); // czas od uruchomienia scenerii
+                Event->fStartTime = fabs(Event->fDelay) + fWait +
+                                    Timer::GetTime(); // czas od uruchomienia scenerii
                 if (Event->fRandomDelay > 0.0)
                     Event->fStartTime += Event->fRandomDelay * random(10000) *
                                          0.0001; // doliczenie losowego czasu opnienia
@@ -3823,6 +4491,11 @@ bool TGround::AddToQuery(TEvent *Event, TDynamicObject *Node)
     return true;
 }
 
+bool TGround::EventProfileDump()
+{ // zapis statystyki eventw do plikw
+    return EventProfile::Dump(RootEvent);
+};
+
 bool TGround::EventConditon(TEvent *e)
 { // sprawdzenie spelnienia warunkw dla eventu
     if (e->iFlags <= update_only)
@@ -3953,6 +4626,7 @@ bool TGround::CheckQuery()
             WriteLog("EVENT LAUNCHED: " + tmpEvent->asName +
                      (tmpEvent->Activator ? AnsiString(" by " + tmpEvent->Activator->asName) :
                                             AnsiString("")));
+            __int64 t0 = EventProfile::Start(); // czas liczony razem z natychmiastowymi AddValues
             switch (tmpEvent->Type)
             {
             case tp_CopyValues: // skopiowanie wartoci z innej komrki
@@ -3988,6 +4662,8 @@ bool TGround::CheckQuery()
                                  " " + AnsiString(tmpEvent->Params[1].asdouble) + " " +
                                  AnsiString(tmpEvent->Params[2].asdouble));
                 }
+                else
+                    ++tmpEvent->iProfFailed;
                 break;
             case tp_GetValues:
                 if (tmpEvent->Activator)
@@ -4105,34 +4781,39 @@ bool TGround::CheckQuery()
             case tp_Multiple:
             {
                 bCondition = EventConditon(tmpEvent);
+                if (!bCondition)
+                    ++tmpEvent->iProfFailed; // statystyka, rwnie gdy jest else
                 if (bCondition || (tmpEvent->iFlags &
                                    conditional_anyelse)) // warunek spelniony albo byo uyte else
                 {
                     WriteLog("Multiple passed");
-                    for (i = 0; i < 8; ++i)
-                    { // dodawane do kolejki w kolejnoci zapisania
-                        if (tmpEvent->Params[i].asEvent)
-                            if (bCondition != bool(tmpEvent->iFlags & (conditional_else << i)))
-                            {
-                                if (tmpEvent->Params[i].asEvent != tmpEvent)
-                                    AddToQuery(tmpEvent->Params[i].asEvent,
-                                               tmpEvent->Activator); // normalnie doda
-                                else // jeli ma by rekurencja
-                                    if (tmpEvent->fDelay >=
-                                        5.0) // to musi mie sensowny okres powtarzania
-                                    if (tmpEvent->iQueued < 2)
-                                    { // trzeba zrobi wyjtek, aby event mg si sam doda do
-                                        // kolejki, raz ju jest, ale bdzie usunity
-                                        // ptla eventowa moe by uruchomiona wiele razy, ale tylko
-                                        // pierwsze uruchomienie zadziaa
-                                        tmpEvent->iQueued =
-                                            0; // tymczasowo, aby by ponownie dodany do kolejki
-                                        AddToQuery(tmpEvent, tmpEvent->Activator);
-                                        tmpEvent->iQueued =
-                                            2; // kolejny raz ju absolutnie nie dodawa
-                                    }
-                            }
-                    }
+                    if (tmpEvent->faFlat[bCondition]) // rozwinite przy wczytywaniu
+                        FlatToQuery(tmpEvent, bCondition);
+                    else
+                        for (i = 0; i < 8; ++i)
+                        { // dodawane do kolejki w kolejnoci zapisania
+                            if (tmpEvent->Params[i].asEvent)
+                                if (bCondition != bool(tmpEvent->iFlags & (conditional_else << i)))
+                                {
+                                    if (tmpEvent->Params[i].asEvent != tmpEvent)
+                                        AddToQuery(tmpEvent->Params[i].asEvent,
+                                                   tmpEvent->Activator); // normalnie doda
+                                    else // jeli ma by rekurencja
+                                        if (tmpEvent->fDelay >=
+                                            5.0) // to musi mie sensowny okres powtarzania
+                                        if (tmpEvent->iQueued < 2)
+                                        { // trzeba zrobi wyjtek, aby event mg si sam doda do
+                                            // kolejki, raz ju jest, ale bdzie usunity
+                                            // ptla eventowa moe by uruchomiona wiele razy, ale tylko
+                                            // pierwsze uruchomienie zadziaa
+                                            tmpEvent->iQueued =
+                                                0; // tymczasowo, aby by ponownie dodany do kolejki
+                                            AddToQuery(tmpEvent, tmpEvent->Activator);
+                                            tmpEvent->iQueued =
+                                                2; // kolejny raz ju absolutnie nie dodawa
+                                        }
+                                }
+                        }
                     if (Global::iMultiplayer) // dajemy zna do serwera o wykonaniu
                         if ((tmpEvent->iFlags & conditional_anyelse) ==
                             0) // jednoznaczne tylko, gdy nie byo else
@@ -4217,6 +4898,7 @@ bool TGround::CheckQuery()
             case tp_Message: // wywietlenie komunikatu
                 break;
             } // switch (tmpEvent->Type)
+            EventProfile::Stop(tmpEvent, t0);
         } // if (tmpEvent->bEnabled)
         --tmpEvent->iQueued; // teraz moze by ponownie dodany do kolejki
         /*
@@ -4248,6 +4930,527 @@ void TGround::UpdatePhys(double dt, int iter)
     for (TGroundNode *Current = nRootOfType[TP_TRACTIONPOWERSOURCE]; Current;
          Current = Current->nNext)
         Current->psTractionPowerSource->Update(dt * iter); // zerowanie sumy prdw
+    for (TGroundNode *Current = nRootOfType[TP_TRACTIONPOWERSOURCE]; Current;
+         Current = Current->nNext)
+        if (Current->psTractionPowerSource->Live() != Current->psTractionPowerSource->bLive)
+        { // bezpiecznik albo event zmieni stan zasilacza
+            LARGE_INTEGER t0, t1, f;
+            QueryPerformanceCounter(&t0);
+            int n = TractionRepower(Current->psTractionPowerSource);
+            QueryPerformanceCounter(&t1);
+            QueryPerformanceFrequency(&f);
+            WriteLog("Traction repower: \"" + Current->asName + "\" " +
+                     (Current->psTractionPowerSource->bLive ? "on, " : "off, ") + AnsiString(n) +
+                     " sides in " +
+                     FloatToStrF(1000.0 * double(t1.QuadPart - t0.QuadPart) / f.QuadPart, ffFixed,
+                                 7, 3) +
+                     " ms");
+        }
+    if (pPowerNet) // napicia w sieci dla prdw pantografw z poprzedniego kroku
+        pPowerNet->Solve();
+    if (Global::fPowerTelemetry > 0.0)
+        TractionTelemetry(dt * iter);
+};
+
+void TGround::TractionTelemetry(double dt)
+{ // prbka obcienia zasilaczy; pojazdy s liczone ze stykw zebranych w GetTractionAll()
+    if (!PowerTelemetry::Due(dt))
+        return;
+    for (TGroundNode *n = nRootOfType[TP_TRACTIONPOWERSOURCE]; n; n = n->nNext)
+        n->psTractionPowerSource->iVehicles = 0;
+    TDynamicObject *d = NULL;
+    TTraction *w;
+    TTractionPowerSource *ps[3], *seen[8]; // zasilacze ju policzone dla biecego pojazdu
+    int i, j, k, m = 0;
+    for (i = 0; i < iContacts; ++i)
+        if ((w = pContacts[i].pant->hvPowerWire) != NULL)
+        { // styki jednego pojazdu s kolejno, pojazd liczy si raz dla kadego zasilacza
+            if (d != pContacts[i].dyn)
+                m = 0;
+            d = pContacts[i].dyn;
+            ps[0] = w->psSection;
+            ps[1] = w->psPowered ? w->psPowered : w->psPower[0]; // podstacje zasilajce przso
+            ps[2] = w->psPowered ? NULL : w->psPower[1];
+            for (j = 0; j < 3; ++j)
+                if (ps[j])
+                {
+                    for (k = 0; k < m; ++k)
+                        if (seen[k] == ps[j])
+                            break;
+                    if (k < m)
+                        continue;
+                    if (m < 8)
+                        seen[m++] = ps[j];
+                    ++ps[j]->iVehicles;
+                }
+        }
+    PowerTelemetry::Sample();
+};
+
+void TGround::IslandsBuild()
+{ // podzia pojazdw na niezalene grupy: poczone sprzgami oraz wykryte skanowaniem
+    // (wirtualne poczenie PrevConnected/NextConnected), w kolejnoci listy pojazdw
+    TGroundNode *Current;
+    TDynamicObject *c;
+    int i, j, k, a, b, n = 0;
+    for (Current = nRootDynamic; Current; Current = Current->nNext)
+        ++n;
+    if (!pIslandFirst || (n > iIslandSize))
+    { // powikszenie tablic z zapasem
+        delete[] pIslandList;
+        delete[] pIslandCars;
+        delete[] pIslandParent;
+        delete[] pIslandNo;
+        delete[] pIslandFirst;
+        delete[] pIslandAwake;
+        delete[] pIslandDistant;
+        delete[] pActive;
+        delete[] pConsists;
+        iIslandSize = n + 64;
+        pIslandList = new TDynamicObject *[iIslandSize];
+        pIslandCars = new TDynamicObject *[iIslandSize];
+        pIslandParent = new int[iIslandSize];
+        pIslandNo = new int[iIslandSize];
+        pIslandFirst = new int[iIslandSize + 1];
+        pIslandAwake = new int[iIslandSize];
+        pIslandDistant = new int[iIslandSize];
+        pActive = new TDynamicObject *[iIslandSize];
+        pConsists = new TConsist[iIslandSize]; // grup nie moe by wicej ni pojazdw
+    }
+    for (n = 0, Current = nRootDynamic; Current; Current = Current->nNext, ++n)
+    { // numeracja wg listy
+        pIslandList[n] = Current->DynamicObject;
+        pIslandList[n]->iIsland = n;
+        pIslandParent[n] = n;
+    }
+    for (i = 0; i < n; ++i)
+        for (j = 0; j < 2; ++j)
+        { // czenie z ssiadami (rwnie wirtualnymi)
+            c = j ? pIslandList[i]->NextConnected : pIslandList[i]->PrevConnected;
+            if (!c)
+                continue;
+            k = c->iIsland;
+            if ((k < 0) || (k >= n) ? true : pIslandList[k] != c)
+                continue; // nie ma go w licie
+            for (a = i; pIslandParent[a] != a; a = pIslandParent[a] = pIslandParent[pIslandParent[a]])
+                ;
+            for (b = k; pIslandParent[b] != b; b = pIslandParent[b] = pIslandParent[pIslandParent[b]])
+                ;
+            if (a < b) // korzeniem jest pojazd najwczeniejszy w licie
+                pIslandParent[b] = a;
+            else if (b < a)
+                pIslandParent[a] = b;
+        }
+    iIslands = 0;
+    for (i = 0; i < n; ++i)
+    { // numery grup w kolejnoci pierwszego pojazdu i ich licznoci
+        for (a = i; pIslandParent[a] != a; a = pIslandParent[a])
+            ;
+        if (a == i)
+            pIslandFirst[pIslandNo[i] = iIslands++] = 0;
+        else
+            pIslandNo[i] = pIslandNo[a]; // korze ma mniejszy numer, wic ju ustalony
+        ++pIslandFirst[pIslandNo[i]];
+    }
+    for (k = 0, i = 0; i < iIslands; ++i)
+    { // zamiana licznoci na pocztki, (pIslandParent) posuy jako licznik wstawiania
+        j = pIslandFirst[i];
+        pIslandFirst[i] = pIslandParent[i] = k;
+        k += j;
+    }
+    pIslandFirst[iIslands] = n;
+    for (i = 0; i < n; ++i) // wewntrz grupy kolejno jak w licie, jak przy liczeniu w jednym wtku
+        pIslandCars[pIslandParent[pIslandNo[i]]++] = pIslandList[i];
+};
+
+void TGround::ActiveBuild(double dt)
+{ // lista pojazdw do przeliczenia w biecej klatce, (dt) - czas od poprzedniej klatki;
+    // grupa jest usypiana, gdy wszystkie jej pojazdy stoj bez obsady i bez zmian (Idle());
+    // sprzgnicie albo wykrycie skanowaniem czy pojazd z grup, wic ruch ssiada j budzi;
+    // grupy oddalone (physicslod) trafiaj do (pIslandDistant), a nie do (pActive)
+    int i, k, n;
+    bool awake;
+    IslandsBuild();
+    n = pIslandFirst[iIslands]; // ilo pojazdw
+    iIslandsAwake = iIslandsDistant = iActive = iSleeping = iDistant = 0;
+    for (k = 0; k < iIslands; ++k)
+    { // (pIslandParent) nie jest ju potrzebne, posuy jako flaga przeliczania grupy
+        awake = !Global::bSleepDynamic;
+        if (!awake)
+            for (i = pIslandFirst[k]; i < pIslandFirst[k + 1]; ++i)
+                if (!pIslandCars[i]->Idle(dt)) // sprawdzi trzeba wszystkie, bo licz czas
+                    awake = true;
+        if (!awake)
+            iSleeping += pIslandFirst[k + 1] - pIslandFirst[k];
+        else if (IslandDistant(k))
+        { // liczona uproszczonym modelem w DistantUpdate()
+            pIslandDistant[iIslandsDistant++] = k;
+            iDistant += pIslandFirst[k + 1] - pIslandFirst[k];
+            awake = false; // nie do (pActive)
+        }
+        else
+            pIslandAwake[iIslandsAwake++] = k;
+        pIslandParent[k] = awake;
+    }
+    for (i = 0; i < n; ++i) // kolejno jak w licie pojazdw
+        if (pIslandParent[pIslandNo[i]])
+            pActive[iActive++] = pIslandList[i];
+};
+
+bool TGround::IslandDistant(int k)
+{ // czy grup (k) mona liczy jako mas punktow: bez obsady uytkownika, dalej ni
+    // (fPhysicsLod) od kamery i od pojazdu uytkownika; powrt nastpuje dopiero przy 90%
+    // tej odlegoci, aby tryb nie przecza si co klatk; manewry i zblianie si do
+    // pojazdw przez sprzg wirtualny zostaj w penym modelu, bo Mover liczy je jawnie, a
+    // krok dla masy punktowej jest dla nich za dugi
+    if (Global::fPhysicsLod <= 0.0)
+        return false;
+    TDynamicObject *d;
+    int i;
+    bool distant = true;
+    double r = Global::fPhysicsLod * (pIslandCars[pIslandFirst[k]]->bDistant ? 0.9 : 1.0);
+    r *= r;
+    for (i = pIslandFirst[k]; distant && (i < pIslandFirst[k + 1]); ++i)
+    {
+        d = pIslandCars[i];
+        if ((d == Global::pUserDynamic) || (d->Controller == Humandriver) || d->MechInside)
+            distant = false;
+        else if (d->Mechanik ? d->Mechanik->Shunting() : false)
+            distant = false; // czenie i odczepianie wagonw
+        else if (d->VirtualContact())
+            distant = false;
+        else if (SquareMagnitude(d->GetPosition() - Global::GetCameraPosition()) < r)
+            distant = false;
+        else if (Global::pUserDynamic ?
+                     SquareMagnitude(d->GetPosition() - Global::pUserDynamic->GetPosition()) < r :
+                     false)
+            distant = false;
+    }
+    for (i = pIslandFirst[k]; i < pIslandFirst[k + 1]; ++i)
+        pIslandCars[i]->bDistant = distant;
+    return distant;
+};
+
+void TGround::DistantUpdate(double dt)
+{ // grupy oddalone raz na klatk, (dt) - czas od poprzedniej klatki; sprzgi nie zmieniaj
+    // ugicia; druty nad pantografami s szukane raz, na pocztku klatki, a styki dopisywane za
+    // zebranymi w GetTractionAll(), wic Update() pobiera prd przez VoltageGet() z waciwego
+    // przsa, a TractionTelemetry() liczy te pojazdy
+    const double step = 0.05; //[s] najduszy krok, jak fMaxDt dla pjawnego
+    int m = int(ceil(dt / step));
+    double h = dt / m;
+    int g, i, j, k, n, first = iContacts;
+    TDynamicObject **c;
+    for (g = 0; g < iIslandsDistant; ++g)
+    {
+        k = pIslandDistant[g];
+        for (i = pIslandFirst[k]; i < pIslandFirst[k + 1]; ++i)
+            if (pIslandCars[i]->MoverParameters->EnginePowerSource.SourceType == CurrentCollector)
+                PantGather(pIslandCars[i]);
+    }
+    PantContacts(first, iContacts - first);
+    PantSearches(first, iContacts - first);
+    for (g = 0; g < iIslandsDistant; ++g)
+    {
+        k = pIslandDistant[g];
+        c = pIslandCars + pIslandFirst[k];
+        n = pIslandFirst[k + 1] - pIslandFirst[k];
+        for (i = 0; i < n; ++i)
+        {
+            c[i]->MoverParameters->ComputeConstans();
+            c[i]->CoupleDist();
+        }
+        for (j = 1; j <= m; ++j)
+        { // ostatni krok peny: przesunicie po torach, AI, eventy
+            pConsists[k].CouplerForces(c, n);
+            for (i = 0; i < n; ++i)
+                c[i]->UpdateForce(h, j < m ? h : dt, j == m);
+            pConsists[k].Rigid(c, n, h);
+            pConsists[k].PipeSolve(c, n, h); // niejawnie, bo krok jest dugi
+            for (i = 0; i < n; ++i)
+                if (j < m)
+                    c[i]->FastUpdate(h);
+                else
+                    c[i]->Update(h, dt);
+        }
+    }
+};
+
+void TGround::ConsistForces()
+{ // siy na sprzgach dla wszystkich nieupionych grup, przed ptl UpdateForce()
+    if (Global::bConsistForces || Global::iIntegrator) // integrator korzysta z zebranych pocze
+        for (int i = 0; i < iIslandsAwake; ++i)
+        {
+            int k = pIslandAwake[i];
+            pConsists[k].CouplerForces(pIslandCars + pIslandFirst[k],
+                                       pIslandFirst[k + 1] - pIslandFirst[k]);
+        }
+};
+
+void TGround::ConsistBenchmark()
+{ // siy na sprzgach wszystkich grup: TConsist (po) wzgldem CouplerForce() z Mover dla kadego
+    // koca osobno (przed); najwiksza rnica si dla tego samego stanu i czasy kroku;
+    // ugicia, siy, flagi zderzenia i dwikw s potem odtwarzane
+    const int repeat = 100;
+    IslandsBuild();
+    int n = pIslandFirst[iIslands], i, j, k, r, links = 0;
+    if (!n)
+        return;
+    TMoverParameters *m;
+    double *keep = new double[4 * n]; // Dist i CForce obu sprzgw
+    char *flag = new char[4 * n]; // CheckCollision obu sprzgw, SoundFlag, sprzgi z TConsist
+    double *force = new double[2 * n]; // siy z TConsist
+    double e = 0.0, time[2];
+    LARGE_INTEGER f, t0, t1;
+    QueryPerformanceFrequency(&f);
+    for (i = 0; i < n; ++i)
+    {
+        pIslandCars[i]->CoupleDist(); // jak na pocztku klatki
+        m = pIslandCars[i]->MoverParameters;
+        for (j = 0; j < 2; ++j)
+        {
+            keep[4 * i + 2 * j] = m->Couplers[j].Dist;
+            keep[4 * i + 2 * j + 1] = m->Couplers[j].CForce;
+            flag[4 * i + j] = m->Couplers[j].CheckCollision;
+        }
+        flag[4 * i + 2] = m->SoundFlag;
+    }
+    for (r = 0; r <= repeat; ++r)
+    { // pierwszy przebieg do porwnania, reszta do pomiaru
+        if (r == 1)
+            QueryPerformanceCounter(&t0);
+        for (k = 0; k < iIslands; ++k)
+            pConsists[k].CouplerForces(pIslandCars + pIslandFirst[k],
+                                       pIslandFirst[k + 1] - pIslandFirst[k]);
+        if (!r)
+            for (k = 0; k < iIslands; ++k)
+                links += pConsists[k].Links();
+        for (i = 0; i < n; ++i)
+        {
+            m = pIslandCars[i]->MoverParameters;
+            if (!r)
+            {
+                flag[4 * i + 3] = m->iCouplerSolved;
+                force[2 * i] = m->Couplers[0].CForce;
+                force[2 * i + 1] = m->Couplers[1].CForce;
+            }
+            m->iCouplerSolved = 0;
+            for (j = 0; j < 2; ++j)
+                m->Couplers[j].Dist = keep[4 * i + 2 * j]; // ten sam stan w kadym przebiegu
+        }
+    }
+    QueryPerformanceCounter(&t1);
+    time[1] = 1e6 * double(t1.QuadPart - t0.QuadPart) / (double(f.QuadPart) * repeat);
+    for (r = 0; r <= repeat; ++r)
+    { // to samo przez Mover, tylko dla kocw policzonych przez TConsist
+        if (r == 1)
+            QueryPerformanceCounter(&t0);
+        for (i = 0; i < n; ++i)
+        {
+            m = pIslandCars[i]->MoverParameters;
+            for (j = 0; j < 2; ++j)
+                if (flag[4 * i + 3] & (1 << j))
+                {
+                    double c = m->CouplerForce(j, 0.01); // moe zmieni CForce ssiada
+                    if (!r)
+                        if (fabs(c - force[2 * i + j]) > e)
+                            e = fabs(c - force[2 * i + j]);
+                }
+        }
+        for (i = 0; i < n; ++i)
+            for (j = 0; j < 2; ++j)
+                pIslandCars[i]->MoverParameters->Couplers[j].Dist = keep[4 * i + 2 * j];
+    }
+    QueryPerformanceCounter(&t1);
+    time[0] = 1e6 * double(t1.QuadPart - t0.QuadPart) / (double(f.QuadPart) * repeat);
+    for (i = 0; i < n; ++i)
+    { // stan sprzed pomiaru
+        m = pIslandCars[i]->MoverParameters;
+        for (j = 0; j < 2; ++j)
+        {
+            m->Couplers[j].CForce = keep[4 * i + 2 * j + 1];
+            m->Couplers[j].CheckCollision = flag[4 * i + j];
+        }
+        m->SoundFlag = flag[4 * i + 2];
+    }
+    delete[] keep;
+    delete[] flag;
+    delete[] force;
+    WriteLog("Coupler forces: " + AnsiString(links) + " links in " + AnsiString(iIslands) +
+             " groups, mover " + FloatToStrF(time[0], ffFixed, 7, 1) + " us/step, consist " +
+             FloatToStrF(time[1], ffFixed, 7, 1) + " us/step, max difference " +
+             FloatToStrF(e, ffFixed, 7, 3) + " N");
+};
+
+void TGround::ConsistIntegrate(double dt)
+{ // pjawne cakowanie i przewd gwny dla nieupionych grup, po ptli UpdateForce()
+    if (Global::iIntegrator || Global::bConsistPipe)
+        for (int i = 0; i < iIslandsAwake; ++i)
+        {
+            int k = pIslandAwake[i];
+            if (Global::iIntegrator)
+                pConsists[k].Integrate(pIslandCars + pIslandFirst[k],
+                                       pIslandFirst[k + 1] - pIslandFirst[k], dt);
+            if (Global::bConsistPipe)
+                pConsists[k].PipeSolve(pIslandCars + pIslandFirst[k],
+                                       pIslandFirst[k + 1] - pIslandFirst[k], dt);
+        }
+};
+
+void TGround::SleepBenchmark()
+{ // porwnanie usypiania stojcych grup z przeliczaniem wszystkich pojazdw: 30s fizyki caej
+    // scenerii od tego samego stanu bez usypiania i z usypianiem; czas klatki, ilo upionych
+    // oraz najwiksze rnice stanu pojazdw, ktre spay; potem stan scenerii jest odtwarzany
+    if (Replay::Recording() || Replay::Playing())
+        return; // przebiegi zmieniaj cig liczb losowych
+    const int frames = 300; // klatki po 0.1s
+    TGroundNode *Current;
+    int i, j, k, n = 0, asleep = 0;
+    for (Current = nRootDynamic; Current; Current = Current->nNext)
+        ++n;
+    if (!n)
+        return;
+    if (!TSaveState::Keep(this))
+    {
+        ErrorLog("Bad state: sleep benchmark cannot keep the scenery state");
+        return;
+    }
+    double *s = new double[6 * n]; // pooenie, prdko i cinienia po przebiegu bez usypiania
+    bool *slept = new bool[n];
+    double time[2], e[5] = {0.0, 0.0, 0.0, 0.0, 0.0}, d;
+    bool sleep = Global::bSleepDynamic, sound = Global::bSoundEnabled;
+    double lod = Global::fPhysicsLod, telemetry = Global::fPowerTelemetry;
+    int seed = System::RandSeed;
+    vector3 p;
+    LARGE_INTEGER f, t0, t1;
+    QueryPerformanceFrequency(&f);
+    Global::bSoundEnabled = false;
+    Global::fPhysicsLod = 0.0; // grupa nie przeliczana jest wtedy na pewno upiona
+    Global::fPowerTelemetry = 0.0; // prbki z przebiegw nie trafiaj do bufora
+    for (j = 0; j < 2; ++j)
+    { // najpierw bez usypiania, bo Idle() liczy czas spokoju tylko przy wczonym
+        if (j)
+            TSaveState::Restore(this);
+        Global::bSleepDynamic = (j > 0);
+        srand(1);
+        System::RandSeed = 1; // ten sam cig losowy w obu przebiegach
+        for (i = 0; i < n; ++i)
+            slept[i] = false;
+        QueryPerformanceCounter(&t0);
+        for (k = 0; k < frames; ++k)
+        {
+            Update(0.01, 10);
+            for (i = 0; i < pIslandFirst[iIslands]; ++i) // kolejno jak w licie pojazdw
+                if (!pIslandParent[pIslandNo[i]])
+                    slept[i] = true;
+        }
+        QueryPerformanceCounter(&t1);
+        time[j] = 1000.0 * double(t1.QuadPart - t0.QuadPart) / (double(f.QuadPart) * frames);
+        for (i = 0, Current = nRootDynamic; Current && (i < n); Current = Current->nNext, ++i)
+        {
+            p = Current->DynamicObject->GetPosition();
+            if (!j)
+            {
+                s[6 * i] = p.x;
+                s[6 * i + 1] = p.y;
+                s[6 * i + 2] = p.z;
+                s[6 * i + 3] = Current->DynamicObject->MoverParameters->V;
+                s[6 * i + 4] = Current->DynamicObject->MoverParameters->PipePress;
+                s[6 * i + 5] = Current->DynamicObject->MoverParameters->BrakePress;
+                continue;
+            }
+            d = sqrt((p.x - s[6 * i]) * (p.x - s[6 * i]) + (p.y - s[6 * i + 1]) *
+                     (p.y - s[6 * i + 1]) + (p.z - s[6 * i + 2]) * (p.z - s[6 * i + 2]));
+            if (!slept[i])
+            { // jedzi w obu przebiegach, rnica moe wynika tylko ze picych ssiadw
+                if (d > e[4])
+                    e[4] = d;
+                continue;
+            }
+            ++asleep;
+            if (d > e[0])
+                e[0] = d;
+            d = fabs(Current->DynamicObject->MoverParameters->V - s[6 * i + 3]);
+            if (d > e[1])
+                e[1] = d;
+            d = fabs(Current->DynamicObject->MoverParameters->PipePress - s[6 * i + 4]);
+            if (d > e[2])
+                e[2] = d;
+            d = fabs(Current->DynamicObject->MoverParameters->BrakePress - s[6 * i + 5]);
+            if (d > e[3])
+                e[3] = d;
+        }
+    }
+    bool ok = TSaveState::Restore(this);
+    Global::bSleepDynamic = sleep;
+    Global::bSoundEnabled = sound;
+    Global::fPhysicsLod = lod;
+    Global::fPowerTelemetry = telemetry;
+    System::RandSeed = seed;
+    delete[] s;
+    delete[] slept;
+    if (!ok)
+        ErrorLog("Bad state: vehicle list changed during sleep benchmark, state not restored");
+    WriteLog("Sleep compare: " + AnsiString(n) + " vehicles, " + AnsiString(asleep) +
+             " slept, frame " + FloatToStrF(time[0], ffFixed, 7, 3) + " ms awake, " +
+             FloatToStrF(time[1], ffFixed, 7, 3) + " ms with sleep");
+    WriteLog("Sleep compare: sleeping vehicles max error pos " +
+             FloatToStrF(1000.0 * e[0], ffFixed, 7, 3) + "mm, vel " +
+             FloatToStrF(e[1], ffFixed, 7, 4) + "m/s, pipe " + FloatToStrF(e[2], ffFixed, 7, 4) +
+             "MPa, cylinder " + FloatToStrF(e[3], ffFixed, 7, 4) + "MPa; moving vehicles pos " +
+             FloatToStrF(1000.0 * e[4], ffFixed, 7, 3) + "mm");
+};
+
+void IslandJob(void *data, int k)
+{ // zadanie dla wtku: (k)-ta nieupiona grupa
+    ((TGround *)data)->IslandUpdate(k);
+};
+
+void TGround::IslandUpdate(int k)
+{ // kroki fizyki jednej grupy, tak samo jak w TGround::Update() dla wszystkich pojazdw
+    k = pIslandAwake[k]; // numer grupy
+    TDynamicObject **c = pIslandCars + pIslandFirst[k];
+    int n = pIslandFirst[k + 1] - pIslandFirst[k];
+    int i, j;
+    for (i = 0; i < n; ++i)
+    {
+        c[i]->MoverParameters->ComputeConstans();
+        c[i]->CoupleDist();
+    }
+    if (Global::bConsistForces || Global::iIntegrator)
+        pConsists[k].CouplerForces(c, n);
+    for (i = 0; i < n; ++i)
+        c[i]->UpdateForce(fIslandDt, fIslandDt, false);
+    if (Global::iIntegrator)
+        pConsists[k].Integrate(c, n, fIslandDt);
+    if (Global::bConsistPipe)
+        pConsists[k].PipeSolve(c, n, fIslandDt);
+    for (i = 0; i < n; ++i)
+        c[i]->FastUpdate(fIslandDt, false); // model adunku nie moe by wczytywany w wtku
+    for (j = 1; j < (iIslandIter - 1); ++j)
+    {
+        if (Global::bConsistForces || Global::iIntegrator)
+            pConsists[k].CouplerForces(c, n);
+        for (i = 0; i < n; ++i)
+            c[i]->UpdateForce(fIslandDt, fIslandDt, false);
+        if (Global::iIntegrator)
+            pConsists[k].Integrate(c, n, fIslandDt);
+        if (Global::bConsistPipe)
+            pConsists[k].PipeSolve(c, n, fIslandDt);
+        for (i = 0; i < n; ++i)
+            c[i]->FastUpdate(fIslandDt, false);
+    }
+};
+
+void TGround::IslandsUpdate(double dt, int iter)
+{ // rwnolege przeliczenie krokw porednich; przesuwanie pojazdw po torach, eventy,
+    // trakcja i zderzenia pomidzy grupami zostaj w czci szeregowej (Update)
+    fIslandDt = dt; // grupy s ju podzielone w ActiveBuild()
+    iIslandIter = iter;
+    pPool->Run(IslandJob, this, iIslandsAwake);
+    for (int i = 0; i < iActive; ++i)
+        if (pActive[i]->MoverParameters->LoadStatus)
+            pActive[i]->LoadUpdate(); // pominite w wtkach
 };
 
 bool TGround::Update(double dt, int iter)
@@ -4260,318 +5463,501 @@ bool TGround::Update(double dt, int iter)
     //    na ktr by si zapisyway wszystkie pojazdy bdce w ruchu
     //    pojazdy stojce nie potrzebuj aktualizacji, chyba e np. kto im zmieni nastaw hamulca
     //    oddzieln list mona by zrobi na pojazdy z napdem, najlepiej posortowan wg typu napdu
+    // lista (pActive) pomija grupy pojazdw stojcych bez obsady (upione)
+    int i;
+    LARGE_INTEGER t0, t1; // pomiar czasu kroku fizyki
+    QueryPerformanceCounter(&t0);
+    ActiveBuild(dt * iter);
+    if (Global::iIntegrator && (dt > 0.01))
+        for (i = 0; i < iActive; ++i)
+            if (pActive[i]->VirtualContact())
+            { // zderzenie przez sprzg wirtualny liczy Mover jawnie, wic krok jak dla jawnego;
+                // dotyczy caej klatki, bo grupy maj wspln ptl krokw
+                int m = int(ceil(dt / 0.01));
+                dt /= m;
+                iter *= m;
+                break;
+            }
     if (iter > 1) // ABu: ponizsze wykonujemy tylko jesli wiecej niz jedna iteracja
     { // pierwsza iteracja i wyznaczenie stalych:
-        for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
-        { //
-            Current->DynamicObject->MoverParameters->ComputeConstans();
-            Current->DynamicObject->CoupleDist();
-            Current->DynamicObject->UpdateForce(dt, dt, false);
-        }
-        for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
-            Current->DynamicObject->FastUpdate(dt);
-        // pozostale iteracje
-        for (int i = 1; i < (iter - 1); ++i) // jeli iter==5, to wykona si 3 razy
+        if (pPool) // niezalene grupy pojazdw liczone w osobnych wtkach
+            IslandsUpdate(dt, iter);
+        else
         {
-            for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
-                Current->DynamicObject->UpdateForce(dt, dt, false);
-            for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
-                Current->DynamicObject->FastUpdate(dt);
+            for (i = 0; i < iActive; ++i)
+            { //
+                pActive[i]->MoverParameters->ComputeConstans();
+                pActive[i]->CoupleDist();
+            }
+            ConsistForces(); // siy na sprzgach dla skadw naraz
+            for (i = 0; i < iActive; ++i)
+                pActive[i]->UpdateForce(dt, dt, false);
+            ConsistIntegrate(dt); // pjawnie i przewd gwny, jeli wybrane
+            for (i = 0; i < iActive; ++i)
+                pActive[i]->FastUpdate(dt);
+            TIsolated::Flush(); // zajtoci odcinkw izolowanych po kroku
+            // pozostale iteracje
+            for (int j = 1; j < (iter - 1); ++j) // jeli iter==5, to wykona si 3 razy
+            {
+                ConsistForces();
+                for (i = 0; i < iActive; ++i)
+                    pActive[i]->UpdateForce(dt, dt, false);
+                ConsistIntegrate(dt);
+                for (i = 0; i < iActive; ++i)
+                    pActive[i]->FastUpdate(dt);
+                TIsolated::Flush();
+            }
         }
         // ABu 200205: a to robimy tylko raz, bo nie potrzeba wicej
         // Winger 180204 - pantografy
         double dt1 = dt * iter; // cakowity czas
         UpdatePhys(dt1, 1);
         TAnimModel::AnimUpdate(dt1); // wykonanie zakolejkowanych animacji
-        for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
-        { // Ra: zmieni warunek na sprawdzanie pantografw w jednej zmiennej: czy pantografy i czy
-            // podniesione
-            if (Current->DynamicObject->MoverParameters->EnginePowerSource.SourceType ==
-                CurrentCollector)
-                GetTraction(Current->DynamicObject); // poszukiwanie drutu dla pantografw
-            Current->DynamicObject->UpdateForce(dt, dt1, true); //,true);
-        }
-        for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
-            Current->DynamicObject->Update(dt, dt1); // Ra 2015-01: tylko tu przelicza sie
-        // trakcyjn
+        ConsistForces();
+        GetTractionAll(); // poszukiwanie drutu dla pantografw wszystkich pojazdw naraz
+        for (i = 0; i < iActive; ++i)
+            pActive[i]->UpdateForce(dt, dt1, true); //,true);
+        ConsistIntegrate(dt);
+        for (i = 0; i < iActive; ++i)
+            pActive[i]->Update(dt, dt1); // Ra 2015-01: tylko tu przelicza sie trakcyjn
+        TIsolated::Flush();
     }
     else
     { // jezeli jest tylko jedna iteracja
         UpdatePhys(dt, 1);
         TAnimModel::AnimUpdate(dt); // wykonanie zakolejkowanych animacji
-        for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
+        GetTractionAll();
+        for (i = 0; i < iActive; ++i)
         {
-            if (Current->DynamicObject->MoverParameters->EnginePowerSource.SourceType ==
-                CurrentCollector)
-                GetTraction(Current->DynamicObject);
-            Current->DynamicObject->MoverParameters->ComputeConstans();
-            Current->DynamicObject->CoupleDist();
-            Current->DynamicObject->UpdateForce(dt, dt, true); //,true);
+            pActive[i]->MoverParameters->ComputeConstans();
+            pActive[i]->CoupleDist();
         }
-        for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
-            Current->DynamicObject->Update(dt, dt); // Ra 2015-01: tylko tu przelicza sie trakcyjn
+        ConsistForces();
+        for (i = 0; i < iActive; ++i)
+            pActive[i]->UpdateForce(dt, dt, true); //,true);
+        ConsistIntegrate(dt);
+        for (i = 0; i < iActive; ++i)
+            pActive[i]->Update(dt, dt); // Ra 2015-01: tylko tu przelicza sie trakcyjn
+        TIsolated::Flush(); // zajtoci odcinkw izolowanych po kroku
     }
-    if (bDynamicRemove)
-    { // jeli jest co do usunicia z listy, to trzeba na kocu
-        for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
-            if (!Current->DynamicObject->bEnabled)
-            {
-                DynamicRemove(Current->DynamicObject); // usunicie tego i podczonych
-                Current = nRootDynamic; // sprawdzanie listy od pocztku
-            }
-        bDynamicRemove = false; // na razie koniec
+    if (iIslandsDistant)
+    { // skady daleko od kamery jako masy punktowe
+        DistantUpdate(dt * iter);
+        TIsolated::Flush();
+    }
+    QueryPerformanceCounter(&t1);
+    iPhysicsTicks += t1.QuadPart - t0.QuadPart;
+    iPhysicsSteps += iter;
+    if (iPhysicsSteps >= 500)
+    { // urednienie co kilka sekund
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        fPhysicsTime = 1000.0 * double(iPhysicsTicks) / (double(f.QuadPart) * iPhysicsSteps);
+        iPhysicsTicks = 0;
+        iPhysicsSteps = 0;
     }
+    if (!bDynamicRemoveLater)
+        DynamicRemoveDisabled(); // jeli jest co do usunicia z listy, to trzeba na kocu
     return true;
 };
 
-// Winger 170204 - szukanie trakcji nad pantografami
-bool TGround::GetTraction(TDynamicObject *model)
-{ // aktualizacja drutu zasilajcego dla kadego pantografu, eby odczyta napicie
-    // jeli pojazd si nie porusza, to nie ma sensu przelicza tego wicej ni raz
-    double fRaParam; // parametr rwnania parametrycznego odcinka drutu
-    double fVertical; // odlego w pionie; musi by w zasigu ruchu "pionowego" pantografu
-    double fHorizontal; // odlego w bok; powinna by mniejsza ni p szerokoci pantografu
-    vector3 vLeft, vUp, vFront, dwys;
-    vector3 pant0;
-    vector3 vParam; // wspczynniki rwnania parametrycznego drutu
-    vector3 vStyk; // punkt przebicia drutu przez paszczyzn ruchu pantografu
-    vector3 vGdzie; // wektor pooenia drutu wzgldem pojazdu
-    vFront = model->VectorFront(); // wektor normalny dla paszczyzny ruchu pantografu
-    vUp = model->VectorUp(); // wektor pionu puda (pochylony od pionu na przechyce)
-    vLeft = model->VectorLeft(); // wektor odlegoci w bok (odchylony od poziomu na przechyce)
-    dwys = model->GetPosition(); // wsprzdne rodka pojazdu
+void TGround::DynamicRemoveDisabled()
+{ // usunicie wyczonych pojazdw; przy wtku fizyki wywouje to wtek okna, ktry ich uywa
+    if (!bDynamicRemove)
+        return;
+    for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
+        if (!Current->DynamicObject->bEnabled)
+        {
+            DynamicRemove(Current->DynamicObject); // usunicie tego i podczonych
+            Current = nRootDynamic; // sprawdzanie listy od pocztku
+        }
+    bDynamicRemove = false; // na razie koniec
+};
+
+void TGround::Snapshot(int k)
+{ // zapisanie pooe pojazdw do bufora (k) po krokach wtku fizyki
+    for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
+        Current->DynamicObject->Snapshot(k);
+};
+
+void TGround::Interpolate(int k0, int k1, double a)
+{ // pooenia pojazdw do renderowania; k0<0 - fizyka liczona w oknie, bez migawek
+    for (TGroundNode *Current = nRootDynamic; Current; Current = Current->nNext)
+        Current->DynamicObject->Interpolate(k0, k1, a);
+};
+
+struct TPantContact
+{ // podniesiony pantograf zebrany do wsplnego przeliczenia styku z drutem
+    TDynamicObject *dyn; // pojazd, NULL w pomiarze wydajnoci (bez szukania po sektorach)
+    TAnimPant *pant; // dane pantografu
+    vector3 vPos; // pooenie punktu zerowego pantografu w scenerii
+    vector3 vFront, vUp, vLeft; // wersory puda pojazdu
+    vector3 vPoint; // pocztek biecego przsa (kopia pPoint1)
+    vector3 vParam; // wspczynniki rwnania parametrycznego biecego przsa
+    double fParam; // parametr punktu przebicia paszczyzny pantografu przez drut
+};
+
+TPantContact * TGround::ContactAdd()
+{ // dopisanie styku na koniec tablicy, z powikszeniem w razie potrzeby
+    if (iContacts >= iContactsSize)
+    {
+        int n = iContactsSize ? iContactsSize + iContactsSize : 64;
+        TPantContact *c = new TPantContact[n];
+        for (int i = 0; i < iContacts; ++i)
+            c[i] = pContacts[i];
+        delete[] pContacts;
+        delete[] pPending;
+        pContacts = c;
+        pPending = new int[n];
+        iContactsSize = n;
+    }
+    return pContacts + iContacts++;
+};
+
+void TGround::PantGather(TDynamicObject *model)
+{ // dopisanie podniesionych pantografw pojazdu do tablicy stykw
+    vector3 vFront = model->VectorFront(); // wektor normalny dla paszczyzny ruchu pantografu
+    vector3 vUp = model->VectorUp(); // wektor pionu puda (pochylony od pionu na przechyce)
+    vector3 vLeft = model->VectorLeft(); // wektor w bok (odchylony od poziomu na przechyce)
+    vector3 dwys = model->GetPosition(); // wsprzdne rodka pojazdu
     TAnimPant *p; // wskanik do obiektu danych pantografu
+    TPantContact *c;
     for (int k = 0; k < model->iAnimType[ANIM_PANTS]; ++k)
     { // ptla po pantografach
         p = model->pants[k].fParamPants;
         if (k ? model->MoverParameters->PantRearUp : model->MoverParameters->PantFrontUp)
         { // jeli pantograf podniesiony
-            pant0 = dwys + (vLeft * p->vPos.z) + (vUp * p->vPos.y) + (vFront * p->vPos.x);
-            if (p->hvPowerWire)
-            { // jeeli znamy drut z poprzedniego przebiegu
-                int n = 30; //eby si nie zaptli
-                while (p->hvPowerWire)
-                { // powtarzane a do znalezienia odpowiedniego odcinka na licie dwukierunkowej
-                    // obliczamy wyraz wolny rwnania paszczyzny (to miejsce nie jest odpowienie)
-                    vParam = p->hvPowerWire->vParametric; // wspczynniki rwnania parametrycznego
-                    fRaParam = -DotProduct(pant0, vFront);
-                    // podstawiamy rwnanie parametryczne drutu do rwnania paszczyzny pantografu
-                    // vFront.x*(t1x+t*vParam.x)+vFront.y*(t1y+t*vParam.y)+vFront.z*(t1z+t*vParam.z)+fRaDist=0;
-                    fRaParam = -(DotProduct(p->hvPowerWire->pPoint1, vFront) + fRaParam) /
-                               DotProduct(vParam, vFront);
-                    if (fRaParam <
-                        -0.001) // histereza rzdu 7cm na 70m typowego przsa daje 1 promil
-                        p->hvPowerWire = p->hvPowerWire->hvNext[0];
-                    else if (fRaParam > 1.001)
-                        p->hvPowerWire = p->hvPowerWire->hvNext[1];
-                    else if (p->hvPowerWire->iLast & 3)
-                    { // dla ostatniego i przedostatniego przsa wymuszamy szukanie innego
-                        p->hvPowerWire = NULL; // nie to, e nie ma, ale trzeba sprawdzi inne
-                        // p->fHorizontal=fHorizontal; //zapamitanie pooenia drutu
-                        break;
-                    }
-                    else if (p->hvPowerWire->hvParallel)
-                    { // jeli przso tworzy bieni wspln, to trzeba sprawdzi pozostae
-                        p->hvPowerWire = NULL; // nie to, e nie ma, ale trzeba sprawdzi inne
-                        // p->fHorizontal=fHorizontal; //zapamitanie pooenia drutu
-                        break; // tymczasowo dla bieni wsplnych poszukiwanie po caoci
-                    }
-                    else
-                    { // jeli t jest w przedziale, wyznaczy odlego wzdu wektorw vUp i vLeft
-                        vStyk = p->hvPowerWire->pPoint1 + fRaParam * vParam; // punkt styku
-                        // paszczyzny z drutem
-                        // (dla generatora uku
-                        // el.)
-                        vGdzie = vStyk - pant0; // wektor
-                        // odlego w pionie musi by w zasigu ruchu "pionowego" pantografu
-                        fVertical = DotProduct(
-                            vGdzie, vUp); // musi si mieci w przedziale ruchu pantografu
-                        // odlego w bok powinna by mniejsza ni p szerokoci pantografu
-                        fHorizontal = fabs(DotProduct(vGdzie, vLeft)) -
-                                      p->fWidth; // to si musi mieci w przedziale zalenym od
-                        // szerokoci pantografu
-                        // jeli w pionie albo w bok jest za daleko, to dany drut jest nieuyteczny
-                        if (fHorizontal > 0) // 0.635 dla AKP-1 AKP-4E
-                        { // drut wyszed poza zakres roboczy, ale jeszcze jest nabienik -
-                            // pantograf si unosi bez utraty prdu
-                            if (fHorizontal > p->fWidthExtra) // czy wyszed za nabienik
-                            {
-                                p->hvPowerWire = NULL; // dotychczasowy drut nie liczy si
-                                // p->fHorizontal=fHorizontal; //zapamitanie pooenia drutu
-                            }
-                            else
-                            { // problem jest, gdy nowy drut jest wyej, wtedy pantograf odcza si
-                                // od starego, a na podniesienie do nowego potrzebuje czasu
-                                p->PantTraction =
-                                    fVertical +
-                                    0.15 * fHorizontal / p->fWidthExtra; // na razie liniowo na
-                                // nabieniku, dokadno
-                                // poprawi si pniej
-                                // p->fHorizontal=fHorizontal; //zapamitanie pooenia drutu
-                            }
-                        }
-                        else
-                        { // po wyselekcjonowaniu drutu, przypisa go do toru, eby nie trzeba byo
-                            // szuka
-                            // dla 3 kocowych przse sprawdzi wszystkie dostpne przsa
-                            // bo mog by umieszczone rwnolegle nad torem - poczy w piercie
-                            // najlepiej, jakby odcinki rwnolege byy oznaczone we wpisach
-                            // WriteLog("Drut: "+AnsiString(fHorizontal)+" "+AnsiString(fVertical));
-                            p->PantTraction = fVertical;
-                            // p->fHorizontal=fHorizontal; //zapamitanie pooenia drutu
-                            break; // koniec ptli, aktualny drut pasuje
-                        }
-                    }
-                    if (--n <= 0) // co za dugo to szukanie trwa
-                        p->hvPowerWire = NULL;
+            c = ContactAdd();
+            c->dyn = model;
+            c->pant = p;
+            c->vFront = vFront;
+            c->vUp = vUp;
+            c->vLeft = vLeft;
+            c->vPos = dwys + (vLeft * p->vPos.z) + (vUp * p->vPos.y) + (vFront * p->vPos.x);
+        }
+        else
+            p->hvPowerWire = NULL; // pantograf opuszczony
+    }
+};
+
+void TGround::PantContacts(int first, int count)
+{ // ledzenie drutw znanych z poprzedniego przebiegu, krokami po przsach dla wszystkich
+    // pantografw naraz; w kadym kroku dane przse s najpierw kopiowane do cigej tablicy, a
+    // potem przeliczane jedn ptl bez sigania do rozrzuconych w pamici obiektw przse
+    int pending = 0, i, k;
+    TPantContact *c;
+    TAnimPant *p;
+    vector3 vGdzie; // wektor pooenia drutu wzgldem pantografu
+    for (i = first; i < first + count; ++i)
+        if (pContacts[i].pant->hvPowerWire)
+            pPending[pending++] = i;
+    for (int n = 30; pending && (n > 0); --n) // eby si nie zaptlio
+    {
+        for (k = 0; k < pending; ++k)
+        { // zebranie biecych przse
+            c = pContacts + pPending[k];
+            c->vPoint = c->pant->hvPowerWire->pPoint1;
+            c->vParam = c->pant->hvPowerWire->vParametric;
+        }
+        for (k = 0; k < pending; ++k)
+        { // podstawienie rwnania parametrycznego drutu do rwnania paszczyzny pantografu
+            c = pContacts + pPending[k];
+            c->fParam = -DotProduct(c->vPoint - c->vPos, c->vFront) /
+                        DotProduct(c->vParam, c->vFront);
+        }
+        i = 0; // ilo stykw do dalszego przesuwania po przsach
+        for (k = 0; k < pending; ++k)
+        {
+            c = pContacts + pPending[k];
+            p = c->pant;
+            if (c->fParam < -0.001) // histereza rzdu 7cm na 70m typowego przsa daje 1 promil
+            {
+                p->hvPowerWire = p->hvPowerWire->hvNext[0];
+                if (p->hvPowerWire)
+                    pPending[i++] = pPending[k];
+            }
+            else if (c->fParam > 1.001)
+            {
+                p->hvPowerWire = p->hvPowerWire->hvNext[1];
+                if (p->hvPowerWire)
+                    pPending[i++] = pPending[k];
+            }
+            else if ((p->hvPowerWire->iLast & 3) || p->hvPowerWire->hvParallel)
+                p->hvPowerWire = NULL; // kocowe przsa i bienie wsplne - szukanie po caoci
+            else
+            { // wyznaczy odlego wzdu wektorw vUp i vLeft
+                vGdzie = c->vPoint + c->fParam * c->vParam - c->vPos;
+                if (fabs(DotProduct(vGdzie, c->vLeft)) > p->fWidth) // 0.635 dla AKP-1 AKP-4E
+                    p->hvPowerWire = NULL; // poza zakresem roboczym, nabienik obsuy szukanie
+                else
+                { // aktualny drut pasuje
+                    p->PantTraction = DotProduct(vGdzie, c->vUp);
+                    p->fWireParam = c->fParam; // do rozdziau prdu na koce przsa
                 }
             }
-            if (!p->hvPowerWire) // else nie, bo mg zosta wyrzucony
-            { // poszukiwanie po okolicznych sektorach
-                int c = GetColFromX(dwys.x) + 1;
-                int r = GetRowFromZ(dwys.z) + 1;
-                TSubRect *tmp;
-                TGroundNode *node;
-                p->PantTraction = 5.0; // taka za dua warto
-                for (int j = r - 2; j <= r; j++)
-                    for (int i = c - 2; i <= c; i++)
-                    { // poszukiwanie po najbliszych sektorach niewiele da przy wikszym
-                        // zagszczeniu
-                        tmp = FastGetSubRect(i, j);
-                        if (tmp)
-                        { // dany sektor moe nie mie nic w rodku
-                            for (node = tmp->nRenderWires; node;
-                                 node = node->nNext3) // nastpny z grupy
-                                if (node->iType ==
-                                    TP_TRACTION) // w grupie tej s druty oraz inne linie
+        }
+        pending = i;
+    }
+    for (k = 0; k < pending; ++k)
+        pContacts[pPending[k]].pant->hvPowerWire = NULL; // co za dugo to szukanie trwa
+};
+
+void TGround::PantSearch(TPantContact *ct)
+{ // poszukiwanie drutu po okolicznych sektorach, gdy ledzenie po przsach nic nie dao
+    double fRaParam; // parametr rwnania parametrycznego odcinka drutu
+    double fVertical; // odlego w pionie; musi by w zasigu ruchu "pionowego" pantografu
+    double fHorizontal; // odlego w bok; powinna by mniejsza ni p szerokoci pantografu
+    vector3 vParam; // wspczynniki rwnania parametrycznego drutu
+    vector3 vStyk; // punkt przebicia drutu przez paszczyzn ruchu pantografu
+    vector3 vGdzie; // wektor pooenia drutu wzgldem pojazdu
+    TDynamicObject *model = ct->dyn;
+    TAnimPant *p = ct->pant;
+    vector3 pant0 = ct->vPos;
+    vector3 vFront = ct->vFront, vUp = ct->vUp, vLeft = ct->vLeft;
+    vector3 dwys = model->GetPosition(); // wsprzdne rodka pojazdu
+    int c = GetColFromX(dwys.x) + 1;
+    int r = GetRowFromZ(dwys.z) + 1;
+    TSubRect *tmp;
+    TGroundNode *node;
+    p->PantTraction = 5.0; // taka za dua warto
+    for (int j = r - 2; j <= r; j++)
+        for (int i = c - 2; i <= c; i++)
+        { // poszukiwanie po najbliszych sektorach niewiele da przy wikszym
+            // zagszczeniu
+            tmp = FastGetSubRect(i, j);
+            if (tmp)
+            { // dany sektor moe nie mie nic w rodku
+                for (node = tmp->nRenderWires; node;
+                     node = node->nNext3) // nastpny z grupy
+                    if (node->iType ==
+                        TP_TRACTION) // w grupie tej s druty oraz inne linie
+                    {
+                        vParam =
+                            node->hvTraction
+                                ->vParametric; // wspczynniki rwnania parametrycznego
+                        fRaParam = -DotProduct(pant0, vFront);
+                        fRaParam = -(DotProduct(node->hvTraction->pPoint1, vFront) +
+                                     fRaParam) /
+                                   DotProduct(vParam, vFront);
+                        if ((fRaParam >= -0.001) ? (fRaParam <= 1.001) : false)
+                        { // jeli tylko jest w przedziale, wyznaczy odlego wzdu
+                            // wektorw vUp i vLeft
+                            vStyk = node->hvTraction->pPoint1 +
+                                    fRaParam * vParam; // punkt styku paszczyzny z
+                            // drutem (dla generatora uku
+                            // el.)
+                            vGdzie = vStyk - pant0; // wektor
+                            fVertical = DotProduct(
+                                vGdzie,
+                                vUp); // musi si mieci w przedziale ruchu pantografu
+                            if (fVertical >= 0.0) // jeli ponad pantografem (bo moe
+                                // apa druty spod wiaduktu)
+                                if (Global::bEnableTraction ?
+                                        fVertical < p->PantWys - 0.15 :
+                                        false) // jeli drut jest niej ni 15cm pod
+                                // lizgiem
+                                { // przeczamy w tryb poamania, o ile jedzie;
+                                    // (bEnableTraction) aby dao si jedzi na
+                                    // kolawych
+                                    // sceneriach
+                                    fHorizontal = fabs(DotProduct(vGdzie, vLeft)) -
+                                                  p->fWidth; // i do tego jeszcze
+                                    // wejdzie pod lizg
+                                    if (fHorizontal <= 0.0) // 0.635 dla AKP-1 AKP-4E
+                                    {
+                                        p->PantWys =
+                                            -1.0; // ujemna liczba oznacza poamanie
+                                        p->hvPowerWire = NULL; // bo inaczej si zasila
+                                        // w nieskoczono z
+                                        // poamanego
+                                        // p->fHorizontal=fHorizontal; //zapamitanie
+                                        // pooenia drutu
+                                        if (model->MoverParameters->EnginePowerSource
+                                                .CollectorParameters.CollectorsNo >
+                                            0) // liczba pantografw
+                                            --model->MoverParameters->EnginePowerSource
+                                                  .CollectorParameters
+                                                  .CollectorsNo; // teraz bdzie
+                                        // mniejsza
+                                        if (DebugModeFlag)
+                                            ErrorLog(
+                                                "Pant. break: at " +
+                                                FloatToStrF(pant0.x, ffFixed, 7, 2) +
+                                                " " +
+                                                FloatToStrF(pant0.y, ffFixed, 7, 2) +
+                                                " " +
+                                                FloatToStrF(pant0.z, ffFixed, 7, 2));
+                                    }
+                                }
+                                else if (fVertical < p->PantTraction) // ale niej, ni
+                                // poprzednio
+                                // znaleziony
                                 {
-                                    vParam =
-                                        node->hvTraction
-                                            ->vParametric; // wspczynniki rwnania parametrycznego
-                                    fRaParam = -DotProduct(pant0, vFront);
-                                    fRaParam = -(DotProduct(node->hvTraction->pPoint1, vFront) +
-                                                 fRaParam) /
-                                               DotProduct(vParam, vFront);
-                                    if ((fRaParam >= -0.001) ? (fRaParam <= 1.001) : false)
-                                    { // jeli tylko jest w przedziale, wyznaczy odlego wzdu
-                                        // wektorw vUp i vLeft
-                                        vStyk = node->hvTraction->pPoint1 +
-                                                fRaParam * vParam; // punkt styku paszczyzny z
-                                        // drutem (dla generatora uku
-                                        // el.)
-                                        vGdzie = vStyk - pant0; // wektor
-                                        fVertical = DotProduct(
-                                            vGdzie,
-                                            vUp); // musi si mieci w przedziale ruchu pantografu
-                                        if (fVertical >= 0.0) // jeli ponad pantografem (bo moe
-                                            // apa druty spod wiaduktu)
-                                            if (Global::bEnableTraction ?
-                                                    fVertical < p->PantWys - 0.15 :
-                                                    false) // jeli drut jest niej ni 15cm pod
-                                            // lizgiem
-                                            { // przeczamy w tryb poamania, o ile jedzie;
-                                                // (bEnableTraction) aby dao si jedzi na
-                                                // kolawych
-                                                // sceneriach
-                                                fHorizontal = fabs(DotProduct(vGdzie, vLeft)) -
-                                                              p->fWidth; // i do tego jeszcze
-                                                // wejdzie pod lizg
-                                                if (fHorizontal <= 0.0) // 0.635 dla AKP-1 AKP-4E
-                                                {
-                                                    p->PantWys =
-                                                        -1.0; // ujemna liczba oznacza poamanie
-                                                    p->hvPowerWire = NULL; // bo inaczej si zasila
-                                                    // w nieskoczono z
-                                                    // poamanego
-                                                    // p->fHorizontal=fHorizontal; //zapamitanie
-                                                    // pooenia drutu
-                                                    if (model->MoverParameters->EnginePowerSource
-                                                            .CollectorParameters.CollectorsNo >
-                                                        0) // liczba pantografw
-                                                        --model->MoverParameters->EnginePowerSource
-                                                              .CollectorParameters
-                                                              .CollectorsNo; // teraz bdzie
-                                                    // mniejsza
-                                                    if (DebugModeFlag)
-                                                        ErrorLog(
-                                                            "Pant. break: at " +
-                                                            FloatToStrF(pant0.x, ffFixed, 7, 2) +
-                                                            " " +
-                                                            FloatToStrF(pant0.y, ffFixed, 7, 2) +
-                                                            " " +
-                                                            FloatToStrF(pant0.z, ffFixed, 7, 2));
-                                                }
-                                            }
-                                            else if (fVertical < p->PantTraction) // ale niej, ni
-                                            // poprzednio
-                                            // znaleziony
-                                            {
-                                                fHorizontal =
-                                                    fabs(DotProduct(vGdzie, vLeft)) - p->fWidth;
-                                                if (fHorizontal <= 0.0) // 0.635 dla AKP-1 AKP-4E
-                                                { // to si musi mieci w przedziale zaleznym od
-                                                    // szerokoci pantografu
-                                                    p->hvPowerWire =
-                                                        node->hvTraction; // jaki znaleziony
-                                                    p->PantTraction =
-                                                        fVertical; // zapamitanie nowej wysokoci
-                                                    // p->fHorizontal=fHorizontal; //zapamitanie
-                                                    // pooenia drutu
-                                                }
-                                                else if (fHorizontal <
-                                                         p->fWidthExtra) // czy zmieci si w
-                                                // zakresie nabienika?
-                                                { // problem jest, gdy nowy drut jest wyej, wtedy
-                                                    // pantograf odcza si od starego, a na
-                                                    // podniesienie do nowego potrzebuje czasu
-                                                    fVertical +=
-                                                        0.15 * fHorizontal /
-                                                        p->fWidthExtra; // korekta wysokoci o
-                                                    // nabienik - drut nad
-                                                    // nabienikiem jest
-                                                    // geometrycznie jakby nieco
-                                                    // wyej
-                                                    if (fVertical <
-                                                        p->PantTraction) // gdy po korekcie jest
-                                                    // niej, ni poprzednio
-                                                    // znaleziony
-                                                    { // gdyby to wystarczyo, to moemy go uzna
-                                                        p->hvPowerWire =
-                                                            node->hvTraction; // moe by
-                                                        p->PantTraction =
-                                                            fVertical; // na razie liniowo na
-                                                        // nabieniku, dokadno
-                                                        // poprawi si pniej
-                                                        // p->fHorizontal=fHorizontal;
-                                                        // //zapamitanie pooenia drutu
-                                                    }
-                                                }
-                                            }
-                                    } // warunek na parametr drutu <0;1>
-                                } // ptla po drutach
-                        } // sektor istnieje
-                    } // ptla po sektorach
-            } // koniec poszukiwania w sektorach
-            if (!p->hvPowerWire) // jeli drut nie znaleziony
-                if (!Global::bLiveTraction) // ale mona oszukiwa
-                    model->pants[k].fParamPants->PantTraction = 1.4; // to dajemy co tam dla picu
-        } // koniec obsugi podniesionego
-        else
-            p->hvPowerWire = NULL; // pantograf opuszczony
+                                    fHorizontal =
+                                        fabs(DotProduct(vGdzie, vLeft)) - p->fWidth;
+                                    if (fHorizontal <= 0.0) // 0.635 dla AKP-1 AKP-4E
+                                    { // to si musi mieci w przedziale zaleznym od
+                                        // szerokoci pantografu
+                                        p->hvPowerWire =
+                                            node->hvTraction; // jaki znaleziony
+                                        p->fWireParam = fRaParam;
+                                        p->PantTraction =
+                                            fVertical; // zapamitanie nowej wysokoci
+                                        // p->fHorizontal=fHorizontal; //zapamitanie
+                                        // pooenia drutu
+                                    }
+                                    else if (fHorizontal <
+                                             p->fWidthExtra) // czy zmieci si w
+                                    // zakresie nabienika?
+                                    { // problem jest, gdy nowy drut jest wyej, wtedy
+                                        // pantograf odcza si od starego, a na
+                                        // podniesienie do nowego potrzebuje czasu
+                                        fVertical +=
+                                            0.15 * fHorizontal /
+                                            p->fWidthExtra; // korekta wysokoci o
+                                        // nabienik - drut nad
+                                        // nabienikiem jest
+                                        // geometrycznie jakby nieco
+                                        // wyej
+                                        if (fVertical <
+                                            p->PantTraction) // gdy po korekcie jest
+                                        // niej, ni poprzednio
+                                        // znaleziony
+                                        { // gdyby to wystarczyo, to moemy go uzna
+                                            p->hvPowerWire =
+                                                node->hvTraction; // moe by
+                                            p->fWireParam = fRaParam;
+                                            p->PantTraction =
+                                                fVertical; // na razie liniowo na
+                                            // nabieniku, dokadno
+                                            // poprawi si pniej
+                                            // p->fHorizontal=fHorizontal;
+                                            // //zapamitanie pooenia drutu
+                                        }
+                                    }
+                                }
+                        } // warunek na parametr drutu <0;1>
+                    } // ptla po drutach
+            } // sektor istnieje
+        } // ptla po sektorach
+};
+
+void TGround::PantSearches(int first, int count)
+{ // szukanie po sektorach dla stykw, ktre zgubiy drut
+    TPantContact *c;
+    for (int i = first; i < first + count; ++i)
+    {
+        c = pContacts + i;
+        if (!c->pant->hvPowerWire) // else nie, bo mg zosta wyrzucony
+            PantSearch(c);
+        if (!c->pant->hvPowerWire) // jeli drut nie znaleziony
+            if (!Global::bLiveTraction) // ale mona oszukiwa
+                c->pant->PantTraction = 1.4; // to dajemy co tam dla picu
     }
-    // if (model->fWahaczeAmp<model->MoverParameters->DistCounter)
-    //{//nieuywana normalnie zmienna ogranicza powtrzone logowania
-    // model->fWahaczeAmp=model->MoverParameters->DistCounter;
-    // ErrorLog(FloatToStrF(1000.0*model->MoverParameters->DistCounter,ffFixed,7,3)+","+FloatToStrF(p->PantTraction,ffFixed,7,3)+","+FloatToStrF(p->fHorizontal,ffFixed,7,3)+","+FloatToStrF(p->PantWys,ffFixed,7,3)+","+AnsiString(p->hvPowerWire?1:0));
-    // //
-    // if (p->fHorizontal>1.0)
-    //{
-    // //Global::iPause|=1; //zapauzowanie symulacji
-    // Global::fTimeSpeed=1; //spowolnienie czasu do obejrzenia pantografu
-    // return true; //apacz
-    //}
-    //}
-    return true;
+};
+
+// Winger 170204 - szukanie trakcji nad pantografami
+void TGround::GetTractionAll()
+{ // aktualizacja drutw nad pantografami wszystkich aktywnych pojazdw w jednym przebiegu
+    iContacts = 0;
+    for (int i = 0; i < iActive; ++i)
+        if (pActive[i]->MoverParameters->EnginePowerSource.SourceType == CurrentCollector)
+            PantGather(pActive[i]);
+    PantContacts(0, iContacts);
+    PantSearches(0, iContacts);
+};
+
+void TGround::PantBenchmark()
+{ // pomiar ledzenia drutw dla 200 elektrycznych zespow po dwa pantografy, przesuwanych po
+    // 1m w 100 klatkach wzdu przse; wsplne przeliczenie porwnane z przeliczaniem po jednym
+    const int units = 200, frames = 100;
+    TGroundNode *n;
+    TTraction *t;
+    int i, k, spans = 0;
+    for (n = nRootOfType[TP_TRACTION]; n; n = n->nNext)
+        if (Length3(n->hvTraction->vParametric) > 20.0) // krtkie odcinki s raczej linami
+            ++spans;
+    if (!spans)
+        return;
+    TAnimPant *pants = new TAnimPant[units + units];
+    TTraction **start = new TTraction *[units + units];
+    TTraction **wire = new TTraction *[units + units];
+    vector3 *base = new vector3[units + units];
+    vector3 vUp = vector3(0, 1, 0);
+    TPantContact *c;
+    iContacts = 0;
+    i = k = 0;
+    for (n = nRootOfType[TP_TRACTION]; n && (iContacts < units + units); n = n->nNext)
+    { // przsa rozoone rwno po caej sieci
+        t = n->hvTraction;
+        if (Length3(t->vParametric) > 20.0)
+            if ((k++ * units) / spans >= i)
+            {
+                ++i;
+                for (int j = 0; j < 2; ++j)
+                { // drugi pantograf 10m za pierwszym
+                    c = ContactAdd();
+                    c->dyn = NULL;
+                    c->pant = pants + iContacts - 1;
+                    c->pant->AKP_4E();
+                    c->vFront = Normalize(vector3(t->vParametric.x, 0, t->vParametric.z));
+                    c->vUp = vUp;
+                    c->vLeft = CrossProduct(vUp, c->vFront);
+                    start[iContacts - 1] = t;
+                    base[iContacts - 1] = t->pPoint1 + 0.2 * t->vParametric - 5.0 * vUp -
+                                          (10.0 * j) * c->vFront;
+                }
+            }
+    }
+    int count = iContacts, lost[2] = {0, 0}, errors = 0;
+    LARGE_INTEGER t0[2], t1[2], f;
+    for (int run = 0; run < 2; ++run)
+    {
+        for (i = 0; i < count; ++i)
+            pants[i].hvPowerWire = start[i];
+        QueryPerformanceCounter(t0 + run);
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            for (i = 0; i < count; ++i)
+            {
+                c = pContacts + i;
+                c->vPos = base[i] + double(frame) * c->vFront;
+            }
+            if (run)
+                for (i = 0; i < count; ++i)
+                    PantContacts(i, 1); // tak jak dotychczas, pojazd po pojedzie
+            else
+                PantContacts(0, count);
+            for (i = 0; i < count; ++i)
+                if (!pants[i].hvPowerWire)
+                { // bez szukania po sektorach, zgubiony drut wraca na przso pocztkowe
+                    pants[i].hvPowerWire = start[i];
+                    ++lost[run];
+                }
+        }
+        QueryPerformanceCounter(t1 + run);
+        for (i = 0; i < count; ++i)
+            if (run ? wire[i] != pants[i].hvPowerWire : false)
+                ++errors; // oba sposoby musz skoczy na tych samych przsach
+            else
+                wire[i] = pants[i].hvPowerWire;
+    }
+    iContacts = 0;
+    delete[] pants;
+    delete[] start;
+    delete[] wire;
+    delete[] base;
+    if (lost[0] != lost[1])
+        ++errors;
+    QueryPerformanceFrequency(&f);
+    WriteLog("Pantograph contact: " + AnsiString(count) + " pantographs, " +
+             AnsiString(frames) + " frames, batched " +
+             FloatToStrF(1000.0 * double(t1[0].QuadPart - t0[0].QuadPart) / f.QuadPart, ffFixed, 7,
+                         3) +
+             " ms, single " +
+             FloatToStrF(1000.0 * double(t1[1].QuadPart - t0[1].QuadPart) / f.QuadPart, ffFixed, 7,
+                         3) +
+             " ms, lost " + AnsiString(lost[0]) + ", mismatches " + AnsiString(errors));
 };
 
 bool TGround::RenderDL(vector3 pPosition)
@@ -4950,6 +6336,40 @@ void TGround::WyslijObsadzone()
 	CommLog(AnsiString(Now()) + " " + IntToStr(r.iComm) + " obsadzone" + " sent");
 }
 
+//--------------------------------
+void TGround::WyslijZasilanie(const AnsiString &t)
+{ // wysanie stanu zasilacza oraz podsumowania telemetrii, ramka 15
+    TPowerStats s;
+    if (!PowerTelemetry::Stats(t, s))
+        return; // nie ma takiego zasilacza
+    DaneRozkaz r;
+    r.iSygn = 'EU07';
+    r.iComm = 15; // 15 - dane zasilacza
+    int i = 11, j = t.Length();
+    r.iPar[0] = i; // ilo danych liczbowych
+    r.fPar[1] = Global::fTimeAngleDeg / 360.0; // aktualny czas (1.0=doba)
+    r.fPar[2] = s.fCurrent; // prd wyjciowy
+    r.fPar[3] = s.fVoltage; // napicie wyjciowe
+    r.iPar[4] = s.iVehicles; // pojazdy na przsach zasilacza (tylko przy zbieraniu prbek)
+    r.iPar[5] = s.iFuse; // stan bezpiecznikw
+    r.iPar[6] = s.iTrips; // ilo zadziaa bezpiecznikw
+    r.fPar[7] = s.fCurrentMax; // najwikszy prd z prbek
+    r.fPar[8] = s.fCurrentAvg; // redni prd z prbek
+    r.fPar[9] = s.fVoltageMin; // najnisze napicie z prbek
+    r.iPar[10] = s.iSamples; // ilo prbek w buforze
+    i <<= 2; // ilo bajtw
+    if (j > int(sizeof(r.cString)) - i - 2)
+        j = int(sizeof(r.cString)) - i - 2; // nazwa przycita, eby zmieci licznik i zero
+    r.cString[i] = char(j); // na kocu nazwa, eby jako zidentyfikowa
+    memcpy(r.cString + i + 1, t.c_str(), j);
+    r.cString[i + 1 + j] = 0; // zakoczony zerem
+    COPYDATASTRUCT cData;
+    cData.dwData = 'EU07'; // sygnatura
+    cData.cbData = 10 + i + j; // 8+licznik i zero koczce
+    cData.lpData = &r;
+    Navigate("TEU07SRK", WM_COPYDATA, (WPARAM)Global::hWnd, (LPARAM)&cData);
+    CommLog(AnsiString(Now()) + " " + IntToStr(r.iComm) + " " + t + " sent");
+};
 //--------------------------------
 void TGround::WyslijParam(int nr, int fl)
 { // wysanie parametrw symulacji w ramce (nr) z flagami (fl)
@@ -201,6 +201,7 @@ class TSubRect : public Resource, public CMesh
     int iNodeCount; // licznik obiektw, do pomijania pustych sektorw
   public:
     void LoadNodes(); // utworzenie VBO sektora
+    int TracksFill(CVertNormTex *base, TWorkPool *pool, bool own); // siatki torw sektora
   public:
     TSubRect();
     virtual ~TSubRect();
@@ -289,11 +290,51 @@ class TGround
     int hh, mm, srh, srm, ssh, ssm; // ustawienia czasu
     // int tracks,tracksfar; //liczniki torw
     TNames *sTracks; // posortowane nazwy torw i eventw
+    TWorkPool *pPool; // wtki do liczenia fizyki, NULL gdy w jednym wtku
+    bool bPoolAll; // (pPool) utworzona przez PoolAll(), do usunicia w PoolFree()
+    TPowerNet *pPowerNet; // schemat zastpczy sieci trakcyjnej, NULL gdy liczona po staremu
+    TDynamicObject **pIslandList; // pojazdy w kolejnoci listy (nRootDynamic)
+    TDynamicObject **pIslandCars; // pojazdy pogrupowane wg niezalenych grup
+    int *pIslandParent; // robocza tablica czenia grup
+    int *pIslandNo; // numer grupy dla pojazdu z (pIslandList)
+    int *pIslandFirst; // pocztki grup w (pIslandCars), ostatni to koniec
+    int iIslandSize; // rozmiar tablic
+    int iIslands; // ilo grup w biecej klatce
+    int *pIslandAwake; // numery grup do przeliczenia (bez upionych)
+    int *pIslandDistant; // numery grup liczonych jako masy punktowe (daleko od kamery)
+    int iIslandsDistant; // ilo grup oddalonych
+    int iIslandsAwake; // ilo grup do przeliczenia
+    TDynamicObject **pActive; // pojazdy do przeliczenia w kolejnoci listy (bez upionych)
+    int iActive; // ilo pojazdw do przeliczenia
+    TConsist *pConsists; // obliczenia si na sprzgach dla grup z (pIslandCars)
+    __int64 iPhysicsTicks; // czas liczenia fizyki pojazdw od ostatniego urednienia
+    int iPhysicsSteps; // ilo krokw fizyki od ostatniego urednienia
+    double fIslandDt; // krok czasu dla grup
+    int iIslandIter; // ilo krokw dla grup
+    TPantContact *pContacts; // podniesione pantografy zebrane do przeliczenia styku z drutem
+    int *pPending; // numery stykw jeszcze przesuwanych po przsach
+    int iContacts; // ilo zebranych stykw
+    int iContactsSize; // rozmiar tablic stykw
   private: // metody prywatne
     bool EventConditon(TEvent *e);
+    void IslandsBuild();
+    void ActiveBuild(double dt);
+    bool IslandDistant(int k);
+    void DistantUpdate(double dt);
+    void ConsistForces();
+    void ConsistIntegrate(double dt);
+    void IslandsUpdate(double dt, int iter);
+    int EventFlatten(TEvent *e, bool b, TFlatAction *f, int &depth);
+    void FlatToQuery(TEvent *e, bool b);
+    TPantContact * ContactAdd();
+    void PantGather(TDynamicObject *model);
+    void PantContacts(int first, int count);
+    void PantSearch(TPantContact *ct);
+    void PantSearches(int first, int count);
 
   public:
     bool bDynamicRemove; // czy uruchomi procedur usuwania pojazdw
+    bool bDynamicRemoveLater; // usuwanie nie w Update(), tylko w DynamicRemoveDisabled()
     TDynamicObject *LastDyn; // ABu: paskudnie, ale na bardzo szybko moze jakos przejdzie...
     // TTrain *pTrain;
     // double fVDozwolona;
@@ -303,14 +344,31 @@ class TGround
     ~TGround();
     void Free();
     bool Init(AnsiString asFile, HDC hDC);
+    void PoolAll();
+    void PoolFree();
+    TWorkPool * Pool()
+    { // wtki s te uywane do tworzenia siatek sektorw
+        return pPool;
+    };
+    void MeshBenchmark();
+    TPowerNet * PowerNet()
+    {
+        return pPowerNet;
+    };
+    bool State();
     void FirstInit();
     void InitTracks();
     void InitTraction();
     bool InitEvents();
+    void FlattenEvents();
     bool InitLaunchers();
     TTrack * FindTrack(vector3 Point, int &iConnection, TGroundNode *Exclude);
     TTraction * FindTraction(vector3 *Point, int &iConnection, TGroundNode *Exclude);
     TTraction * TractionNearestFind(vector3 &p, int dir, TGroundNode *n);
+    void TractionAreas();
+    int TractionRepower(TTractionPowerSource *ps);
+    void TractionBenchmark();
+    void TractionTelemetry(double dt);
     // TGroundNode* CreateGroundNode();
     TGroundNode * AddGroundNode(cParser *parser);
     bool AddGroundNode(double x, double z, TGroundNode *Node)
@@ -330,14 +388,21 @@ class TGround
     bool AddDynamic(TGroundNode *Node);
     void MoveGroundNode(vector3 pPosition);
     void UpdatePhys(double dt, int iter); // aktualizacja fizyki staym krokiem
+    void IslandUpdate(int k); // kroki fizyki jednej grupy pojazdw (wywoywane z wtkw)
     bool Update(double dt, int iter); // aktualizacja przesuni zgodna z FPS
-    bool AddToQuery(TEvent *Event, TDynamicObject *Node);
-    bool GetTraction(TDynamicObject *model);
+    void SleepBenchmark();
+    void ConsistBenchmark();
+    void Snapshot(int k); // zapis pooe pojazdw przez wtek fizyki
+    void Interpolate(int k0, int k1, double a); // pooenia pojazdw do renderowania
+    bool AddToQuery(TEvent *Event, TDynamicObject *Node, double fWait = 0.0);
+    void GetTractionAll();
+    void PantBenchmark();
     bool RenderDL(vector3 pPosition);
     bool RenderAlphaDL(vector3 pPosition);
     bool RenderVBO(vector3 pPosition);
     bool RenderAlphaVBO(vector3 pPosition);
     bool CheckQuery();
+    bool EventProfileDump(); // zapis statystyki eventw
     //    GetRect(double x, double z) { return
     //    &(Rects[int(x/fSubRectSize+fHalfNumRects)][int(z/fSubRectSize+fHalfNumRects)]); };
     /*
@@ -394,6 +459,9 @@ class TGround
   public:
     void WyslijEvent(const AnsiString &e, const AnsiString &d);
     int iRendered; // ilo renderowanych sektorw, pobierana przy pokazywniu FPS
+    int iSleeping; // ilo upionych pojazdw, pobierana przy pokazywaniu FPS
+    int iDistant; // ilo pojazdw liczonych w uproszczeniu, pobierana przy pokazywaniu FPS
+    double fPhysicsTime; // redni czas kroku fizyki pojazdw [ms], pokazywany przy FPS
     void WyslijString(const AnsiString &t, int n);
     void WyslijWolny(const AnsiString &t);
     void WyslijNamiary(TGroundNode *t);
@@ -401,12 +469,14 @@ class TGround
 	void WyslijUszkodzenia(const AnsiString &t, char fl);
 	void WyslijPojazdy(int nr); // -> skladanie wielu pojazdow
 	void WyslijObsadzone(); // -> skladanie wielu pojazdow    
+    void WyslijZasilanie(const AnsiString &t);
 	void RadioStop(vector3 pPosition);
     TDynamicObject * DynamicNearest(vector3 pPosition, double distance = 20.0,
                                               bool mech = false);
     TDynamicObject * CouplerNearest(vector3 pPosition, double distance = 20.0,
                                               bool mech = false);
     void DynamicRemove(TDynamicObject *dyn);
+    void DynamicRemoveDisabled();
     void TerrainRead(const AnsiString &f);
     void TerrainWrite();
     void TrackBusyList();
@@ -14,6 +14,7 @@ http://mozilla.org/MPL/2.0/.
 #include "Machajka.h"
 #include "Timer.h"
 #include "Globals.h"
+#include "Console.h"
 
  TMachajka::TMachajka() : TTrain()
 {
@@ -32,7 +33,7 @@ bool TMachajka::Init(TDynamicObject *NewDynamicObject)
 
 void TMachajka::OnKeyPress(int cKey)
 {
-    if (!GetAsyncKeyState(VK_SHIFT) < 0) // bez shifta
+    if (!Console::Pressed(VK_SHIFT)) // bez shifta
     {
         if (cKey == Global::Keys[k_IncMainCtrl])
             (DynamicObject->MoverParameters->AddPulseForce(1));
@@ -25,6 +25,7 @@ http://mozilla.org/MPL/2.0/.
 
 #include "Usefull.h"
 #include "Globals.h"
+#include "SaveState.h"
 
 //---------------------------------------------------------------------------
 #pragma package(smart_init)
@@ -74,6 +75,23 @@ void TMemCell::UpdateValues(char *szNewText, double fNewValue1, double fNewValue
         CommandCheck(); // jeli zmieniony tekst, prbujemy rozpozna komend
 }
 
+void TMemCell::State()
+{ // zapis albo odtworzenie zawartoci komrki (TSaveState)
+    AnsiString text = szText;
+    bool command = bCommand;
+    TSaveState::Text(text);
+    TSaveState::Field(&fValue1, sizeof(fValue1));
+    TSaveState::Field(&fValue2, sizeof(fValue2));
+    TSaveState::Field(&command, sizeof(command));
+    if (TSaveState::Loading())
+    { // tekst przez UpdateValues(), aby rozpozna komend
+        if (text.Length() > 255)
+            text.SetLength(255); // bufor (szText) ma 256 znakw
+        UpdateValues(text.c_str(), fValue1, fValue2, update_memstring);
+        bCommand = command; // komenda moga by ju wysana
+    }
+};
+
 TCommandType TMemCell::CommandCheck()
 { // rozpoznanie komendy
     if (strcmp(szText, "SetVelocity") == 0) // najpopularniejsze
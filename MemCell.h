@@ -35,6 +35,7 @@ class TMemCell
     void PutCommand(TController *Mech, vector3 *Loc);
     bool Compare(char *szTestText, double fTestValue1, double fTestValue2, int CheckMask);
     bool Render();
+    void State();
     inline char * Text()
     {
         return szText;
@@ -8,6 +8,9 @@ http://mozilla.org/MPL/2.0/.
 */
 
 #include "Mover.h"
+#include "SaveState.h"
+#include "Logs.h"
+#include <stdlib.h>
 //---------------------------------------------------------------------------
 #pragma package(smart_init)
 // Ra: tu naley przenosi funcje z mover.pas, ktre nie s z niego wywoywane.
@@ -16,6 +19,61 @@ http://mozilla.org/MPL/2.0/.
 
 const dEpsilon = 0.01; // 1cm (zaley od typu sprzgu...)
 
+TFrictionTable *TFrictionTable::pTables[256];
+double TFrictionTable::fAdhesion[TFrictionTable::iAdhesion];
+double TFrictionTable::fAdhesionError = -1.0; // tablica przyczepnoci jeszcze nie wypeniona
+
+void TFrictionTable::Build(Hamulce::TBrake *b)
+{ // wypenienie tablicy z materiau ciernego hamulca (b) i sprawdzenie odchyki
+    int i, j;
+    double fc;
+    for (i = 0; i < iVel; ++i)
+        for (j = 0; j < iN; ++j)
+            fFC[i * iN + j] = b->GetFC(4.0 * i, 2.0 * j);
+    fError = 0.0;
+    for (i = 0; i < iVel - 1; ++i)
+        for (j = 0; j < iN - 1; ++j)
+        { // w rodku oczka bd interpolacji jest najwikszy
+            FC(4.0 * i + 2.0, 2.0 * j + 1.0, fc);
+            fc = fabs(fc - b->GetFC(4.0 * i + 2.0, 2.0 * j + 1.0));
+            if (fc > fError)
+                fError = fc;
+        }
+    bReported = false;
+    if (fAdhesionError < 0.0)
+    { // przyczepno nie zaley od pojazdu, wystarczy raz
+        for (i = 0; i < iAdhesion; ++i)
+            fAdhesion[i] = (100.0 + i) / (50.0 + i);
+        fAdhesionError = 0.0;
+        for (i = 0; i < iAdhesion - 1; ++i)
+        {
+            fc = fabs(0.5 * (fAdhesion[i] + fAdhesion[i + 1]) - (100.5 + i) / (50.5 + i));
+            if (fc > fAdhesionError)
+                fAdhesionError = fc;
+        }
+    }
+};
+
+TFrictionTable *TFrictionTable::Find(Hamulce::TBrake *b, int mat)
+{ // tablica dla materiau (mat), tworzona przy pierwszym pojedzie z tym materiaem
+    mat &= 255 - bp_MHS; // hamulec szynowy nie zmienia materiau, tak jak w TBrake.Create
+    if (!pTables[mat])
+    {
+        pTables[mat] = new TFrictionTable();
+        pTables[mat]->Build(b);
+    }
+    return pTables[mat];
+};
+
+void TFrictionTable::Free()
+{ // usunicie tablic, po usuniciu pojazdw, ktre na nie wskazuj
+    for (int i = 0; i < 256; ++i)
+    {
+        delete pTables[i];
+        pTables[i] = NULL;
+    }
+};
+
 TMoverParameters::TMoverParameters(double VelInitial, AnsiString TypeNameInit, AnsiString NameInit,
                                    int LoadInitial, AnsiString LoadTypeInitial, int Cab)
     : T_MoverParameters(VelInitial, TypeNameInit, NameInit, LoadInitial, LoadTypeInitial, Cab)
@@ -28,6 +86,10 @@ TMoverParameters::TMoverParameters(double VelInitial, AnsiString TypeNameInit, A
     bPantKurek3 = true; // domylnie zbiornik pantografu poczony jest ze zbiornikiem gwnym
     iProblem = 0; // pojazd w peni gotowy do ruchu
     iLights[0] = iLights[1] = 0; //wiata zgaszone
+    iCouplerSolved = 0; // siy na sprzgach liczone samodzielnie
+    iConsistNo = -1;
+    bPipeSolved = false;
+    pFriction = NULL; // tablice ustawia DynObj po wczytaniu FIZ
 };
 
 double TMoverParameters::Distance(const TLocation &Loc1, const TLocation &Loc2,
@@ -474,6 +536,375 @@ void TMoverParameters::UpdateBatteryVoltage(double dt)
 ZN //masa
 */
 
+double TMoverParameters::V2n()
+{ // przelicza prdko liniow na obrotow
+    const double dmgn = 0.5;
+    double n, deltan;
+    n = V / (M_PI * WheelDiameter); // prdko obrotowa wynikajca z liniowej [obr/s]
+    deltan = n - nrot; //"pochodna" prdkoci obrotowej
+    if (SlippingWheels)
+        if (fabs(deltan) < 0.01)
+            SlippingWheels = false; // wygaszenie polizgu
+    if (SlippingWheels) // nie ma zwizku z prdkoci liniow V
+    { // McZapkie-221103: uszkodzenia k podczas polizgu
+        if (deltan > dmgn)
+            if (FuzzyLogic(deltan, dmgn, p_slippdmg))
+                if (SetFlag(DamageFlag, dtrain_wheelwear)) // podkucie
+                    EventFlag = true;
+        if (deltan < -dmgn)
+            if (FuzzyLogic(-deltan, dmgn, p_slippdmg))
+                if (SetFlag(DamageFlag, dtrain_thinwheel)) // wycieranie si obrczy
+                    EventFlag = true;
+        n = nrot; // prdko obrotowa nie zaley od prdkoci liniowej
+    }
+    return n;
+};
+
+void TMoverParameters::ComputeTotalForce(double dt, double dt1, bool FullVer)
+{ // WANA FUNKCJA - oblicza si wypadkow
+    // Ra: przeniesione z mover.pas, aby siy na sprzgach mogy by policzone wczeniej dla
+    // caego skadu (TConsist), wtedy (iCouplerSolved) ma ustawione bity tych sprzgw
+    int b;
+    if (PhysicActivation)
+    {
+        // EventFlag=false; //jeli co si zego wydarzy to ustawiane na true
+        // SoundFlag=0; //jeli ma by jaki dwik to zapalany jest odpowiedni bit
+        // to powinno by zerowane na zewntrz
+        // juz zoptymalizowane:
+        FStand = FrictionForce(RunningShape.R, RunningTrack.DamageFlag); // sia oporw ruchu
+        Vel = fabs(V) * 3.6; // prdko w km/h
+        nrot = V2n(); // przeliczenie prdkoci liniowej na obrotow
+        if (TestFlag(BrakeMethod, bp_MHS) && (PipePress < 3.0) && (Vel > 45) &&
+            TestFlag(BrakeDelayFlag, bdelay_M)) // ustawione na sztywno na 3 bar
+            FStand += TrackBrakeForce; // doliczenie hamowania hamulcem szynowym
+        // w charakterystykach jest warto siy hamowania zamiast nacisku
+        LastSwitchingTime += dt1;
+        if (EngineType == ElectricSeriesMotor)
+            LastRelayTime += dt1;
+        if (Mains && (EngineType == ElectricSeriesMotor)) // potem ulepszy! pantografy!
+        { // Ra 2014-03: uwzgldnienie kierunku jazdy w napiciu na silnikach, a powinien by
+            // zdefiniowany nawrotnik
+            if (CabNo == 0)
+                Voltage = RunningTraction.TractionVoltage * ActiveDir;
+            else
+                Voltage = RunningTraction.TractionVoltage * DirAbsolute; // ActiveDir*CabNo;
+        } // bo nie dzialalo
+        else if ((EngineType == ElectricInductionMotor) ||
+                 ((Couplers[0].CouplingFlag & ctrain_power) == ctrain_power) ||
+                 ((Couplers[1].CouplingFlag & ctrain_power) == ctrain_power)) // potem ulepszy!
+            Voltage = Max0R(Max0R(RunningTraction.TractionVoltage, HVCouplers[0][1]),
+                            HVCouplers[1][1]);
+        else
+            Voltage = 0;
+        if (Power > 0)
+            FTrain = TractionForce(dt);
+        else
+            FTrain = 0;
+        Fb = BrakeForce(RunningTrack);
+        if (Max0R(fabs(FTrain), Fb) > TotalMassxg * Adhesive(RunningTrack.friction)) // polizg
+            SlippingWheels = true;
+        if (SlippingWheels)
+        {
+            // TrainForce:=TrainForce-Fb;
+            nrot = ComputeRotatingWheel((FTrain - Fb * Sign(V) - FStand) / NAxles -
+                                            Sign(nrot * M_PI * WheelDiameter - V) *
+                                                Adhesive(RunningTrack.friction) * TotalMass,
+                                        dt, nrot);
+            FTrain = Sign(FTrain) * TotalMassxg * Adhesive(RunningTrack.friction);
+            Fb = Min0R(Fb, TotalMassxg * Adhesive(RunningTrack.friction));
+        }
+        // else SlippingWheels:=false;
+        // FStand:=0;
+        for (b = 0; b < 2; ++b)
+            if (Couplers[b].Connected) // and (Couplers[b].CouplerType<>Bare) and
+            // (Couplers[b].CouplerType<>Articulated)
+            { // doliczenie si z innych pojazdw
+                if ((iCouplerSolved & (1 << b)) == 0) // jeli nie policzone dla skadu
+                    Couplers[b].CForce = CouplerForce(b, dt);
+                FTrain += Couplers[b].CForce;
+            }
+            else
+                Couplers[b].CForce = 0;
+        // FStand:=Fb+FrictionForce(RunningShape.R,RunningTrack.DamageFlag);
+        FStand += Fb;
+        FTrain += TotalMassxg * RunningShape.dHtrack; // doliczenie skadowej stycznej grawitacji
+        //!niejawne przypisanie zmiennej!
+        FTotal = FTrain - Sign(V) * FStand;
+    }
+    iCouplerSolved = 0; // w nastpnym kroku trzeba policzy od nowa
+    // McZapkie-031103: sprawdzanie czy warto liczy fizyk i inne updaty
+    // ABu 300105: co tu mieszaem, dziaa teraz troch lepiej, wic zostawiam
+    if ((CabNo == 0) && (Vel < 0.0001) && (fabs(AccS) < 0.0001) && (TrainType != dt_EZT))
+    {
+        if (!PhysicActivation)
+        {
+            if (Couplers[0].Connected)
+                if ((Couplers[0].Connected->Vel > 0.0001) ||
+                    (fabs(Couplers[0].Connected->AccS) > 0.0001))
+                    Physic_ReActivation();
+            if (Couplers[1].Connected)
+                if ((Couplers[1].Connected->Vel > 0.0001) ||
+                    (fabs(Couplers[1].Connected->AccS) > 0.0001))
+                    Physic_ReActivation();
+        }
+        if (LastSwitchingTime > 5) // 10+Random(100) then
+            PhysicActivation = false; // eby nie bra pod uwag braku V po uruchomieniu programu
+    }
+    else
+        PhysicActivation = true;
+};
+
+double TMoverParameters::Adhesive(double staticfriction)
+{ // przyczepno, z tablicy zamiast dzielenia, jeli s tablice
+    if (!pFriction || (Vel >= TFrictionTable::iAdhesion - 1))
+        return T_MoverParameters::Adhesive(staticfriction);
+    int i = int(Vel);
+    double x = Vel - i;
+    double a = (1.0 - x) * TFrictionTable::fAdhesion[i] + x * TFrictionTable::fAdhesion[i + 1];
+    double r = 11.0 - 2.0 * Random(); // losowo od 9 do 11, z tego samego cigu co mover.pas
+    if (!SlippingWheels)
+    {
+        if (SandDose)
+            return Max0R(staticfriction * a / 11.0, 0.048) * r;
+        else
+            return (staticfriction * a / 10.0) * r;
+    }
+    else
+    {
+        if (SandDose)
+            return (0.048) * r;
+        else
+            return (staticfriction * 0.02) * r;
+    }
+};
+
+double TMoverParameters::BrakeForce(const TTrackParam &Track)
+{ // sia hamowania, przeniesione z mover.pas, aby wspczynnik tarcia bra z tablicy
+    double K = 0, Fb, NBrakeAxles, fc;
+    if (!pFriction)
+        return T_MoverParameters::BrakeForce(Track);
+    if (NPoweredAxles > 0)
+        NBrakeAxles = NPoweredAxles;
+    else
+        NBrakeAxles = NAxles;
+    switch (LocalBrake)
+    {
+    case NoBrake:
+        K = 0;
+        break;
+    case ManualBrake:
+        K = MaxBrakeForce * ManualBrakeRatio();
+        break;
+    case HydraulicBrake:
+        K = MaxBrakeForce * LocalBrakeRatio();
+        break;
+    case PneumaticBrake:
+        if (Compressor < MaxBrakePress[3])
+            K = MaxBrakeForce * LocalBrakeRatio() / 2.0;
+        else
+            K = 0;
+        break;
+    }
+    if (MBrake)
+        K = MaxBrakeForce * ManualBrakeRatio();
+    u = ((BrakePress * P2FTrans) - BrakeCylSpring) * BrakeCylMult[0] - BrakeSlckAdj;
+    if (u * BrakeRigEff > Ntotal) // histereza na nacisku klockow
+        Ntotal = u * BrakeRigEff;
+    else
+    {
+        u = (BrakePress * P2FTrans) * BrakeCylMult[0] - BrakeSlckAdj;
+        if (u * (2 - 1 * BrakeRigEff) < Ntotal) // histereza na nacisku klockow
+            Ntotal = u * (2 - 1 * BrakeRigEff);
+    }
+    if (NBrakeAxles * NBpA > 0)
+    {
+        if (Ntotal > 0) // nie luz
+            K = K + Ntotal; // w kN
+        K = K * BrakeCylNo / (NBrakeAxles * NBpA); // w kN na os
+    }
+    if ((BrakeSystem == Pneumatic) || (BrakeSystem == ElectroPneumatic))
+    {
+        if (!pFriction->FC(Vel, K, fc))
+            fc = Hamulec->GetFC(Vel, K); // poza tablic ze wzoru
+        u = fc;
+        UnitBrakeForce = u * K * 1000; // sila na jeden klocek w N
+    }
+    else
+        UnitBrakeForce = K * 1000;
+    if ((NBpA * UnitBrakeForce > TotalMassxg * Adhesive(RunningTrack.friction) / NAxles) &&
+        (fabs(V) > 0.001))
+        SlippingWheels = true; // poslizg
+    Fb = UnitBrakeForce * NBrakeAxles * Max0R(1, NBpA);
+    return Fb;
+};
+
+double TMoverParameters::GetDVc(double dt)
+{ // przepywy w przewodzie gwnym do ssiednich pojazdw
+    T_MoverParameters *c;
+    double dv1 = 0, dv2 = 0;
+    // sprzeg 1
+    if (Couplers[0].Connected)
+        if (TestFlag(Couplers[0].CouplingFlag, ctrain_pneumatic))
+        { //*0.85
+            c = Couplers[0].Connected; // skrot //0.08 //e/D * L/D = e/D^2 * L
+            dv1 = 0.5 * dt * PF(PipePress, c->PipePress, (Spg) / (1 + 0.015 / Spg * Dim.L), 0.25);
+            if (dv1 * dv1 > 0.00000000000001)
+                c->Physic_ReActivation();
+            c->Pipe->Flow(-dv1);
+        }
+    // sprzeg 2
+    if (Couplers[1].Connected)
+        if (TestFlag(Couplers[1].CouplingFlag, ctrain_pneumatic))
+        {
+            c = Couplers[1].Connected; // skrot
+            dv2 = 0.5 * dt * PF(PipePress, c->PipePress, (Spg) / (1 + 0.015 / Spg * Dim.L), 0.25);
+            if (dv2 * dv2 > 0.00000000000001)
+                c->Physic_ReActivation();
+            c->Pipe->Flow(-dv2);
+        }
+    // w mover.pas by tu jeszcze przepyw pomidzy ssiadami, mnoony przez 0
+    return dv2 + dv1; // suma
+};
+
+void TMoverParameters::UpdatePipePressure(double dt)
+{ // przeniesione z mover.pas, aby przepywy pomidzy pojazdami mogy by policzone dla caego
+    // skadu (TConsist), wtedy (bPipeSolved) jest ustawione i GetDVc() jest pomijane
+    double temp;
+    int b;
+    PipePress = Pipe->P();
+    dpMainValve = 0;
+    if (BrakeCtrlPosNo > 1) //&&(ActiveCab!=0)
+    {
+        if (EngineType != ElectricInductionMotor)
+            dpLocalValve = LocHandle->GetPF(Max0R(LocalBrakePos / double(LocalBrakePosNo),
+                                                  LocalBrakePosA),
+                                            Hamulec->GetBCP(), ScndPipePress, dt, 0);
+        else
+            dpLocalValve =
+                LocHandle->GetPF(LocalBrakePosA, Hamulec->GetBCP(), ScndPipePress, dt, 0);
+        if ((BrakeHandle == FV4a) && ((PipePress < 2.75) && ((Hamulec->GetStatus() & b_rls) == 0)) &&
+            (BrakeSubsystem == ss_LSt) && (TrainType != dt_EZT))
+            temp = PipePress + 0.00001;
+        else
+            temp = ScndPipePress;
+        Handle->SetReductor(BrakeCtrlPos2);
+        if (BrakeOpModeFlag != bom_PS)
+            if ((BrakeOpModeFlag < bom_EP) || (Handle->GetPos(bh_EB) - 0.5 < BrakeCtrlPosR) ||
+                (BrakeHandle != MHZ_EN57))
+                dpMainValve = Handle->GetPF(BrakeCtrlPosR, PipePress, temp, dt, EqvtPipePress);
+            else
+                dpMainValve = Handle->GetPF(0, PipePress, temp, dt, EqvtPipePress);
+        if (dpMainValve < 0) //&&(PipePressureVal>0.01) //50
+            if (Compressor > ScndPipePress)
+            {
+                CompressedVolume = CompressedVolume + dpMainValve / 1500;
+                Pipe2->Flow(dpMainValve / 3);
+            }
+            else
+                Pipe2->Flow(dpMainValve);
+    }
+    if (EmergencyBrakeFlag || TestFlag(SecuritySystem.Status, s_SHPebrake) ||
+        TestFlag(SecuritySystem.Status, s_CAebrake) || s_CAtestebrake ||
+        TestFlag(EngDmgFlag, 32)) // ulepszony hamulec bezp.
+        dpMainValve = dpMainValve / 1 + PF(0, PipePress, 0.15, 0.25) * dt;
+    // 0.2*Spg
+    Pipe->Flow(-dpMainValve);
+    Pipe->Flow(-(PipePress)*0.001 * dt);
+    dpMainValve = dpMainValve / (Dim.L * Spg * 20);
+    CntrlPipePress = Hamulec->GetVRP(); // cinienie komory wstpnej rozdzielacza
+    switch (BrakeValve)
+    {
+    case W:
+        if (BrakeLocHandle != NoHandle)
+        {
+            LocBrakePress = LocHandle->GetCP();
+            ((TWest *)Hamulec)->SetLBP(LocBrakePress);
+        }
+        if (MBPM < 2)
+            ((TWest *)Hamulec)->PLC(MaxBrakePress[LoadFlag]);
+        else
+            ((TWest *)Hamulec)->PLC(TotalMass);
+        break;
+    case LSt:
+    case EStED:
+        LocBrakePress = LocHandle->GetCP();
+        for (b = 0; b < 2; ++b)
+            if (((TrainType & (dt_ET41 | dt_ET42)) > 0) && Couplers[b].Connected)
+                // nie podoba mi si to rozwizanie, chyba trzeba doda jaki wpis do fizyki na to
+                if (((Couplers[b].Connected->TrainType & (dt_ET41 | dt_ET42)) > 0) &&
+                    ((Couplers[b].CouplingFlag & 36) == 36))
+                    LocBrakePress = Max0R(Couplers[b].Connected->LocHandle->GetCP(), LocBrakePress);
+        ((TLSt *)Hamulec)->SetLBP(LocBrakePress);
+        if (BrakeValve == EStED)
+            if (MBPM < 2)
+                ((TEStED *)Hamulec)->PLC(MaxBrakePress[LoadFlag]);
+            else
+                ((TEStED *)Hamulec)->PLC(TotalMass);
+        break;
+    case CV1_L_TR:
+        LocBrakePress = LocHandle->GetCP();
+        ((TCV1L_TR *)Hamulec)->SetLBP(LocBrakePress);
+        break;
+    case EP2:
+        ((TEStEP2 *)Hamulec)->PLC(TotalMass);
+        break;
+    case ESt3AL2:
+    case NESt3:
+    case ESt4:
+    case ESt3:
+        if (MBPM < 2)
+            ((TNESt3 *)Hamulec)->PLC(MaxBrakePress[LoadFlag]);
+        else
+            ((TNESt3 *)Hamulec)->PLC(TotalMass);
+        LocBrakePress = LocHandle->GetCP();
+        ((TNESt3 *)Hamulec)->SetLBP(LocBrakePress);
+        break;
+    case KE:
+        LocBrakePress = LocHandle->GetCP();
+        ((TKE *)Hamulec)->SetLBP(LocBrakePress);
+        if (MBPM < 2)
+            ((TKE *)Hamulec)->PLC(MaxBrakePress[LoadFlag]);
+        else
+            ((TKE *)Hamulec)->PLC(TotalMass);
+        break;
+    }
+    if ((BrakeHandle == FVel6) && (ActiveCab != 0))
+    {
+        if (Battery && (ActiveDir != 0) && EpFuse) // tu powinien byc jeszcze bezpiecznik EP i baterie -
+            temp = ((TFVel6 *)Handle)->GetCP();
+        else
+            temp = 0;
+        Hamulec->SetEPS(temp);
+        SendCtrlToNext("Brake", temp, CabNo); // Ra 2014-11: na tym si wysypuje, ale nie wiem, w
+        // jakich warunkach
+    }
+    Pipe->Act();
+    PipePress = Pipe->P();
+    if ((BrakeStatus & 128) == 128) // jesli hamulec wyczony
+        temp = 0; // odetnij
+    else
+        temp = 1; // pocz
+    // zawr odpowiada na cinienie w przewodzie, przepywy do ssiadw mogy ju zosta
+    // doliczone przez TConsist::PipeSolve() przed ruchem pojazdw
+    Pipe->Flow(temp * Hamulec->GetPF(temp * PipePress, dt, Vel) + (bPipeSolved ? 0.0 : GetDVc(dt)));
+    bPipeSolved = false; // w nastpnym kroku trzeba policzy od nowa
+    if (ASBType == 128)
+        Hamulec->ASB(Byte(SlippingWheels));
+    dpPipe = 0;
+    // yB: jednokrokowe liczenie tego wszystkiego
+    Pipe->Act();
+    PipePress = Pipe->P();
+    dpMainValve = dpMainValve / (100 * dt); // normalizacja po czasie do syczenia;
+    if (PipePress < -1)
+    {
+        PipePress = -1;
+        Pipe->CreatePress(-1);
+        Pipe->Act();
+    }
+    if (CompressedVolume < 0)
+        CompressedVolume = 0;
+};
+
 double TMoverParameters::ComputeMovement(double dt, double dt1, const TTrackShape &Shape,
                                          TTrackParam &Track, TTractionParam &ElectricTraction,
                                          const TLocation &NewLoc, TRotation &NewRot)
@@ -598,6 +1029,75 @@ double TMoverParameters::FastComputeMovement(double dt, const TTrackShape &Shape
     return d;
 };
 
+void TMoverParameters::State()
+{ // zapis albo odtworzenie zmiennych fizyki pojazdu (TSaveState)
+    // zmienne s zebrane w tablice wg typu, kolejno wyznacza format pliku
+    double *d[] = {&DistCounter, &V, &Vel, &AccS, &AccN, &AccV, &nrot, &EnginePower, &dL, &Fb,
+                   &Ff, &FTrain, &FStand, &FTotal, &UnitBrakeForce, &Ntotal, &Sand,
+                   &BrakeSlippingTimer, &dpBrake, &dpPipe, &dpMainValve, &dpLocalValve,
+                   &ScndPipePress, &BrakePress, &LocBrakePress, &PipeBrakePress, &PipePress,
+                   &EqvtPipePress, &Volume, &CompressedVolume, &PantVolume, &Compressor,
+                   &BrakeCtrlPosR, &BrakeCtrlPos2, &LocalBrakePosA, &LimPipePress, &ActFlowSpeed,
+                   &LastSwitchingTime, &enrot, &Im, &Itot, &IHeating, &ITraction, &TotalCurrent,
+                   &Mm, &Mw, &Fw, &Ft, &Voltage, &LastRelayTime, &RventRot, &PantPress,
+                   &dizel_fill, &dizel_engagestate, &dizel_engage, &dizel_automaticgearstatus,
+                   &dizel_engagedeltaomega, &PulseForce, &PulseForceTimer, &eAngle,
+                   &LastLoadChangeTime, &PantFrontVolt, &PantRearVolt, &BatteryVoltage,
+                   &fBrakeCtrlPos};
+    int *i[] = {&BrakeCtrlPos, &ActiveDir, &CabNo, &DirAbsolute, &ActiveCab, &Imin, &Imax,
+                &PulseForceCount, &PantFrontStart, &PantRearStart, &iProblem, iLights,
+                iLights + 1};
+    Byte *b[] = {&SoundFlag, &LocalBrakePos, &ManualBrakePos, &BrakeStatus, &BrakeDelayFlag,
+                 &BrakeOpModeFlag, &DamageFlag, &EngDmgFlag, &DerailReason, &MainCtrlPos,
+                 &ScndCtrlPos, &LightsPos, &MainCtrlActualPos, &ScndCtrlActualPos, &LoadStatus,
+                 &WarningSignal};
+    bool *l[] = {&EventFlag, &SlippingWheels, &SandDose, &CompressorFlag, &PantCompFlag,
+                 &CompressorAllow, &ConverterFlag, &ConverterAllow, &EmergencyBrakeFlag,
+                 &DynamicBrakeFlag, &Mains, &DepartureSignal, &DelayCtrlFlag, &AutoRelayFlag,
+                 &FuseFlag, &ConvOvldFlag, &StLinFlag, &ResistorsFlag, &UnBrake,
+                 &dizel_enginestart, &DoorLeftOpened, &DoorRightOpened, &PantFrontUp,
+                 &PantRearUp, &PantFrontSP, &PantRearSP, &Heating, &PhysicActivation, &Battery,
+                 &EpFuse, &bPantKurek3};
+    int k;
+    for (k = 0; k < int(sizeof(d) / sizeof(d[0])); ++k)
+        TSaveState::Field(d[k], sizeof(double));
+    for (k = 0; k < int(sizeof(i) / sizeof(i[0])); ++k)
+        TSaveState::Field(i[k], sizeof(int));
+    for (k = 0; k < int(sizeof(b) / sizeof(b[0])); ++k)
+        TSaveState::Field(b[k], sizeof(Byte));
+    for (k = 0; k < int(sizeof(l) / sizeof(l[0])); ++k)
+        TSaveState::Field(l[k], sizeof(bool));
+    TSaveState::Field(eimv, sizeof(eimv));
+    TSaveState::Field(HVCouplers, sizeof(HVCouplers));
+    TSaveState::Field(&SecuritySystem, sizeof(SecuritySystem));
+    for (k = 0; k < 2; ++k)
+    { // sprzgi: rodzaj poczenia tylko wtedy, gdy ssiad jest ten sam co przy zapisie
+        AnsiString name = Couplers[k].Connected ? Couplers[k].Connected->Name : AnsiString("");
+        Byte flag = Couplers[k].CouplingFlag;
+        TSaveState::Text(name);
+        TSaveState::Field(&flag, sizeof(flag));
+        TSaveState::Field(&Couplers[k].CForce, sizeof(double));
+        TSaveState::Field(&Couplers[k].Dist, sizeof(double));
+        if (TSaveState::Loading() && (flag != Couplers[k].CouplingFlag))
+        {
+            if (Couplers[k].Connected ? Couplers[k].Connected->Name == name : false)
+                Couplers[k].CouplingFlag = flag;
+            else
+                WriteLog("State: " + Name + " coupler " + AnsiString(k) +
+                         " not restored, the neighbour is different");
+        }
+    }
+    if (TSaveState::Loading())
+    { // wewntrzny stan zaworw odtwarzany z cinie
+        if (Pipe)
+            Pipe->CreatePress(PipePress);
+        if (Pipe2)
+            Pipe2->CreatePress(ScndPipePress);
+        if (Hamulec)
+            Hamulec->Init(PipePress, HighPipePress, LowPipePress, BrakePress, BrakeDelayFlag);
+    }
+};
+
 double TMoverParameters::ShowEngineRotation(int VehN)
 { // pokazywanie obrotw silnika, rwnie dwch dalszych pojazdw (3SN61)
     int b;
@@ -20,6 +20,44 @@ http://mozilla.org/MPL/2.0/.
 #include "dumb3d.h"
 using namespace Math3D;
 
+class TFrictionTable
+{ // Ra: wspczynnik tarcia klockw (TBrake::GetFC()) prbkowany rwnomiernie w funkcji prdkoci
+    // i nacisku na o, wsplny dla pojazdw z tym samym materiaem ciernym; interpolacja liniowa
+    // zamiast liczenia exp() w kadym kroku dla kadego pojazdu
+  public:
+    enum
+    {
+        iVel = 81, // co 4km/h do 320km/h
+        iN = 129, // co 2kN do 256kN
+        iAdhesion = 401 // przyczepno co 1km/h do 400km/h
+    };
+    double fFC[iVel * iN]; // prbki wspczynnika tarcia, kolejno dla prdkoci
+    double fError; // najwiksza odchyka od wzoru, sprawdzana w rodkach oczek
+    bool bReported; // czy odchyka zostaa ju zapisana do logu
+    static double fAdhesion[iAdhesion]; // (100+V)/(50+V) z przyczepnoci
+    static double fAdhesionError;
+
+  private:
+    static TFrictionTable *pTables[256]; // tablice wg materiau ciernego
+    void Build(Hamulce::TBrake *b);
+
+  public:
+    static TFrictionTable *Find(Hamulce::TBrake *b, int mat);
+    static void Free();
+    bool FC(double vel, double n, double &fc) const
+    { // wspczynnik tarcia; false, gdy poza zakresem tablicy
+        if ((vel < 0.0) || (n < 0.0) || (vel >= 4.0 * (iVel - 1)) || (n >= 2.0 * (iN - 1)))
+            return false;
+        double x = 0.25 * vel, y = 0.5 * n;
+        int i = int(x), j = int(y);
+        x -= i;
+        y -= j;
+        const double *f = fFC + i * iN + j;
+        fc = (1.0 - x) * ((1.0 - y) * f[0] + y * f[1]) + x * ((1.0 - y) * f[iN] + y * f[iN + 1]);
+        return true;
+    };
+};
+
 enum TProblem // lista problemw taboru, ktre uniemoliwiaj jazd
 { // flagi bitowe
     pr_Hamuje = 1, // pojazd ma zaczony hamulec lub zatarte osie
@@ -39,8 +77,13 @@ class TMoverParameters : public T_MoverParameters
     // ma sprark
     int iProblem; // flagi problemw z taborem, aby AI nie musiao porwnywa; 0=moe jecha
     int iLights[2]; // bity zapalonych wiate tutaj, eby dao si liczy pobr prdu
+    int iCouplerSolved; // bity sprzgw, ktrych siy zostay policzone dla caego skadu (TConsist)
+    int iConsistNo; // numer pojazdu w tablicach TConsist, -1 gdy nie jest tam liczony
+    bool bPipeSolved; // przepywy w przewodzie gwnym do ssiadw policzone dla skadu (TConsist)
+    TFrictionTable *pFriction; // tablice tarcia i przyczepnoci, NULL - liczone ze wzorw
   private:
     double CouplerDist(Byte Coupler);
+    double V2n();
 
   public:
     TMoverParameters(double VelInitial, AnsiString TypeNameInit, AnsiString NameInit,
@@ -65,12 +108,14 @@ class TMoverParameters : public T_MoverParameters
     bool ChangeCab(int direction);
     bool CurrentSwitch(int direction);
     void UpdateBatteryVoltage(double dt);
+    void ComputeTotalForce(double dt, double dt1, bool FullVer);
     double ComputeMovement(double dt, double dt1, const TTrackShape &Shape, TTrackParam &Track,
                            TTractionParam &ElectricTraction, const TLocation &NewLoc,
                            TRotation &NewRot);
     double FastComputeMovement(double dt, const TTrackShape &Shape, TTrackParam &Track,
                                const TLocation &NewLoc, TRotation &NewRot);
     double ShowEngineRotation(int VehN);
+    void State();
     // double GetTrainsetVoltage(void);
     // bool Physic_ReActivation(void);
     // double LocalBrakeRatio(void);
@@ -112,18 +157,18 @@ class TMoverParameters : public T_MoverParameters
     // bool IncBrakeMult(void);
     // bool DecBrakeMult(void);
     // void UpdateBrakePressure(double dt);
-    // void UpdatePipePressure(double dt);
+    void UpdatePipePressure(double dt);
     // void CompressorCheck(double dt);
     void UpdatePantVolume(double dt);
     // void UpdateScndPipePressure(double dt);
     // void UpdateBatteryVoltage(double dt);
-    // double GetDVc(double dt);
+    double GetDVc(double dt);
     // void ComputeConstans(void);
     // double ComputeMass(void);
-    // double Adhesive(double staticfriction);
+    double Adhesive(double staticfriction);
     // double TractionForce(double dt);
     // double FrictionForce(double R, Byte TDamage);
-    // double BrakeForce(const TTrackParam &Track);
+    double BrakeForce(const TTrackParam &Track);
     // double CouplerForce(Byte CouplerN, double dt);
     // void CollisionDetect(Byte CouplerN, double dt);
     // double ComputeRotatingWheel(double WForce, double dt, double n);
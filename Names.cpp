@@ -21,7 +21,10 @@ Modu
 2. W przypadku przepenienia dostpnej pamici wystpi bd wczytywania.
 3. Obszar ten bdzie zuywany na rekordy obiektw oraz cigi tekstowe z nazwami.
 4. Rekordy bd sortowane w ramach typu (tekstury, dwiki, modele, node, eventy).
-5. Pierwszy etap wyszukiwania to 5 bitw z pierwszego bajtu i 3 z drugiego (256).
+5. Wyszukiwanie jest przez tablic mieszajc z adresowaniem otwartym, osobn dla
+   kadego typu. Nazwy s zamieniane na mae litery raz, przy dodawaniu; skrt jest
+   zapamitany w rekordzie i w tablicy, wic teksty porwnuje si tylko przy zgodnym
+   skrcie, a rozbudowa tablicy nie przelicza skrtw.
 6. Dla plikw istnieje moliwo wczytania ich w innym terminie.
 7. Moliwo wczytania plikw w oddzielnym watku (np. tekstur).
 
@@ -38,66 +41,54 @@ Obiekty sortowane wg nazw, mo
 
 */
 
-void ItemRecord::TreeAdd(ItemRecord *r, int c)
-{ // dodanie rekordu do drzewa - ustalenie w ktrej gazi
-    // zapisa w (iFlags) ile znakw jest zgodnych z nadrzdnym, eby nie sprawdza wszystkich od
-    // zera
-    if ((cName[c] && r->cName[c]) ? cName[c] == r->cName[c] : false)
-        TreeAdd(r, c + 1); // ustawi wg kolejnego znaku, chyba e zero
-    else if ((unsigned char)(cName[c]) < (unsigned char)(r->cName[c]))
-    { // zero jest najmniejsze - doczepiamy jako (rNext)
-        if (!rNext)
-            rNext = r;
-        else
-            rNext->TreeAdd(r, 0); // doczepi do tej gazi
-    }
-    else
-    {
-        if (!rPrev)
-            rPrev = r;
-        else
-            rPrev->TreeAdd(r, 0); // doczepi do tej gazi
-    }
+#include "Logs.h"
+
+const int iNameTableMin = 256; // pocztkowy rozmiar tablicy (potga 2)
+
+inline char NameFold(char c)
+{ // zamiana na mae litery (tylko ASCII, nazwy w sceneriach s bez polskich znakw)
+    return ((c >= 'A') && (c <= 'Z')) ? char(c + ('a' - 'A')) : c;
 };
 
-void ItemRecord::ListGet(ItemRecord *r, int *&n)
-{ // rekurencyjne wypenianie posortowanej listy na podstawie drzewa
-    if (rPrev)
-        rPrev->ListGet(r, n); // dodanie wszystkich wczeniejszych
-    *n++ = this - r; // dodanie swojego indeksu do tabeli
-    if (rNext)
-        rNext->ListGet(r, n); // dodanie wszystkich pniejszych
+TNameTable::TNameTable()
+{
+    pSlots = NULL;
+    iMask = -1;
+    iCount = 0;
 };
 
-void * ItemRecord::TreeFind(const char *n)
-{ // wyszukanie cigu (n)
-    ItemRecord *r = TreeFindRecord(n);
-    return r ? r->pData : NULL;
+TNameTable::~TNameTable()
+{
+    delete[] pSlots;
 };
 
-ItemRecord * ItemRecord::TreeFindRecord(const char *n)
-{ // wyszukanie cigu (n)
-    ItemRecord *r = this; //eby nie robi rekurencji
-    int i = 0;
-    do
-    {
-        if (!n[i])
-            if (!r->cName[i])
-                return r; // znaleziony
-        if (n[i] == r->cName[i])
-            ++i; // porwna kolejny znak
-        else if ((unsigned char)(n[i]) < (unsigned char)(r->cName[i]))
-        {
-            i = 0; // porwnywa od nowa
-            r = r->rPrev; // wczeniejsza ga drzewa
-        }
-        else
-        {
-            i = 0; // porwnywa od nowa
-            r = r->rNext; // pniejsza ga drzewa
-        }
-    } while (r);
-    return NULL;
+void TNameTable::Insert(unsigned int h, int r, ItemRecord *rRecords)
+{ // wstawienie numeru rekordu (r) o skrcie (h); duplikaty trafiaj za pierwotnym
+    if ((iCount + 1) * 10 > (iMask + 1) * 7) // wypenienie ponad 70% - powikszy
+        Grow(rRecords, r);
+    int i = h & iMask;
+    while (pSlots[i].iRecord >= 0)
+        i = (i + 1) & iMask; // prbkowanie liniowe
+    pSlots[i].iHash = h;
+    pSlots[i].iRecord = r;
+    ++iCount;
+};
+
+void TNameTable::Grow(ItemRecord *rRecords, int r)
+{ // podwojenie rozmiaru, przepisanie pozycji wg zapamitanych skrtw
+    int n = iMask + 1; // dotychczasowy rozmiar
+    int size = n ? n * 2 : iNameTableMin;
+    int t = rRecords[r].iFlags; // typ obsugiwany przez t tablic
+    delete[] pSlots;
+    pSlots = new TNameSlot[size];
+    for (int i = 0; i < size; ++i)
+        pSlots[i].iRecord = -1;
+    iMask = size - 1;
+    iCount = 0;
+    // przepisanie w kolejnoci numerw rekordw, eby duplikaty zachoway kolejno
+    for (int i = 0; i < r; ++i)
+        if (rRecords[i].iFlags == t)
+            Insert(rRecords[i].iHash, i, rRecords);
 };
 
 TNames::TNames()
@@ -108,24 +99,31 @@ TNames::TNames()
     rRecords = (ItemRecord *)cBuffer;
     cLast = cBuffer + iSize; // bajt za buforem
     iLast = -1;
-    ZeroMemory(rTypes, 20 * sizeof(ItemRecord *));
+};
+
+unsigned int TNames::Hash(const char *n, char *f)
+{ // FNV-1a z nazwy zamienionej na mae litery; jeli podano (f), to tam zapisa zamienion
+    unsigned int h = 2166136261u;
+    char c;
+    do
+    {
+        c = NameFold(*n++);
+        if (f)
+            *f++ = c;
+        h = (h ^ (unsigned char)c) * 16777619u;
+    } while (c);
+    return h;
 };
 
 int TNames::Add(int t, const char *n)
 { // dodanie obiektu typu (t) o nazwie (n)
     int len = strlen(n) + 1; // ze znacznikiem koca
     cLast -= len; // rezerwacja miejsca
-    memcpy(cLast, n, len); // przekopiowanie tekstu do bufora
-    // cLast[len-1]='\0';
-    rRecords[++iLast].cName = cLast; // poczenie nazwy z rekordem
+    ++iLast;
+    rRecords[iLast].iHash = Hash(n, cLast); // przekopiowanie tekstu do bufora maymi literami
+    rRecords[iLast].cName = cLast; // poczenie nazwy z rekordem
     rRecords[iLast].iFlags = t;
-    if (!rTypes[t])
-        rTypes[t] = rRecords + iLast; // korze drzewa, bo nie byo wczeniej
-    else
-        rTypes[t]->TreeAdd(rRecords + iLast, 0); // doczepienie jako ga
-    // rTypes[t]=Sort(t); //sortowanie uruchamia rcznie
-    if ((iLast & 0x3F) == 0) // nie za czsto, bo sortowania zajm wicej czasu ni wyszukiwania
-        Sort(t); // optymalizacja drzewa co jaki czas
+    tTypes[t].Insert(rRecords[iLast].iHash, iLast, rRecords);
     return iLast;
 }
 int TNames::Add(int t, const char *n, void *d)
@@ -139,7 +137,7 @@ bool TNames::Update(int t, const char *n, void *d)
 { // dodanie jeli nie ma, wymiana (d), gdy jest
     ItemRecord *r = FindRecord(t, n); // najpierw sprawdzi, czy ju jest
     if (r)
-    { // przy zdublowaniu nazwy podmienia w drzewku na pniejszy
+    { // przy zdublowaniu nazwy podmienia w tablicy na pniejszy
         r->pData = d;
         return true; // duplikat
     }
@@ -147,37 +145,63 @@ bool TNames::Update(int t, const char *n, void *d)
     return false; // zosta dodany nowy
 };
 
-ItemRecord * TNames::TreeSet(int *n, int d, int u)
-{ // rekurencyjne wypenianie drzewa pozycjami od (d) do (u)
-    if (d == u)
-    {
-        rRecords[n[d]].rPrev = rRecords[n[d]].rNext = NULL;
-        return rRecords + n[d]; // tej gazi nie ma
-    }
-    else if (d > u)
+ItemRecord * TNames::FindRecord(const int t, const char *n)
+{ // poszukiwanie rekordu w celu np. zmiany wskanika
+    TNameTable &tab = tTypes[t];
+    if (!tab.iCount)
         return NULL;
-    int p = (u + d) >> 1; // poowa
-    rRecords[n[p]].rPrev = TreeSet(n, d, p - 1); // zapisanie wczeniejszych gazi
-    rRecords[n[p]].rNext = TreeSet(n, p + 1, u); // zapisanie pniejszych gazi
-    return rRecords + n[p];
-};
-
-void TNames::Sort(int t)
-{ // przebudowa drzewa typu (t), zwraca wierzchoek drzewa
-    if (iLast < 3)
-        return; // jak jest mao, to nie ma sensu sortowa
-    if (rTypes[t]) // jeli jest jaki rekord danego typu
-    {
-        int *r = new int[iLast + 1]; // robocza tablica indeksw - numery posortowanych rekordw
-        int *q = r; // wskanik roboczy, przekazywany przez referencj
-        rTypes[t]->ListGet(rRecords, q); // drzewo jest ju posortowane - zamieni je na list
-        rTypes[t] = TreeSet(r, 0, (q - r) - 1);
-        delete[] r;
+    unsigned int h = Hash(n);
+    int i = h & tab.iMask;
+    while (tab.pSlots[i].iRecord >= 0)
+    { // pusta pozycja koczy szukanie
+        if (tab.pSlots[i].iHash == h)
+        { // tylko przy zgodnym skrcie porwnujemy tekst
+            const char *a = rRecords[tab.pSlots[i].iRecord].cName, *b = n;
+            while (*a && (*a == NameFold(*b)))
+                ++a, ++b;
+            if (!*a && !*b)
+                return rRecords + tab.pSlots[i].iRecord;
+        }
+        i = (i + 1) & tab.iMask;
     }
-    return;
+    return NULL;
 };
 
-ItemRecord * TNames::FindRecord(const int t, const char *n)
-{ // poszukiwanie rekordu w celu np. zmiany wskanika
-    return rTypes[t] ? rTypes[t]->TreeFindRecord(n) : NULL;
+void TNames::LogStats()
+{ // czas budowania tablic i wyszukania wszystkich nazw, rednie i maksymalne prbkowanie
+    LONGLONG fr, t0, t1, t2;
+    QueryPerformanceFrequency((LARGE_INTEGER *)&fr);
+    QueryPerformanceCounter((LARGE_INTEGER *)&t0);
+    TNameTable *test = new TNameTable[20]; // budowanie od zera na kopii
+    for (int i = 0; i <= iLast; ++i)
+        test[rRecords[i].iFlags].Insert(rRecords[i].iHash, i, rRecords);
+    QueryPerformanceCounter((LARGE_INTEGER *)&t1);
+    int found = 0;
+    for (int i = 0; i <= iLast; ++i)
+        if (FindRecord(rRecords[i].iFlags, rRecords[i].cName))
+            ++found;
+    QueryPerformanceCounter((LARGE_INTEGER *)&t2);
+    delete[] test;
+    WriteLog("Names: " + AnsiString(iLast + 1) + " records, build " +
+             FloatToStrF(1000.0 * double(t1 - t0) / double(fr), ffFixed, 7, 3) + "ms, lookup " +
+             FloatToStrF(1.0e9 * double(t2 - t1) / double(fr) / (iLast + 1 > 0 ? iLast + 1 : 1),
+                         ffFixed, 7, 1) +
+             "ns, found " + AnsiString(found));
+    for (int t = 0; t < 20; ++t)
+        if (tTypes[t].iCount)
+        { // dugoci prbkowania dla kadego typu
+            int sum = 0, max = 0;
+            for (int i = 0; i <= tTypes[t].iMask; ++i)
+                if (tTypes[t].pSlots[i].iRecord >= 0)
+                {
+                    int d = (i - int(tTypes[t].pSlots[i].iHash & tTypes[t].iMask)) & tTypes[t].iMask;
+                    sum += d;
+                    if (d > max)
+                        max = d;
+                }
+            WriteLog("Names type " + AnsiString(t) + ": " + AnsiString(tTypes[t].iCount) + "/" +
+                     AnsiString(tTypes[t].iMask + 1) + " slots, probe avg " +
+                     FloatToStrF(double(sum) / tTypes[t].iCount, ffFixed, 7, 2) + " max " +
+                     AnsiString(max));
+        }
 };
@@ -14,9 +14,9 @@ class ItemRecord
 { // rekord opisujcy obiekt; raz utworzony nie przemieszcza si
     // rozmiar rekordu mona zmieni w razie potrzeby
   public:
-    char *cName; // wskanik do nazwy umieszczonej w buforze
+    char *cName; // wskanik do nazwy umieszczonej w buforze (ju maymi literami)
     int iFlags; // flagi bitowe
-    ItemRecord *rPrev, *rNext; // posortowane drzewo (przebudowywane w razie potrzeby)
+    unsigned int iHash; // skrt nazwy, eby nie porwnywa tekstw przy rozbudowie tablicy
     union
     {
         void *pData; // wskanik do obiektu
@@ -24,8 +24,6 @@ class ItemRecord
         unsigned int uData;
     };
     // typedef
-    void ListGet(ItemRecord *r, int *&n);
-    void TreeAdd(ItemRecord *r, int c);
     template <typename TOut> inline TOut *DataGet()
     {
         return (TOut *)pData;
@@ -34,8 +32,24 @@ class ItemRecord
     {
         pData = (void *)x;
     };
-    void * TreeFind(const char *n);
-    ItemRecord * TreeFindRecord(const char *n);
+};
+
+struct TNameSlot
+{ // pozycja w tablicy mieszajcej: skrt i numer rekordu, 8 bajtw dla szybkiego przegldania
+    unsigned int iHash;
+    int iRecord; // -1 gdy pusta
+};
+
+class TNameTable
+{ // tablica mieszajca z adresowaniem otwartym (prbkowanie liniowe) dla jednego typu obiektw
+  public:
+    TNameSlot *pSlots; // tablica pozycji, rozmiar jest potg 2
+    int iMask; // rozmiar-1
+    int iCount; // ilo zajtych pozycji
+    TNameTable();
+    ~TNameTable();
+    void Insert(unsigned int h, int r, ItemRecord *rRecords);
+    void Grow(ItemRecord *rRecords, int r);
 };
 
 class TNames
@@ -45,7 +59,7 @@ class TNames
     char *cBuffer; // bufor dla rekordw (na pocztku) i nazw (na kocu)
     ItemRecord *rRecords; // rekordy na pocztku bufora
     char *cLast; // ostatni uyty bajt na nazwy
-    ItemRecord *rTypes[20]; // rone typy obiektw (pocztek drzewa)
+    TNameTable tTypes[20]; // rne typy obiektw (osobne tablice)
     int iLast; // ostatnio uyty rekord
   public:
     TNames();
@@ -53,16 +67,13 @@ class TNames
     int Add(int t, const char *n, void *d); // dodanie obiektu z wskanikiem
     int Add(int t, const char *n, int d); // dodanie obiektu z numerem
     bool Update(int t, const char *n, void *d); // dodanie jeli nie ma, wymiana (d), gdy jest
-    void TreeSet();
-    ItemRecord * TreeSet(int *n, int d, int u);
-    void Sort(int t); // przebudowa drzewa typu (t)
-    ItemRecord * Item(int n); // rekord o numerze (n)
+    static unsigned int Hash(const char *n, char *f = 0); // skrt z ewentualnym zapisaniem nazwy
     inline void *Find(const int t, const char *n)
     {
-        return rTypes[t] ? rTypes[t]->TreeFind(n) : NULL;
+        ItemRecord *r = FindRecord(t, n);
+        return r ? r->pData : 0;
     };
     ItemRecord * FindRecord(const int t, const char *n);
-    // template <typename TOut> inline TOut* Find(const int t,const char *n)
-    //{return (TOut*)(rTypes[t]->TreeFind(n));};
+    void LogStats(); // czas budowania i wyszukiwania oraz dugoci prbkowania (do testw)
 };
 #endif
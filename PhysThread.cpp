@@ -0,0 +1,151 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#include "system.hpp"
+#include "classes.hpp"
+#pragma hdrstop
+
+#include "PhysThread.h"
+#include "World.h"
+#include "Globals.h"
+#include "Logs.h"
+
+//---------------------------------------------------------------------------
+#pragma package(smart_init)
+/*
+Wtek fizyki liczy Ground.Update() staym krokiem, niezalenie od tego, jak dugo
+trwa renderowanie klatki (wczytywanie modeli, tekstur itp.). Po kadej porcji
+krokw zapisywana jest migawka pooe pojazdw (trzy bufory - fizyka pisze do
+trzeciego, gdy okno czyta dwa ostatnie), a okno rysuje pojazdy w pooeniu
+interpolowanym midzy dwiema ostatnimi migawkami.
+Klawisze dla kabiny s przekazywane przez kolejk bez blokowania i wykonywane
+przez wtek fizyki przed kolejnym krokiem.
+Zdarzenia i AI nie s przygotowane na wspbieno, dlatego stan scenerii jest
+chroniony sekcj krytyczn (csWorld). Fizyka trzyma j podczas porcji krokw, a okno
+tylko na czas zmian scenerii: obsugi klawiszy i polece, zegara, usuwania pojazdw,
+Train->Update() oraz ekranw tekstowych. Rysowanie i wczytywanie odbywa si bez niej,
+z pooe interpolowanych z migawek. Eventy dodawane przez wtek okna (np. wyzwalacze
+klawiszowe podczas rysowania) id t sam kolejk co klawisze i s dodawane przez
+fizyk przed krokiem. Pojazdy s usuwane przez wtek okna, a przejcie pojazdu na inny
+tor (zmiana Dynamics) chroni osobna sekcja (csTracks), ktr okno trzyma podczas
+rysowania scenerii. Okno nigdy nie trzyma obu sekcji naraz, a fizyka bierze je
+w kolejnoci csWorld, csTracks, wic nie ma zakleszczenia.
+*/
+
+CRITICAL_SECTION TPhysicsThread::csTracks;
+bool TPhysicsThread::bTracks = false;
+
+bool TCommandQueue::Push(const TPhysicsCommand &c)
+{ // dopisanie polecenia (tylko wtek okna)
+    long h = lHead;
+    if (h - lTail >= iSize)
+        return false; // kolejka pena, klawisz przepada
+    pItems[h & (iSize - 1)] = c;
+    InterlockedExchange(&lHead, h + 1); // udostpnienie dopiero po zapisaniu danych
+    return true;
+};
+
+bool TCommandQueue::Pop(TPhysicsCommand &c)
+{ // pobranie polecenia (tylko wtek fizyki)
+    long t = lTail;
+    if (t == lHead)
+        return false; // pusta
+    c = pItems[t & (iSize - 1)];
+    InterlockedExchange(&lTail, t + 1); // zwolnienie miejsca po odczytaniu
+    return true;
+};
+
+//---------------------------------------------------------------------------
+
+TPhysicsThread::TPhysicsThread(TWorld *w, double step)
+{
+    IsMultiThread = true; // meneder pamici Pascala musi blokowa
+    pWorld = w;
+    fStep = step;
+    bExit = false;
+    lSnapshot = -1; // jeszcze nie ma migawek
+    iSnapTime[0] = iSnapTime[1] = iSnapTime[2] = 0;
+    LARGE_INTEGER f;
+    QueryPerformanceFrequency(&f);
+    iFrequency = f.QuadPart;
+    InitializeCriticalSection(&csWorld);
+    InitializeCriticalSection(&csTracks);
+    bTracks = true;
+    hThread = CreateThread(NULL, 0, ThreadProc, this, 0, &dwThread);
+    WriteLog("Physics thread: step " + FloatToStrF(fStep, ffFixed, 7, 3) + "s");
+};
+
+TPhysicsThread::~TPhysicsThread()
+{ // wywoywa bez trzymania sekcji krytycznej
+    bExit = true;
+    WaitForSingleObject(hThread, 5000);
+    CloseHandle(hThread);
+    DeleteCriticalSection(&csWorld);
+    bTracks = false;
+    DeleteCriticalSection(&csTracks);
+};
+
+DWORD WINAPI TPhysicsThread::ThreadProc(LPVOID p)
+{
+    ((TPhysicsThread *)p)->Loop();
+    return 0;
+};
+
+void TPhysicsThread::Loop()
+{ // ptla wtku fizyki
+    LARGE_INTEGER t0, t1;
+    double buffer = 0.0; //[s] czas do przeliczenia
+    QueryPerformanceCounter(&t0);
+    while (!bExit)
+    {
+        QueryPerformanceCounter(&t1);
+        double dt = double(t1.QuadPart - t0.QuadPart) / double(iFrequency);
+        t0 = t1;
+        dt = Global::iPause ? 0.0 : dt * Global::fTimeSpeed;
+        if (dt > 1.0)
+            dt = 1.0; // po zatrzymaniu (np. debugger) nie nadrabia
+        buffer += dt;
+        int n = int(buffer / fStep); // ile penych krokw
+        if (n > 0)
+        {
+            buffer -= n * fStep;
+            if (n > 20)
+                n = 20; // jak w oknie: przy duym opnieniu reszta przepada
+            int k = (lSnapshot + 1) % 3; // bufor nieuywany przez okno
+            Lock();
+            pWorld->PhysicsStep(fStep, n, k);
+            Unlock();
+            QueryPerformanceCounter(&t1);
+            iSnapTime[k] = t1.QuadPart;
+            InterlockedExchange(&lSnapshot, k); // udostpnienie migawki
+        }
+        else
+            Sleep(1); // do nastpnego kroku jeszcze daleko
+    }
+};
+
+bool TPhysicsThread::Interpolation(int &k0, int &k1, double &alpha)
+{ // wybr migawek do rysowania oraz proporcji midzy nimi
+    k1 = lSnapshot;
+    if (k1 < 0)
+        return false;
+    k0 = (k1 + 2) % 3; // poprzednia
+    if (!iSnapTime[k0])
+        return false; // jest tylko jedna
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    __int64 span = iSnapTime[k1] - iSnapTime[k0];
+    alpha = span > 0 ? double(t.QuadPart - iSnapTime[k1]) / double(span) : 1.0;
+    if (alpha < 0.0)
+        alpha = 0.0;
+    else if (alpha > 1.0)
+        alpha = 1.0; // nie wybiega poza ostatni migawk
+    return true;
+};
+//---------------------------------------------------------------------------
@@ -0,0 +1,89 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef PhysThreadH
+#define PhysThreadH
+
+#include <system.hpp>
+#include "Classes.h"
+//---------------------------------------------------------------------------
+struct TPhysicsCommand
+{ // polecenie z wtku okna do wtku fizyki
+    int iKey; // kod klawisza
+    bool bDown; // true=nacinicie, false=zwolnienie
+    TEvent *evEvent; // event do dodania do kolejki zamiast klawisza
+    TDynamicObject *dynActivator; // pojazd wyzwalajcy event
+};
+
+class TCommandQueue
+{ // Ra: kolejka jeden pisze - jeden czyta, bez blokowania
+  private:
+    enum
+    {
+        iSize = 1024 // musi by potg 2
+    };
+    TPhysicsCommand pItems[iSize];
+    volatile long lHead; // nastpna pozycja do zapisu (zmienia tylko piszcy)
+    volatile long lTail; // nastpna pozycja do odczytu (zmienia tylko czytajcy)
+  public:
+    TCommandQueue()
+    {
+        lHead = lTail = 0;
+    };
+    bool Push(const TPhysicsCommand &c);
+    bool Pop(TPhysicsCommand &c);
+};
+
+class TPhysicsThread
+{ // Ra: wtek fizyki ze staym krokiem, niezaleny od FPS
+  private:
+    HANDLE hThread;
+    DWORD dwThread; // identyfikator wtku fizyki
+    CRITICAL_SECTION csWorld; // dostp do scenerii (fizyka albo okno)
+    static CRITICAL_SECTION csTracks; // listy pojazdw na torach (fizyka albo rysowanie)
+    static bool bTracks; // czy (csTracks) jest uywana, czyli czy wtek dziaa
+    volatile bool bExit; // zakoczenie wtku
+    double fStep; //[s] stay krok fizyki
+    TWorld *pWorld; // kto liczy
+    volatile long lSnapshot; // numer ostatniej zapisanej migawki
+    __int64 iSnapTime[3]; // czas QPC zapisania migawek
+    __int64 iFrequency; // czstotliwo QPC
+    static DWORD WINAPI ThreadProc(LPVOID p);
+    void Loop();
+
+  public:
+    TCommandQueue Commands; // klawisze dla kabiny i eventy z wtku okna
+    TPhysicsThread(TWorld *w, double step);
+    ~TPhysicsThread();
+    void Lock()
+    {
+        EnterCriticalSection(&csWorld);
+    };
+    void Unlock()
+    {
+        LeaveCriticalSection(&csWorld);
+    };
+    bool InThread()
+    {
+        return GetCurrentThreadId() == dwThread;
+    };
+    static void TracksLock()
+    {
+        if (bTracks)
+            EnterCriticalSection(&csTracks);
+    };
+    static void TracksUnlock()
+    {
+        if (bTracks)
+            LeaveCriticalSection(&csTracks);
+    };
+    bool Interpolation(int &k0, int &k1, double &alpha);
+};
+//---------------------------------------------------------------------------
+#endif
@@ -0,0 +1,662 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#include "system.hpp"
+#include "classes.hpp"
+#pragma hdrstop
+
+#include "PowerNet.h"
+#include "Traction.h"
+#include "TractionPower.h"
+#include "SaveState.h"
+#include "Logs.h"
+
+//---------------------------------------------------------------------------
+#pragma package(smart_init)
+/*
+Sie trakcyjna jako schemat zastpczy prdu staego.
+TTraction::VoltageGet() przyblia przso dwoma najbliszymi zasilaczami (przeliczenie trjkta
+na gwiazd z rezystancjami policzonymi przy wczytaniu), wic nie widzi spadkw napicia od
+innych pojazdw ani zasilania przez poczenia segmentw i bienie wsplne.
+Tutaj wzami s koce przse (wsplne dla poczonych drutw) oraz zasilacze. Przso jest
+przewodnoci pomidzy swoimi kocami, a zasilacz rdem prdowym U/Rw z przewodnoci 1/Rw do
+ziemi, poczonym kablem z oboma kocami zasilanego przsa. Poczenia segmentw naprania
+(TractionNearestFind) i bienie wsplne s zworami o maej rezystancji.
+Pojazdy nie zmieniaj macierzy: prd pantografu jest rozdzielany na koce przsa
+proporcjonalnie do pooenia lizgu, wic macierz jest rozkadana tylko po zadziaaniu albo
+powrocie bezpiecznika, a w kadym kroku fizyki jest tylko podstawienie w przd i wstecz.
+Numeracja odwrotna Cuthill-McKee daje dla linii kolejowych wsk obwiedni, wic rozkad
+i podstawienie s w praktyce liniowe wzgldem iloci przse.
+Prdy zgoszone w kroku s uywane w nastpnym, tak jak admitancja w TTractionPowerSource.
+Czci sieci, w ktrych wszystkie zasilacze maj wyczony bezpiecznik, maj napicie 0.
+Przsa sekcji odczonej eventem (bIsolated) nie przewodz: ich przewodnoci, kable i zwory
+s pomijane przy rozkadzie, wic sekcja nie czy ssiednich obszarw, a odcita przez ni
+cz bez czynnego zasilacza ma napicie 0. Zmiana odczenia sekcji te wymusza rozkad.
+Czci bez adnego zasilacza zostaj przy TTraction::VoltageGet() po staremu (napicie
+z przsa), wic ich przsa nie dostaj wskanika na sie.
+*/
+
+const double fCableRes = 0.001; //[om] kabel zasilajcy albo zwora
+const double fLeakage = 1e-8; //[S] upywno wza, eby macierz nie bya osobliwa
+const double fSpanResMin = 1e-6; //[om] najmniejsza rezystancja przsa
+
+int SetRoot(int *parent, int i)
+{ // korze zbioru z poowieniem cieki
+    while (parent[i] != i)
+        i = parent[i] = parent[parent[i]];
+    return i;
+};
+
+TPowerNet::TPowerNet()
+{
+    iSpans = iSources = iNodes = iEdges = iComps = iSections = 0;
+    pSpans = NULL;
+    pSources = pSections = NULL;
+    pEnds = pSourceNode = pEdgeA = pEdgeB = pEdgeSpan = pComp = pFirstCol = pRow = NULL;
+    pSpanRes = pEdgeG = pL = pD = pLoad = pVolt = NULL;
+    pSourceOn = pSectionOff = pNodeLive = NULL;
+    bFactored = false;
+};
+
+TPowerNet::~TPowerNet()
+{
+    Free();
+};
+
+void TPowerNet::Free()
+{ // przsa musz jeszcze istnie
+    for (int i = 0; i < iSpans; ++i)
+        if (pSpans[i]->pNet == this)
+        {
+            pSpans[i]->pNet = NULL;
+            pSpans[i]->iNet = -1;
+        }
+    delete[] pSpans;
+    delete[] pSources;
+    delete[] pEnds;
+    delete[] pSpanRes;
+    delete[] pSourceNode;
+    delete[] pSourceOn;
+    delete[] pSections;
+    delete[] pSectionOff;
+    delete[] pEdgeA;
+    delete[] pEdgeB;
+    delete[] pEdgeG;
+    delete[] pEdgeSpan;
+    delete[] pComp;
+    delete[] pNodeLive;
+    delete[] pFirstCol;
+    delete[] pRow;
+    delete[] pL;
+    delete[] pD;
+    delete[] pLoad;
+    delete[] pVolt;
+    iSpans = iSources = iNodes = iEdges = iComps = iSections = 0;
+    pSpans = NULL;
+    pSources = pSections = NULL;
+    pEnds = pSourceNode = pEdgeA = pEdgeB = pEdgeSpan = pComp = pFirstCol = pRow = NULL;
+    pSpanRes = pEdgeG = pL = pD = pLoad = pVolt = NULL;
+    pSourceOn = pSectionOff = pNodeLive = NULL;
+    bFactored = false;
+};
+
+void TPowerNet::EdgeAdd(int a, int b, double g, int i, int j)
+{ // przewodno (g) pomidzy wzami, naleca do przse (i) i (j), ptle s pomijane
+    if (a == b)
+        return;
+    pEdgeA[iEdges] = a;
+    pEdgeB[iEdges] = b;
+    pEdgeG[iEdges] = g;
+    pEdgeSpan[iEdges + iEdges] = i;
+    pEdgeSpan[iEdges + iEdges + 1] = j;
+    ++iEdges;
+};
+
+bool TPowerNet::Isolated(int span)
+{ // przso w sekcji odczonej eventem
+    TTractionPowerSource *ps = pSpans[span]->psSection;
+    return ps ? ps->bIsolated : false;
+};
+
+void TPowerNet::Jumper(int i, int j, int *raw, bool both)
+{ // zwora pomidzy najbliszymi kocami przse (i) i (j), (both) - od kadego koca (i)
+    TTraction *a = pSpans[i], *b = pSpans[j];
+    double d, best[2] = {1e20, 1e20};
+    int e, k, to[2] = {0, 0};
+    for (e = 0; e < 2; ++e)
+        for (k = 0; k < 2; ++k)
+        {
+            d = SquareMagnitude((e ? a->pPoint2 : a->pPoint1) - (k ? b->pPoint2 : b->pPoint1));
+            if (d < best[e])
+            {
+                best[e] = d;
+                to[e] = k;
+            }
+        }
+    if (both)
+    {
+        EdgeAdd(raw[i + i], raw[j + j + to[0]], 1.0 / fCableRes, i, j);
+        EdgeAdd(raw[i + i + 1], raw[j + j + to[1]], 1.0 / fCableRes, i, j);
+    }
+    else
+    {
+        e = (best[1] < best[0]) ? 1 : 0;
+        EdgeAdd(raw[i + i + e], raw[j + j + to[e]], 1.0 / fCableRes, i, j);
+    }
+};
+
+void TPowerNet::Build(TTraction **spans, int n)
+{ // utworzenie schematu zastpczego dla przse z ustalonymi ju poczeniami
+    Free();
+    if (n <= 0)
+        return;
+    int i, j, k, e, a, b, m;
+    TTraction *t;
+    TTractionPowerSource *ps;
+    iSpans = n;
+    pSpans = new TTraction *[n];
+    for (i = 0; i < n; ++i)
+    {
+        pSpans[i] = spans[i];
+        spans[i]->pNet = this;
+        spans[i]->iNet = i;
+    }
+    // poczone koce przse stanowi jeden wze
+    int *parent = new int[n + n];
+    for (i = 0; i < n + n; ++i)
+        parent[i] = i;
+    for (i = 0; i < n; ++i)
+        for (e = 0; e < 2; ++e)
+        {
+            t = pSpans[i]->hvNext[e];
+            if (t ? t->pNet == this : false)
+            {
+                a = SetRoot(parent, i + i + e);
+                b = SetRoot(parent, t->iNet + t->iNet + pSpans[i]->iNext[e]);
+                if (a != b)
+                    parent[a] = b;
+            }
+        }
+    int *raw = new int[n + n]; // numery wzw przed przenumerowaniem
+    for (i = 0; i < n + n; ++i)
+        raw[i] = -1;
+    m = 0;
+    for (i = 0; i < n + n; ++i)
+    {
+        a = SetRoot(parent, i);
+        if (raw[a] < 0)
+            raw[a] = m++;
+        raw[i] = raw[a];
+    }
+    delete[] parent;
+    // zasilacze, sekcje nie s rdami
+    pSources = new TTractionPowerSource *[n];
+    int *feed = new int[n]; // numer zasilacza przsa, -1 gdy nie jest zasilane bezporednio
+    for (i = 0; i < n; ++i)
+    {
+        feed[i] = -1;
+        ps = pSpans[i]->psPowered;
+        if (ps ? ps->bSection : true)
+            continue;
+        for (j = 0; j < iSources; ++j)
+            if (pSources[j] == ps)
+                break;
+        if (j == iSources)
+            pSources[iSources++] = ps;
+        feed[i] = j;
+    }
+    iNodes = m + iSources;
+    // sekcje przse, ich odczenie wycza przsa z macierzy
+    pSections = new TTractionPowerSource *[n];
+    for (i = 0; i < n; ++i)
+    {
+        ps = pSpans[i]->psSection;
+        if (!ps)
+            continue;
+        for (j = 0; j < iSections; ++j)
+            if (pSections[j] == ps)
+                break;
+        if (j == iSections)
+            pSections[iSections++] = ps;
+    }
+    pSectionOff = new bool[iSections + 1];
+    for (j = 0; j < iSections; ++j)
+        pSectionOff[j] = false;
+    // przewodnoci: przso, dwa kable zasilacza, dwie zwory bieni wsplnej, zwora segmentu
+    pEdgeA = new int[6 * n];
+    pEdgeB = new int[6 * n];
+    pEdgeG = new double[6 * n];
+    pEdgeSpan = new int[12 * n];
+    pSpanRes = new double[n];
+    for (i = 0; i < n; ++i)
+    {
+        t = pSpans[i];
+        pSpanRes[i] = t->fResistivity * Length3(t->vParametric);
+        if (pSpanRes[i] < fSpanResMin)
+            pSpanRes[i] = fSpanResMin;
+        EdgeAdd(raw[i + i], raw[i + i + 1], 1.0 / pSpanRes[i], i, i);
+        if (feed[i] >= 0)
+        {
+            EdgeAdd(m + feed[i], raw[i + i], 1.0 / fCableRes, i, i);
+            EdgeAdd(m + feed[i], raw[i + i + 1], 1.0 / fCableRes, i, i);
+        }
+        if (t->hvParallel ? t->hvParallel->pNet == this : false)
+            Jumper(i, t->hvParallel->iNet, raw, true); // piercie czy wszystkie
+        if (t->hvJoin ? t->hvJoin->pNet == this : false)
+            Jumper(i, t->hvJoin->iNet, raw, false);
+    }
+    delete[] feed;
+    // ssiedztwo wzw przed przenumerowaniem
+    int *first = new int[iNodes + 1];
+    int *pos = new int[iNodes];
+    int *adj = new int[iEdges + iEdges];
+    for (i = 0; i <= iNodes; ++i)
+        first[i] = 0;
+    for (k = 0; k < iEdges; ++k)
+    {
+        ++first[pEdgeA[k] + 1];
+        ++first[pEdgeB[k] + 1];
+    }
+    for (i = 0; i < iNodes; ++i)
+    {
+        first[i + 1] += first[i];
+        pos[i] = first[i];
+    }
+    for (k = 0; k < iEdges; ++k)
+    {
+        adj[pos[pEdgeA[k]]++] = pEdgeB[k];
+        adj[pos[pEdgeB[k]]++] = pEdgeA[k];
+    }
+    // numeracja Cuthill-McKee w kadej spjnej czci, start od wza najdalszego od pierwszego
+    int *order = new int[iNodes];
+    int *comp = new int[iNodes];
+    bool *placed = new bool[iNodes];
+    int head, tail = 0, s, v;
+    for (i = 0; i < iNodes; ++i)
+    {
+        comp[i] = -1;
+        placed[i] = false;
+    }
+    for (k = 0; k < iNodes; ++k)
+        if (comp[k] < 0)
+        {
+            s = tail; // pocztek czci w (order)
+            order[tail++] = k;
+            comp[k] = iComps;
+            for (head = s; head < tail; ++head)
+                for (j = first[order[head]]; j < first[order[head] + 1]; ++j)
+                    if (comp[adj[j]] < 0)
+                    {
+                        comp[adj[j]] = iComps;
+                        order[tail++] = adj[j];
+                    }
+            a = order[tail - 1]; // ostatni w przeszukiwaniu wszerz jest na brzegu czci
+            tail = s;
+            order[tail++] = a;
+            placed[a] = true;
+            for (head = s; head < tail; ++head)
+            {
+                b = tail; // dopisani ssiedzi s sortowani wg stopnia
+                for (j = first[order[head]]; j < first[order[head] + 1]; ++j)
+                    if (!placed[adj[j]])
+                    {
+                        placed[adj[j]] = true;
+                        order[tail++] = adj[j];
+                    }
+                for (i = b + 1; i < tail; ++i)
+                {
+                    v = order[i];
+                    e = first[v + 1] - first[v];
+                    for (j = i; (j > b) ? (first[order[j - 1] + 1] - first[order[j - 1]] > e) :
+                                          false;
+                         --j)
+                        order[j] = order[j - 1];
+                    order[j] = v;
+                }
+            }
+            ++iComps;
+        }
+    delete[] placed;
+    delete[] adj;
+    delete[] pos;
+    delete[] first;
+    int *inv = new int[iNodes]; // nowy numer wza, odwrotna kolejno
+    for (i = 0; i < iNodes; ++i)
+        inv[order[i]] = iNodes - 1 - i;
+    delete[] order;
+    pComp = new int[iNodes];
+    for (i = 0; i < iNodes; ++i)
+        pComp[inv[i]] = comp[i];
+    delete[] comp;
+    pEnds = new int[n + n];
+    for (i = 0; i < n + n; ++i)
+        pEnds[i] = inv[raw[i]];
+    delete[] raw;
+    pSourceNode = new int[iSources];
+    for (j = 0; j < iSources; ++j)
+        pSourceNode[j] = inv[m + j];
+    pFirstCol = new int[iNodes];
+    for (i = 0; i < iNodes; ++i)
+        pFirstCol[i] = i;
+    for (k = 0; k < iEdges; ++k)
+    {
+        a = pEdgeA[k] = inv[pEdgeA[k]];
+        b = pEdgeB[k] = inv[pEdgeB[k]];
+        if (a < b)
+        {
+            if (a < pFirstCol[b])
+                pFirstCol[b] = a;
+        }
+        else if (b < pFirstCol[a])
+            pFirstCol[a] = b;
+    }
+    delete[] inv;
+    pRow = new int[iNodes + 1];
+    pRow[0] = 0;
+    for (i = 0; i < iNodes; ++i)
+        pRow[i + 1] = pRow[i] + i - pFirstCol[i];
+    pL = new double[pRow[iNodes] + 1];
+    pD = new double[iNodes];
+    pLoad = new double[iNodes];
+    pVolt = new double[iNodes];
+    for (i = 0; i < iNodes; ++i)
+        pLoad[i] = pVolt[i] = 0.0;
+    pSourceOn = new bool[iSources + 1];
+    for (j = 0; j < iSources; ++j)
+        pSourceOn[j] = false;
+    pNodeLive = new bool[iNodes];
+    bool *fed = new bool[iComps + 1]; // czy cz ma jakikolwiek zasilacz
+    for (i = 0; i < iComps; ++i)
+        fed[i] = false;
+    for (j = 0; j < iSources; ++j)
+        fed[pComp[pSourceNode[j]]] = true;
+    for (i = 0; i < n; ++i)
+        if (!fed[pComp[pEnds[i + i]]])
+        { // bez zasilacza napicie liczy przso, jak przed wprowadzeniem sieci
+            pSpans[i]->pNet = NULL;
+            pSpans[i]->iNet = -1;
+        }
+    delete[] fed;
+    Solve(); // napicia bez obcienia, zanim pojazdy zaczn pobiera prd
+};
+
+void TPowerNet::Factor()
+{ // zoenie macierzy przewodnoci dla biecego stanu zasilaczy i sekcji oraz rozkad LDL^T
+    // w obwiedni; przy okazji ustalane s wzy poczone z czynnym zasilaczem
+    int i, j, k, lo;
+    double s, g, *ri, *rj;
+    int *part = new int[iNodes]; // czci sieci przy biecym odczeniu sekcji
+    for (k = 0; k < iSections; ++k)
+        pSectionOff[k] = pSections[k]->bIsolated;
+    for (i = 0; i < pRow[iNodes]; ++i)
+        pL[i] = 0.0;
+    for (i = 0; i < iNodes; ++i)
+    {
+        pD[i] = fLeakage;
+        part[i] = i;
+    }
+    for (k = 0; k < iEdges; ++k)
+    {
+        if (Isolated(pEdgeSpan[k + k]) || Isolated(pEdgeSpan[k + k + 1]))
+            continue; // przso odczonej sekcji nie przewodzi
+        i = pEdgeA[k];
+        j = pEdgeB[k];
+        g = pEdgeG[k];
+        pD[i] += g;
+        pD[j] += g;
+        if (i > j)
+            pL[pRow[i] + j - pFirstCol[i]] -= g;
+        else
+            pL[pRow[j] + i - pFirstCol[j]] -= g;
+        i = SetRoot(part, i);
+        j = SetRoot(part, j);
+        if (i != j)
+            part[i] = j;
+    }
+    for (i = 0; i < iNodes; ++i)
+        pNodeLive[i] = false;
+    for (k = 0; k < iSources; ++k)
+    {
+        pSourceOn[k] = !pSources[k]->Fused();
+        if (pSourceOn[k])
+        {
+            pD[pSourceNode[k]] += 1.0 / pSources[k]->Resistance();
+            pNodeLive[SetRoot(part, pSourceNode[k])] = true;
+        }
+    }
+    for (i = 0; i < iNodes; ++i)
+        pNodeLive[i] = pNodeLive[SetRoot(part, i)]; // korze ma ju ustalon warto
+    delete[] part;
+    for (i = 0; i < iNodes; ++i)
+    { // w wierszu (i) najpierw liczone s iloczyny L*D, a na kocu dzielone przez D
+        ri = pL + pRow[i] - pFirstCol[i]; // ri[j] to element (i,j)
+        for (j = pFirstCol[i]; j < i; ++j)
+        {
+            rj = pL + pRow[j] - pFirstCol[j];
+            lo = (pFirstCol[i] > pFirstCol[j]) ? pFirstCol[i] : pFirstCol[j];
+            s = ri[j];
+            for (k = lo; k < j; ++k)
+                s -= ri[k] * rj[k];
+            ri[j] = s;
+        }
+        s = pD[i];
+        for (k = pFirstCol[i]; k < i; ++k)
+        {
+            g = ri[k] / pD[k];
+            s -= ri[k] * g;
+            ri[k] = g;
+        }
+        pD[i] = s;
+    }
+    bFactored = true;
+};
+
+void TPowerNet::Substitute(double *x)
+{ // rozwizanie L*D*L^T*x=b w miejscu prawej strony
+    int i, k;
+    double s, *ri;
+    for (i = 0; i < iNodes; ++i)
+    {
+        ri = pL + pRow[i] - pFirstCol[i];
+        s = x[i];
+        for (k = pFirstCol[i]; k < i; ++k)
+            s -= ri[k] * x[k];
+        x[i] = s;
+    }
+    for (i = 0; i < iNodes; ++i)
+        x[i] /= pD[i];
+    for (i = iNodes - 1; i > 0; --i)
+    {
+        ri = pL + pRow[i] - pFirstCol[i];
+        s = x[i];
+        for (k = pFirstCol[i]; k < i; ++k)
+            x[k] -= ri[k] * s;
+    }
+};
+
+void TPowerNet::Solve()
+{ // raz na krok fizyki: prdy pantografw z poprzedniego kroku, napicia wzw i prdy zasilaczy
+    if (!iNodes)
+        return;
+    int k;
+    bool changed = !bFactored;
+    for (k = 0; k < iSources; ++k)
+        if (pSourceOn[k] == pSources[k]->Fused())
+            changed = true; // bezpiecznik zadziaa albo zosta zaczony
+    for (k = 0; k < iSections; ++k)
+        if (pSectionOff[k] != pSections[k]->bIsolated)
+            changed = true; // sekcja odczona albo zaczona eventem
+    if (changed)
+        Factor();
+    for (k = 0; k < iNodes; ++k)
+    {
+        pVolt[k] = pNodeLive[k] ? pLoad[k] : 0.0;
+        pLoad[k] = 0.0;
+    }
+    for (k = 0; k < iSources; ++k)
+        if (pSourceOn[k])
+            pVolt[pSourceNode[k]] += pSources[k]->VoltageNominal() / pSources[k]->Resistance();
+    Substitute(pVolt);
+    for (k = 0; k < iSources; ++k)
+        if (pSourceOn[k])
+            pSources[k]->CurrentSet((pSources[k]->VoltageNominal() - pVolt[pSourceNode[k]]) /
+                                        pSources[k]->Resistance(),
+                                    pVolt[pSourceNode[k]]);
+};
+
+double TPowerNet::Voltage(int span, double s, double i)
+{ // napicie w miejscu (s) przsa przy poborze prdu (i), ze spadkiem w samym przle
+    int a = pEnds[span + span], b = pEnds[span + span + 1];
+    if (!pNodeLive[a])
+        return 0.0;
+    return (1.0 - s) * pVolt[a] + s * pVolt[b] - s * (1.0 - s) * pSpanRes[span] * i;
+};
+
+double TPowerNet::VoltageGet(int span, double s, double i)
+{ // zgoszenie prdu (i) pantografu w miejscu (s) przsa i odczyt napicia
+    if (s < 0.0)
+        s = 0.0;
+    else if (s > 1.0)
+        s = 1.0;
+    pLoad[pEnds[span + span]] -= (1.0 - s) * i; // prd wypywa z sieci
+    pLoad[pEnds[span + span + 1]] -= s * i;
+    return Voltage(span, s, i);
+};
+
+void TPowerNet::State(TPowerNet *net)
+{ // zapis albo odtworzenie prdw zgoszonych w kroku i napi wzw (TSaveState), (net) moe
+    // by NULL; po odczycie macierz jest rozkadana od nowa, bo zasilacze mogy si zmieni
+    int i, n = net ? net->iNodes : 0;
+    TSaveState::Field(&n, sizeof(n));
+    if (TSaveState::Loading())
+    {
+        if ((n < 0) || (n > 4000000))
+        {
+            TSaveState::Fail(); // uszkodzony plik
+            return;
+        }
+        if (net)
+            net->bFactored = false;
+        if (n != (net ? net->iNodes : 0))
+        { // zapis z inn sieci (np. bez "powernet yes"), obcienie zacznie si od zera
+            double skip;
+            for (i = 0; i < n + n; ++i)
+                TSaveState::Field(&skip, sizeof(skip));
+            if (net)
+                for (i = 0; i < net->iNodes; ++i)
+                    net->pLoad[i] = net->pVolt[i] = 0.0;
+            return;
+        }
+    }
+    if (n)
+    {
+        TSaveState::Field(net->pLoad, n * sizeof(double));
+        TSaveState::Field(net->pVolt, n * sizeof(double));
+    }
+};
+
+void TPowerNet::Benchmark()
+{ // przypadki kontrolne, potem pomiar rozkadu i krokw ze 100 pocigami rozrzuconymi po sieci
+    Validate();
+    if (!iNodes)
+        return;
+    const int trains = 100;
+    const int steps = 100;
+    int i, k, span;
+    double s, cur, umin = 1e10;
+    double *x = new double[iNodes];
+    LARGE_INTEGER t0, t1, t2, f;
+    QueryPerformanceCounter(&t0);
+    Factor(); // stan zasilaczy bez zmian, wic rozkad jest taki sam
+    QueryPerformanceCounter(&t1);
+    for (k = 0; k < steps; ++k)
+    {
+        for (i = 0; i < iNodes; ++i)
+            x[i] = 0.0;
+        for (i = 0; i < iSources; ++i)
+            if (pSourceOn[i])
+                x[pSourceNode[i]] = pSources[i]->VoltageNominal() / pSources[i]->Resistance();
+        for (i = 0; i < trains; ++i)
+        { // pooenie i prd zmieniaj si w kolejnych krokach
+            span = int((__int64(i) * 7919 + __int64(k) * 104729) % iSpans);
+            if (!pNodeLive[pEnds[span + span]])
+                continue;
+            s = 0.01 * ((i * 37 + k) % 100);
+            cur = 500.0 + 10.0 * ((i + k) % 100);
+            x[pEnds[span + span]] -= (1.0 - s) * cur;
+            x[pEnds[span + span + 1]] -= s * cur;
+        }
+        Substitute(x);
+    }
+    QueryPerformanceCounter(&t2);
+    for (i = 0; i < iNodes; ++i)
+        if (pNodeLive[i] ? x[i] < umin : false)
+            umin = x[i];
+    delete[] x;
+    QueryPerformanceFrequency(&f);
+    WriteLog("Power net: " + AnsiString(iSpans) + " spans, " + AnsiString(iNodes) + " nodes, " +
+             AnsiString(iSources) + " sources, " + AnsiString(iComps) + " parts, envelope " +
+             AnsiString(pRow[iNodes]) + ", factor " +
+             FloatToStrF(1000.0 * double(t1.QuadPart - t0.QuadPart) / f.QuadPart, ffFixed, 7, 3) +
+             " ms, step with " + AnsiString(trains) + " trains " +
+             FloatToStrF(1000.0 * double(t2.QuadPart - t1.QuadPart) / (f.QuadPart * steps),
+                         ffFixed, 7, 3) +
+             " ms, lowest " + (umin < 1e10 ? FloatToStrF(umin, ffFixed, 7, 1) : AnsiString("-")) +
+             " V");
+};
+
+void TPowerNet::Validate()
+{ // porwnanie z rozwizaniem analitycznym: linia 10 przse po 50m zasilana z pocztku, potem
+    // z obu kocw; pojazd pobiera 1000A w 30% dugoci przsa nr 7
+    const int n = 10;
+    const double len = 50.0;
+    const double cur = 1000.0;
+    TTraction *t = new TTraction[n];
+    TTraction *spans[n];
+    int i;
+    for (i = 0; i < n; ++i)
+    {
+        t[i].pPoint1 = vector3(len * i, 6.0, 0.0);
+        t[i].pPoint2 = vector3(len * (i + 1), 6.0, 0.0);
+        t[i].fResistivity = 0.075 * 0.001; // domylna dla scenerii [om/m]
+        t[i].Init();
+        if (i)
+            t[i].Connect(0, t + i - 1, 1);
+        spans[i] = t + i;
+    }
+    TTractionPowerSource *ps1 = new TTractionPowerSource(NULL);
+    TTractionPowerSource *ps2 = new TTractionPowerSource(NULL);
+    ps1->Init(3300.0, 1e6);
+    ps2->Init(3300.0, 1e6);
+    double r = t[0].fResistivity * len; // rezystancja przsa
+    double rf = 1.0 / (1.0 / fCableRes + 1.0 / (fCableRes + r)); // kable do obu kocw
+    double ra = ps1->Resistance() + rf + 6.3 * r; // od pojazdu do zasilacza na pocztku
+    double rb = ps2->Resistance() + rf + 1.7 * r; // od pojazdu do zasilacza na kocu
+    TPowerNet *net = new TPowerNet();
+    t[0].PowerSet(ps1);
+    net->Build(spans, n);
+    double u0 = net->Voltage(7, 0.3, 0.0);
+    net->VoltageGet(7, 0.3, cur);
+    net->Solve();
+    double u1 = net->Voltage(7, 0.3, cur);
+    t[n - 1].PowerSet(ps2);
+    net->Build(spans, n);
+    net->VoltageGet(7, 0.3, cur);
+    net->Solve();
+    double u2 = net->Voltage(7, 0.3, cur);
+    WriteLog("Power net check: no load " + FloatToStrF(u0, ffFixed, 7, 2) + " V (3300.00), " +
+             "one feeder " + FloatToStrF(u1, ffFixed, 7, 2) + " V (" +
+             FloatToStrF(3300.0 - cur * ra, ffFixed, 7, 2) + "), two feeders " +
+             FloatToStrF(u2, ffFixed, 7, 2) + " V (" +
+             FloatToStrF(3300.0 - cur * ra * rb / (ra + rb), ffFixed, 7, 2) + ")");
+    delete net; // przed przsami
+    delete ps1;
+    delete ps2;
+    delete[] t;
+};
@@ -0,0 +1,68 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef PowerNetH
+#define PowerNetH
+
+#include <system.hpp>
+#include "Classes.h"
+//---------------------------------------------------------------------------
+class TTraction;
+class TTractionPowerSource;
+
+class TPowerNet
+{ // Ra: sie trakcyjna jako schemat zastpczy prdu staego, rozwizywany metod wzow
+    // macierz przewodnoci jest przechowywana w obwiedni (skyline) po numeracji odwrotnej
+    // Cuthill-McKee i rozkadana LDL^T tylko po zmianie stanu zasilaczy
+  private:
+    int iSpans; // ilo przse w sieci
+    int iSources; // ilo zasilaczy (wzy za kocami przse)
+    int iNodes; // ilo wzw razem z zasilaczami
+    int iEdges; // ilo przewodnoci pomidzy wzami
+    int iComps; // ilo spjnych czci sieci
+    int iSections; // ilo sekcji (psSection) przse sieci
+    TTraction **pSpans; // przsa w kolejnoci numeracji (iNet)
+    TTractionPowerSource **pSources; // zasilacze podczone do przse
+    int *pEnds; // numery wzw kocw przse, [2*iSpans]
+    double *pSpanRes; // rezystancja przsa [om]
+    int *pSourceNode; // numer wza zasilacza
+    bool *pSourceOn; // stan zasilaczy przy ostatnim rozkadzie macierzy
+    TTractionPowerSource **pSections; // sekcje, ktrych odczenie zmienia macierz
+    bool *pSectionOff; // odczenie sekcji (bIsolated) przy ostatnim rozkadzie macierzy
+    int *pEdgeA, *pEdgeB; // wzy poczone przewodnoci
+    double *pEdgeG; // przewodno [S]
+    int *pEdgeSpan; // przsa, do ktrych naley przewodno, [2*iEdges]
+    int *pComp; // numer spjnej czci dla wza
+    bool *pNodeLive; // czy wze jest poczony z czynnym zasilaczem (po rozkadzie)
+    int *pFirstCol; // pierwsza kolumna obwiedni w wierszu
+    int *pRow; // pocztki wierszy obwiedni, ostatni element to rozmiar
+    double *pL; // elementy pod przektn, po rozkadzie macierz L
+    double *pD; // przektna, po rozkadzie macierz D
+    double *pLoad; // prdy pantografw zgoszone w biecym kroku [A]
+    double *pVolt; // napicia wzw z ostatniego rozwizania [V]
+    bool bFactored; // czy rozkad jest aktualny
+    void EdgeAdd(int a, int b, double g, int i, int j);
+    bool Isolated(int span);
+    void Jumper(int i, int j, int *raw, bool both);
+    void Factor();
+    void Substitute(double *x);
+  public:
+    TPowerNet();
+    ~TPowerNet();
+    void Build(TTraction **spans, int n);
+    void Free();
+    void Solve();
+    double Voltage(int span, double s, double i);
+    double VoltageGet(int span, double s, double i);
+    void Benchmark();
+    static void State(TPowerNet *net);
+    static void Validate();
+};
+//---------------------------------------------------------------------------
+#endif
@@ -0,0 +1,178 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#include "system.hpp"
+#include "classes.hpp"
+#pragma hdrstop
+
+#include "PowerTelemetry.h"
+#include "TractionPower.h"
+#include "Ground.h"
+#include "Globals.h"
+#include "Logs.h"
+
+#include <fstream>
+
+//---------------------------------------------------------------------------
+#pragma package(smart_init)
+/*
+Telemetria zasilaczy sieci trakcyjnej dla autorw scenerii.
+Po wczeniu (powertelemetry <okres w sekundach>) co zadany okres zapisywany jest dla kadego
+zasilacza i sekcji: prd wyjciowy, napicie wyjciowe, stan bezpiecznikw, licznik ich zadziaa
+oraz ilo pojazdw z pantografem: dla sekcji na jej przsach, dla podstacji na przsach
+zasilanych przez ni bezporednio albo jako najblisza z ktrego koca. Bufor pamita ostatnie
+iSampleMax wierszy. Klawisze [Ctrl]+[F7] zapisuj go do powertelemetry.csv (od najstarszego
+wiersza), a ramka 15 z serwera zwraca stan i podsumowanie jednego zasilacza podanego nazw.
+*/
+
+const int iSampleMax = 3600; // ilo pamitanych wierszy (godzina przy prbce co sekund)
+
+TTractionPowerSource **PowerTelemetry::pSources = NULL;
+AnsiString *PowerTelemetry::asNames = NULL;
+int PowerTelemetry::iSources = 0;
+double *PowerTelemetry::pTimes = NULL;
+TPowerSample *PowerTelemetry::pSamples = NULL;
+int PowerTelemetry::iSamples = 0;
+double PowerTelemetry::fTime = 0.0;
+double PowerTelemetry::fElapsed = 0.0;
+
+void PowerTelemetry::Init(TGroundNode *root)
+{ // zapamitanie zasilaczy; lista jest potrzebna rwnie bez zbierania, do zapyta z serwera
+    Free();
+    TGroundNode *n;
+    for (n = root; n; n = n->nNext)
+        ++iSources;
+    if (!iSources)
+        return;
+    pSources = new TTractionPowerSource *[iSources];
+    asNames = new AnsiString[iSources];
+    iSources = 0;
+    for (n = root; n; n = n->nNext)
+    {
+        pSources[iSources] = n->psTractionPowerSource;
+        asNames[iSources++] = n->asName;
+    }
+    if (Global::fPowerTelemetry > 0.0)
+    {
+        pTimes = new double[iSampleMax];
+        pSamples = new TPowerSample[iSampleMax * iSources];
+        WriteLog("Power telemetry: " + AnsiString(iSources) + " sources every " +
+                 FloatToStrF(Global::fPowerTelemetry, ffFixed, 7, 2) + " s");
+    }
+};
+
+bool PowerTelemetry::Due(double dt)
+{ // odliczanie okresu prbkowania
+    if (!pSamples)
+        return false;
+    fTime += dt;
+    fElapsed += dt;
+    if (fElapsed < Global::fPowerTelemetry)
+        return false;
+    fElapsed -= Global::fPowerTelemetry;
+    if (fElapsed >= Global::fPowerTelemetry)
+        fElapsed = 0.0; // po dugiej przerwie (np. przewijanie) nie nadrabia prbek
+    return true;
+};
+
+void PowerTelemetry::Sample()
+{ // zapis wiersza prbek, ilo pojazdw jest ju policzona w zasilaczach
+    int row = iSamples++ % iSampleMax;
+    pTimes[row] = fTime;
+    TPowerSample *s = pSamples + row * iSources;
+    TTractionPowerSource *ps;
+    for (int k = 0; k < iSources; ++k, ++s)
+    {
+        ps = pSources[k];
+        s->fCurrent = ps->CurrentTotal();
+        s->fVoltage = ps->VoltageOutput();
+        s->iVehicles = ps->iVehicles;
+        s->iFuse = ps->FuseState();
+        s->iTrips = ps->iTrips;
+    }
+};
+
+bool PowerTelemetry::Stats(const AnsiString &name, TPowerStats &s)
+{ // stan zasilacza o podanej nazwie i podsumowanie jego prbek
+    int k;
+    for (k = 0; k < iSources; ++k)
+        if (asNames[k] == name)
+            break;
+    if (k >= iSources)
+        return false;
+    TTractionPowerSource *ps = pSources[k];
+    s.fCurrent = ps->CurrentTotal();
+    s.fVoltage = ps->VoltageOutput();
+    s.iVehicles = ps->iVehicles;
+    s.iFuse = ps->FuseState();
+    s.iTrips = ps->iTrips;
+    s.fCurrentMax = s.fCurrentAvg = s.fCurrent; // bez prbek zostaj wartoci biece
+    s.fVoltageMin = s.fVoltage;
+    s.iSamples = iSamples < iSampleMax ? iSamples : iSampleMax;
+    if (!s.iSamples)
+        return true;
+    double sum = 0.0;
+    TPowerSample *p;
+    for (int i = 0; i < s.iSamples; ++i)
+    {
+        p = pSamples + i * iSources + k;
+        sum += p->fCurrent;
+        if (!i || (p->fCurrent > s.fCurrentMax))
+            s.fCurrentMax = p->fCurrent;
+        if (!i || (p->fVoltage < s.fVoltageMin))
+            s.fVoltageMin = p->fVoltage;
+    }
+    s.fCurrentAvg = sum / s.iSamples;
+    return true;
+};
+
+bool PowerTelemetry::Dump()
+{ // zapis bufora od najstarszego wiersza
+    if (!pSamples)
+        return false;
+    std::ofstream csv("powertelemetry.csv");
+    if (!csv.is_open())
+    {
+        ErrorLog("Cannot write powertelemetry.csv");
+        return false;
+    }
+    csv << "time_s;source;current_A;voltage_V;vehicles;fast_fuse;slow_fuse;trips\n";
+    int n = iSamples < iSampleMax ? iSamples : iSampleMax; // ile jest w buforze
+    int row;
+    TPowerSample *s;
+    for (int i = 0; i < n; ++i)
+    {
+        row = (iSamples - n + i) % iSampleMax;
+        s = pSamples + row * iSources;
+        for (int k = 0; k < iSources; ++k, ++s)
+            csv << FloatToStrF(pTimes[row], ffFixed, 10, 2).c_str() << ";"
+                << asNames[k].c_str() << ";" << FloatToStrF(s->fCurrent, ffFixed, 10, 1).c_str()
+                << ";" << FloatToStrF(s->fVoltage, ffFixed, 10, 1).c_str() << ";"
+                << s->iVehicles << ";" << (s->iFuse & 1) << ";" << ((s->iFuse >> 1) & 1) << ";"
+                << s->iTrips << "\n";
+    }
+    csv.close();
+    WriteLog("Power telemetry: " + AnsiString(iSources) + " sources, " + AnsiString(n) +
+             " samples saved");
+    return true;
+};
+
+void PowerTelemetry::Free()
+{
+    delete[] pSources;
+    delete[] asNames;
+    delete[] pTimes;
+    delete[] pSamples;
+    pSources = NULL;
+    asNames = NULL;
+    pTimes = NULL;
+    pSamples = NULL;
+    iSources = iSamples = 0;
+    fTime = fElapsed = 0.0;
+};
@@ -0,0 +1,55 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef PowerTelemetryH
+#define PowerTelemetryH
+
+#include <system.hpp>
+#include "Classes.h"
+//---------------------------------------------------------------------------
+struct TPowerSample
+{ // stan jednego zasilacza w chwili prbkowania
+    float fCurrent; //[A] prd wyjciowy
+    float fVoltage; //[V] napicie wyjciowe
+    short iVehicles; // pojazdy z pantografem na przsach przypisanych do zasilacza
+    short iFuse; // bit 0 - bezpiecznik szybki, bit 1 - bezpiecznik zwoczny
+    int iTrips; // ilo zadziaa bezpiecznikw od wczytania scenerii
+};
+
+struct TPowerStats
+{ // stan biecy zasilacza oraz podsumowanie prbek z bufora
+    float fCurrent, fVoltage; // wartoci biece
+    int iVehicles, iFuse, iTrips;
+    float fCurrentMax, fCurrentAvg, fVoltageMin; // z prbek w buforze
+    int iSamples; // ilo prbek w buforze
+};
+
+class PowerTelemetry
+{ // Ra: klasa statyczna zbierajca obcienie zasilaczy sieci trakcyjnej
+    // prbki s zbierane co (powertelemetry) sekund czasu symulacji do bufora cyklicznego,
+    // wyczona (0) kosztuje jedno porwnanie na krok fizyki
+  private:
+    static TTractionPowerSource **pSources; // zasilacze i sekcje w kolejnoci listy wzw
+    static AnsiString *asNames; // nazwy wzw zasilaczy
+    static int iSources;
+    static double *pTimes; //[s] czasy kolejnych wierszy bufora
+    static TPowerSample *pSamples; // bufor cykliczny, (iSources) prbek w wierszu
+    static int iSamples; // ilo zapisanych wierszy (liczc nadpisane)
+    static double fTime; //[s] czas symulacji od wczenia zbierania
+    static double fElapsed; //[s] czas od ostatniej prbki
+  public:
+    static void Init(TGroundNode *root); // lista zasilaczy po wczytaniu scenerii
+    static bool Due(double dt); // czy pora na kolejn prbk
+    static void Sample();
+    static bool Stats(const AnsiString &name, TPowerStats &s);
+    static bool Dump(); // zapis do powertelemetry.csv
+    static void Free();
+};
+//---------------------------------------------------------------------------
+#endif
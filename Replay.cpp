@@ -0,0 +1,316 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#include "system.hpp"
+#include "classes.hpp"
+#pragma hdrstop
+
+#include "Replay.h"
+#include "Globals.h"
+#include "Logs.h"
+
+#include <stdlib.h>
+#include <fstream>
+
+//---------------------------------------------------------------------------
+#pragma package(smart_init)
+/*
+Nagrywanie i odtwarzanie sesji.
+Symulacja jest deterministyczna, jeli ma te same dane wejciowe. Zaley ona od:
+1. Ziarna generatorw liczb losowych (rand() z C++ oraz Random z Pascala).
+2. Kroku czasu kadej klatki (DeltaTime, DeltaRenderTime) oraz FPS, od ktrego
+   zaley regulacja promienia scenerii (ta uywa random()).
+3. Komunikatw okna: klawisze, aktywacja okna, [F10].
+4. Ramek WM_COPYDATA od programu nadzorujcego (multiplayer).
+5. Ruchw myszy (kamera) i stanu klawiatury odczytywanego przez Console::Pressed().
+Plik nagrania jest cigiem rekordw; wejcia odebrane przed klatk s zapisane
+przed rekordem klatki, wic odtwarzanie podaje je w tej samej kolejnoci.
+Parametr -replayfast pomija czekanie na odwieanie ekranu, obraz jest
+wywietlany co 32 klatki, a fizyka i eventy licz si tak samo.
+*/
+
+int Replay::iMode = 0;
+unsigned int Replay::iSeed = 1; // domylne ziarno rand(), gdy nie ma randomize()
+unsigned int Replay::iFrame = 0;
+unsigned char Replay::cKeys[32];
+bool Replay::bFramePending = false;
+double Replay::fPending[3];
+int Replay::iPending[2];
+double Replay::fWallStart = 0.0;
+bool Replay::bFast = false;
+bool Replay::bFeeding = false;
+AnsiString Replay::asFile = "";
+int Replay::iModeRequested = 0;
+
+std::fstream replay; // plik nagrania, otwarty do zapisu albo odczytu
+const char szReplaySign[8] = {'E', 'U', '0', '7', 'R', 'P', 'L', 'Y'};
+const int iReplayVersion = 1;
+
+void Replay::Write(const void *p, int n)
+{
+    replay.write((const char *)p, n);
+};
+
+bool Replay::Read(void *p, int n)
+{ // false, jeli zabrako danych
+    replay.read((char *)p, n);
+    return !replay.fail();
+};
+
+bool Replay::Open()
+{ // otwarcie pliku nagrania wg parametrw z linii polece; wywoa przed wczytaniem scenerii
+    if (!iModeRequested || asFile.IsEmpty())
+        return false;
+    ZeroMemory(cKeys, sizeof(cKeys));
+    if (iModeRequested == 1)
+    { // nagrywanie: ziarno losowe, eby sesje si rniy
+        replay.open(asFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!replay.is_open())
+        {
+            ErrorLog("Bad replay: cannot create \"" + asFile + "\"");
+            return false;
+        }
+        iSeed = GetTickCount();
+        int len = Global::asHumanCtrlVehicle.Length();
+        Write(szReplaySign, 8);
+        Write(&iReplayVersion, sizeof(int));
+        Write(&iSeed, sizeof(iSeed));
+        Write(Global::szSceneryFile, sizeof(Global::szSceneryFile));
+        Write(&len, sizeof(int));
+        Write(Global::asHumanCtrlVehicle.c_str(), len);
+        WriteLog("Replay: recording to \"" + asFile + "\", seed " + AnsiString(iSeed));
+    }
+    else
+    { // odtwarzanie: sceneria, pojazd i ziarno z nagwka
+        char sign[8];
+        int ver, len;
+        replay.open(asFile.c_str(), std::ios::in | std::ios::binary);
+        if (!replay.is_open())
+        {
+            ErrorLog("Bad replay: cannot open \"" + asFile + "\"");
+            return false;
+        }
+        if (!Read(sign, 8) || memcmp(sign, szReplaySign, 8) || !Read(&ver, sizeof(int)) ||
+            (ver != iReplayVersion))
+        {
+            ErrorLog("Bad replay: \"" + asFile + "\" is not a replay file of version " +
+                     AnsiString(iReplayVersion));
+            replay.close();
+            return false;
+        }
+        Read(&iSeed, sizeof(iSeed));
+        Read(Global::szSceneryFile, sizeof(Global::szSceneryFile));
+        Read(&len, sizeof(int));
+        Global::asHumanCtrlVehicle.SetLength(len);
+        if (len)
+            Read(Global::asHumanCtrlVehicle.c_str(), len);
+        Global::bInactivePause = false; // okno w tle nie moe zmienia przebiegu
+        WriteLog("Replay: playing \"" + asFile + "\", seed " + AnsiString(iSeed) + ", scenery " +
+                 AnsiString(Global::szSceneryFile) +
+                 (bFast ? AnsiString(", maximum speed") : AnsiString("")));
+    }
+    srand(iSeed); // generator C++
+    System::RandSeed = iSeed; // generator Pascala (fizyka)
+    iMode = iModeRequested;
+    iFrame = 0;
+    fWallStart = GetTickCount() * 0.001;
+    return true;
+};
+
+void Replay::Stop(const char *reason)
+{ // zakoczenie odtwarzania, sesja si koczy
+    double wall = GetTickCount() * 0.001 - fWallStart;
+    WriteLog("Replay: " + AnsiString(reason) + " after " + AnsiString(iFrame) + " frames, " +
+             FloatToStrF(wall, ffFixed, 7, 2) + "s");
+    replay.close();
+    iMode = 0;
+    PostQuitMessage(0);
+};
+
+void Replay::Close()
+{
+    if (iMode == 1)
+    {
+        char c = replay_end;
+        Write(&c, 1);
+        replay.close();
+        WriteLog("Replay: recorded " + AnsiString(iFrame) + " frames");
+    }
+    else if (iMode == 2)
+        replay.close();
+    iMode = 0;
+};
+
+bool Replay::IsInput(unsigned int m, unsigned int w)
+{ // czy komunikat okna zmienia przebieg symulacji (mysz i WM_COPYDATA s osobno)
+    switch (m)
+    {
+    case WM_KEYDOWN:
+    case WM_KEYUP:
+    case WM_ACTIVATE:
+        return true;
+    case WM_SYSCOMMAND:
+        return (w == 61696); //[F10]
+    }
+    return false;
+};
+
+void Replay::KeysCapture()
+{ // zapisanie stanu klawiatury, jeli si zmieni
+    unsigned char state[256], bits[32];
+    GetKeyboardState(state);
+    ZeroMemory(bits, sizeof(bits));
+    for (int i = 0; i < 256; ++i)
+        if (state[i] & 0x80)
+            bits[i >> 3] |= 1 << (i & 7);
+    if (memcmp(bits, cKeys, sizeof(bits)))
+    {
+        char c = replay_keys;
+        memcpy(cKeys, bits, sizeof(bits));
+        Write(&c, 1);
+        Write(cKeys, sizeof(cKeys));
+    }
+};
+
+void Replay::Message(unsigned int m, unsigned int w, long l)
+{
+    char c = replay_message;
+    KeysCapture(); // Console::Pressed() w obsudze klawisza czyta stan z tej chwili
+    Write(&c, 1);
+    Write(&m, sizeof(m));
+    Write(&w, sizeof(w));
+    Write(&l, sizeof(l));
+};
+
+void Replay::Data(unsigned long d, unsigned long n, const void *p)
+{
+    char c = replay_data;
+    if (n > sizeof(((TReplayInput *)0)->cData))
+        n = sizeof(((TReplayInput *)0)->cData); // duszych ramek program nie obsuguje
+    KeysCapture();
+    Write(&c, 1);
+    Write(&d, sizeof(d));
+    Write(&n, sizeof(n));
+    Write(p, n);
+};
+
+void Replay::Mouse(double x, double y)
+{
+    char c = replay_mouse;
+    Write(&c, 1);
+    Write(&x, sizeof(x));
+    Write(&y, sizeof(y));
+};
+
+bool Replay::Next(TReplayInput &r)
+{ // odczytanie kolejnego wejcia przed klatk; false, gdy nastpna jest klatka
+    char c;
+    if (iMode != 2)
+        return false;
+    while (!bFramePending)
+    {
+        if (!Read(&c, 1))
+        {
+            Stop("unexpected end of file");
+            return false;
+        }
+        r.cType = c;
+        switch (c)
+        {
+        case replay_keys:
+            if (!Read(cKeys, sizeof(cKeys)))
+                break;
+            continue; // czyta dalej
+        case replay_message:
+            if (!Read(&r.uMsg, sizeof(r.uMsg)) || !Read(&r.wParam, sizeof(r.wParam)) ||
+                !Read(&r.lParam, sizeof(r.lParam)))
+                break;
+            return true;
+        case replay_data:
+            if (!Read(&r.dwData, sizeof(r.dwData)) || !Read(&r.cbData, sizeof(r.cbData)))
+                break;
+            if (r.cbData > sizeof(r.cData))
+            { // Data() obcina ramki przy zapisie, wic dusza oznacza uszkodzony plik
+                Stop("corrupted file");
+                return false;
+            }
+            if (!Read(r.cData, r.cbData))
+                break;
+            return true;
+        case replay_mouse:
+            if (!Read(&r.fX, sizeof(r.fX)) || !Read(&r.fY, sizeof(r.fY)))
+                break;
+            return true;
+        case replay_frame:
+            if (!Read(fPending, sizeof(fPending)) || !Read(iPending, sizeof(iPending)))
+                break;
+            bFramePending = true;
+            return false;
+        case replay_end:
+            Stop("finished");
+            return false;
+        default:
+            Stop("corrupted file");
+            return false;
+        }
+        Stop("unexpected end of file"); // wpis urwany w poowie
+        return false;
+    }
+    return false;
+};
+
+void Replay::Timers(double &dt, double &rdt, double &fps)
+{ // nagranie albo podmiana czasw klatki
+    if (iMode == 1)
+    {
+        char c = replay_frame;
+        int state[2];
+        state[0] = Global::iPause;
+        state[1] = Global::bActive;
+        KeysCapture();
+        Write(&c, 1);
+        Write(&dt, sizeof(dt));
+        Write(&rdt, sizeof(rdt));
+        Write(&fps, sizeof(fps));
+        Write(state, sizeof(state));
+        ++iFrame;
+    }
+    else if (iMode == 2)
+    {
+        TReplayInput r;
+        while (!bFramePending && (iMode == 2))
+            if (Next(r)) // wejcia powinny by ju przekazane do okna
+                ErrorLog("Bad replay: input skipped in frame " + AnsiString(iFrame));
+        if (!bFramePending)
+            return; // koniec nagrania
+        dt = fPending[0];
+        rdt = fPending[1];
+        fps = fPending[2];
+        if ((Global::iPause != iPending[0]) || (Global::bActive != bool(iPending[1])))
+        { // rozbieno oznacza, e nagranie nie pasuje do programu albo scenerii
+            ErrorLog("Bad replay: state mismatch in frame " + AnsiString(iFrame));
+            Global::iPause = iPending[0];
+            Global::bActive = iPending[1];
+        }
+        bFramePending = false;
+        ++iFrame;
+    }
+};
+
+bool Replay::Pressed(int k)
+{ // stan klawisza z nagrania
+    return (cKeys[(k >> 3) & 31] & (1 << (k & 7))) != 0;
+};
+
+bool Replay::SwapNeeded()
+{ // czy wywietli klatk (przy szybkim odtwarzaniu tylko co jaki czas)
+    return !bFast || (iMode != 2) || ((iFrame & 31) == 0);
+};
+
+//---------------------------------------------------------------------------
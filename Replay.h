@@ -0,0 +1,84 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef ReplayH
+#define ReplayH
+
+#include <system.hpp>
+//---------------------------------------------------------------------------
+// Ra: rodzaje rekordw w pliku nagrania (pierwszy bajt rekordu)
+const char replay_frame = 'F'; // krok czasu klatki (koczy zestaw wej danej klatki)
+const char replay_message = 'W'; // komunikat okna (klawisze, aktywacja, F10)
+const char replay_data = 'D'; // ramka WM_COPYDATA od programu nadzorujcego
+const char replay_mouse = 'M'; // przesunicie myszy (ju przeliczone)
+const char replay_keys = 'K'; // stan klawiatury (zapisywany tylko przy zmianie)
+const char replay_end = 'E'; // koniec nagrania
+
+struct TReplayInput
+{ // jedno zewntrzne wejcie odczytane z nagrania
+    char cType; // replay_message, replay_data albo replay_mouse
+    unsigned int uMsg; // numer komunikatu
+    unsigned int wParam;
+    long lParam;
+    double fX, fY; // przesunicie myszy
+    unsigned long dwData; // sygnatura danych WM_COPYDATA
+    unsigned long cbData; // dugo danych w (cData)
+    char cData[2048]; // tre ramki WM_COPYDATA (DaneRozkaz2 mieci si)
+};
+
+class Replay
+{ // Ra: klasa statyczna nagrywajca i odtwarzajca zewntrzne wejcia symulacji
+    // nagrywane s: ziarno generatorw losowych, krok czasu kadej klatki, komunikaty
+    // klawiatury, ruchy myszy, ramki od programu nadzorujcego oraz stan klawiatury
+    // odtworzenie z tymi samymi danymi daje t sam sesj, wic nadaje si na test wydajnoci
+  private:
+    static int iMode; // 0-wyczone, 1-nagrywanie, 2-odtwarzanie
+    static unsigned int iSeed; // ziarno generatorw liczb losowych
+    static unsigned int iFrame; // numer kolejnej klatki
+    static unsigned char cKeys[32]; // bity wcinitych klawiszy (stan z ostatniej klatki)
+    static bool bFramePending; // odczytano ju rekord klatki, czeka na UpdateTimers()
+    static double fPending[3]; // odczytane czasy klatki
+    static int iPending[2]; // odczytana pauza i aktywno okna
+    static double fWallStart; // czas rzeczywisty rozpoczcia odtwarzania
+    static void KeysCapture();
+    static bool Read(void *p, int n);
+    static void Write(const void *p, int n);
+    static void Stop(const char *reason);
+
+  public:
+    static bool bFast; // odtwarzanie z maksymaln szybkoci (bez czekania na ekran)
+    static bool bFeeding; // wejcie pochodzi z nagrania, a nie z systemu
+    static AnsiString asFile; // nazwa pliku nagrania
+    static int iModeRequested; // tryb ustawiony z linii polece
+    static bool Open();
+    static void Close();
+    static inline bool Recording()
+    {
+        return iMode == 1;
+    };
+    static inline bool Playing()
+    {
+        return iMode == 2;
+    };
+    static inline unsigned int Frame()
+    {
+        return iFrame;
+    };
+    static bool IsInput(unsigned int m, unsigned int w);
+    static void Message(unsigned int m, unsigned int w, long l);
+    static void Data(unsigned long d, unsigned long n, const void *p);
+    static void Mouse(double x, double y);
+    static void Timers(double &dt, double &rdt, double &fps);
+    static bool Next(TReplayInput &r);
+    static bool Pressed(int k);
+    static bool SwapNeeded();
+};
+
+//---------------------------------------------------------------------------
+#endif
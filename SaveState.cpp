@@ -0,0 +1,274 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#include "system.hpp"
+#include "classes.hpp"
+#pragma hdrstop
+
+#include "SaveState.h"
+#include "Ground.h"
+#include "Globals.h"
+#include "Logs.h"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+//---------------------------------------------------------------------------
+#pragma package(smart_init)
+/*
+Zapis i odtworzenie stanu uruchomionej sesji.
+Plik stanu nie zawiera scenerii, tylko zmienne, ktre zmieniaj si w trakcie jazdy:
+czas symulacji, pooenie zwrotnic, zawarto komrek pamici, stan zasilaczy,
+pooenie osi na torach, parametry fizyki pojazdw, stan AI oraz kolejk eventw.
+Odtworzenie jest moliwe tylko w tej samej scenerii z tym samym taborem (sprawdzane
+na pocztku pliku, przed zmian czegokolwiek). Tory s zapisywane jako numery na licie
+torw scenerii, a eventy i pojazdy jako nazwy.
+Klawisze: [Ctrl]+[F11] zapis, [Ctrl]+[Shift]+[F11] odczyt.
+Parametr -savestate ustala nazw pliku, -loadstate wczytuje stan po wczytaniu scenerii.
+Przed odczytem biecy stan jest zapisywany do pamici; jeli plik okae si uszkodzony
+albo niepeny w dowolnym miejscu, sceneria jest odtwarzana z tej kopii, wic nie zostaje
+w poowie wczytana. Zmiany z efektami ubocznymi nie s przy tym wykonywane dwa razy:
+zwrotnice s przestawiane bez animacji (wic bez eventw jej zakoczenia), a przejcia
+osi na inne tory (liczniki odcinkw izolowanych) s zbierane w AxleMove() i wykonywane
+raz, dopiero po udanym odczycie. Zasilacze s po odczycie przeliczane (TractionRepower()),
+a sie zastpcza rozkadana od nowa.
+Keep() i Restore() zapamituj stan w pamici, aby przebiegi prbne zaczynay si od tego
+samego stanu i nie zostawiay po sobie zmian.
+*/
+
+int TSaveState::iMode = 0;
+AnsiString TSaveState::asFile = "eu07.sav";
+bool TSaveState::bLoadRequested = false;
+
+std::fstream state; // plik stanu, otwarty do zapisu albo odczytu
+std::iostream *io = &state; // strumie dla Field(): plik albo kopia w pamici
+std::stringstream kept(std::ios::in | std::ios::out | std::ios::binary); // stan z Keep()
+std::vector<TTrack *> StateTracks; // tory scenerii w kolejnoci listy
+std::map<TTrack *, int> StateTrackIndex; // numery torw do zapisu
+const char szStateSign[8] = {'E', 'U', '0', '7', 'S', 'A', 'V', 'E'};
+const int iStateVersion = 2; // 2: stan obszarw zasilaczy i obcienia sieci zastpczej
+
+struct TStateAxle
+{ // przejcie osi na inny tor, wykonywane po udanym odczycie
+    TTrack *pFrom, *pTo;
+    TDynamicObject *pOwner;
+};
+std::vector<TStateAxle> StateAxles;
+
+void TSaveState::Field(void *p, int n)
+{ // zapis albo odczyt (n) bajtw spod (p), zalenie od trybu
+    if (iMode == 1)
+        io->write((const char *)p, n);
+    else if (iMode == 2)
+        io->read((char *)p, n);
+};
+
+void TSaveState::Text(AnsiString &s)
+{ // napis zapisywany jako dugo i znaki
+    int len = s.Length();
+    Field(&len, sizeof(int));
+    if (Loading())
+    {
+        if ((len < 0) || (len > 65536) || io->fail())
+            len = 0; // uszkodzony plik, odczyt i tak si nie powiedzie
+        s.SetLength(len);
+    }
+    if (len)
+        Field(s.c_str(), len);
+};
+
+void TSaveState::Fail()
+{ // odczytane dane nie maj sensu, dalszy odczyt si nie powiedzie
+    io->setstate(std::ios::failbit);
+};
+
+void TSaveState::AxleMove(TTrack *from, TTrack *to, TDynamicObject *o)
+{ // zapamitanie zmiany toru osi; liczniki osi zmieni dopiero AxlesApply()
+    TStateAxle a = {from, to, o};
+    StateAxles.push_back(a);
+};
+
+void TSaveState::AxlesApply(bool apply)
+{ // liczniki osi odcinkw izolowanych po odczycie, najpierw +1, pniej -1, jak w
+    // SetCurrentTrack(); (apply)=false porzuca zmiany z nieudanego odczytu i z powrotu
+    if (apply)
+        for (unsigned int i = 0; i < StateAxles.size(); ++i)
+        {
+            StateAxles[i].pTo->AxleCounter(+1, StateAxles[i].pOwner);
+            if (StateAxles[i].pFrom)
+                StateAxles[i].pFrom->AxleCounter(-1, StateAxles[i].pOwner);
+        }
+    StateAxles.clear();
+};
+
+void TSaveState::TrackClear()
+{
+    StateTracks.clear();
+    StateTrackIndex.clear();
+};
+
+void TSaveState::TrackAdd(TTrack *t)
+{ // tory s dodawane w kolejnoci listy scenerii, taka sama przy zapisie i odczycie
+    StateTrackIndex[t] = StateTracks.size();
+    StateTracks.push_back(t);
+};
+
+int TSaveState::TrackIndex(TTrack *t)
+{ // numer toru, -1 dla toru utworzonego w trakcie jazdy (np. wykolejenie)
+    std::map<TTrack *, int>::iterator i = StateTrackIndex.find(t);
+    return (i == StateTrackIndex.end()) ? -1 : i->second;
+};
+
+TTrack * TSaveState::Track(int i)
+{
+    return ((i >= 0) && (i < int(StateTracks.size()))) ? StateTracks[i] : NULL;
+};
+
+bool TSaveState::Open(AnsiString file, int mode)
+{
+    if (mode == 1)
+        state.open(file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    else
+        state.open(file.c_str(), std::ios::in | std::ios::binary);
+    if (!state.is_open())
+    {
+        ErrorLog("Bad state: cannot open \"" + file + "\"");
+        return false;
+    }
+    if (mode == 1)
+    {
+        state.write(szStateSign, 8);
+        state.write((const char *)&iStateVersion, sizeof(int));
+        state.write(Global::szSceneryFile, sizeof(Global::szSceneryFile));
+    }
+    else
+    {
+        char sign[8], scenery[sizeof(Global::szSceneryFile)];
+        int ver = 0;
+        state.read(sign, 8);
+        state.read((char *)&ver, sizeof(int));
+        state.read(scenery, sizeof(scenery));
+        if (state.fail() || memcmp(sign, szStateSign, 8) || (ver != iStateVersion))
+        {
+            ErrorLog("Bad state: \"" + file + "\" is not a state file of version " +
+                     AnsiString(iStateVersion));
+            state.close();
+            return false;
+        }
+        scenery[sizeof(scenery) - 1] = '\0';
+        if (strcmp(scenery, Global::szSceneryFile))
+        {
+            ErrorLog("Bad state: \"" + file + "\" was saved in scenery " + AnsiString(scenery));
+            state.close();
+            return false;
+        }
+    }
+    iMode = mode;
+    return true;
+};
+
+void TSaveState::Close()
+{
+    state.close();
+    state.clear(); // kolejne otwarcie nie moe dziedziczy bdu
+    iMode = 0;
+    TrackClear();
+};
+
+bool TSaveState::Save(TGround *g)
+{ // zapis stanu scenerii do pliku (asFile)
+    LARGE_INTEGER t0, t1, f;
+    QueryPerformanceCounter(&t0);
+    if (!Open(asFile, 1))
+        return false;
+    g->State();
+    bool ok = !state.fail();
+    int size = state.tellp();
+    Close();
+    QueryPerformanceCounter(&t1);
+    QueryPerformanceFrequency(&f);
+    if (!ok)
+    {
+        ErrorLog("Bad state: write error in \"" + asFile + "\"");
+        return false;
+    }
+    WriteLog("State saved to \"" + asFile + "\": " + AnsiString(size) + " bytes in " +
+             FloatToStrF(1000.0 * double(t1.QuadPart - t0.QuadPart) / double(f.QuadPart),
+                         ffFixed, 7, 1) +
+             " ms");
+    return true;
+};
+
+bool TSaveState::Load(TGround *g)
+{ // odtworzenie stanu scenerii z pliku (asFile)
+    LARGE_INTEGER t0, t1, f;
+    QueryPerformanceCounter(&t0);
+    if (!Open(asFile, 2))
+        return false;
+    std::stringstream backup(std::ios::in | std::ios::out | std::ios::binary);
+    io = &backup; // kopia biecego stanu
+    iMode = 1;
+    g->State();
+    io = &state;
+    iMode = 2;
+    bool ok = g->State() && !state.fail();
+    if (ok)
+        ok = (state.peek() == EOF); // plik musi si skoczy razem ze stanem
+    AxlesApply(ok);
+    if (!ok)
+    { // powrt do stanu sprzed odczytu; osie wracaj na swoje tory, wic liczniki bez zmian
+        io = &backup;
+        g->State();
+        io = &state;
+        AxlesApply(false);
+    }
+    Close();
+    QueryPerformanceCounter(&t1);
+    QueryPerformanceFrequency(&f);
+    if (!ok)
+    {
+        ErrorLog("Bad state: \"" + asFile +
+                 "\" does not match the running scenery, nothing changed");
+        return false;
+    }
+    WriteLog("State loaded from \"" + asFile + "\" in " +
+             FloatToStrF(1000.0 * double(t1.QuadPart - t0.QuadPart) / double(f.QuadPart),
+                         ffFixed, 7, 1) +
+             " ms");
+    return true;
+};
+
+bool TSaveState::Keep(TGround *g)
+{ // zapamitanie stanu scenerii w pamici, przed przebiegiem prbnym
+    kept.str("");
+    kept.clear();
+    io = &kept;
+    iMode = 1;
+    bool ok = g->State() && !kept.fail();
+    io = &state;
+    iMode = 0;
+    TrackClear();
+    return ok;
+};
+
+bool TSaveState::Restore(TGround *g)
+{ // odtworzenie stanu z Keep(), mona wielokrotnie; false, gdy zmienia si lista pojazdw
+    kept.clear();
+    kept.seekg(0);
+    io = &kept;
+    iMode = 2;
+    bool ok = g->State() && !kept.fail();
+    AxlesApply(true);
+    io = &state;
+    iMode = 0;
+    TrackClear();
+    return ok;
+};
@@ -0,0 +1,51 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef SaveStateH
+#define SaveStateH
+
+#include <system.hpp>
+//---------------------------------------------------------------------------
+class TTrack;
+class TGround;
+class TDynamicObject;
+
+class TSaveState
+{ // Ra: klasa statyczna zapisujca i odtwarzajca stan uruchomionej symulacji
+    // kady obiekt ma metod State(), ktra tymi samymi wywoaniami Field() zapisuje albo
+    // odczytuje swoje zmienne, wic kolejno zapisu i odczytu jest zawsze taka sama
+  private:
+    static int iMode; // 0-nieaktywne, 1-zapis, 2-odczyt
+    static bool Open(AnsiString file, int mode);
+    static void Close();
+    static void AxlesApply(bool apply);
+
+  public:
+    static AnsiString asFile; // nazwa pliku stanu
+    static bool bLoadRequested; // wczyta stan zaraz po wczytaniu scenerii
+    static inline bool Loading()
+    {
+        return iMode == 2;
+    };
+    static void Field(void *p, int n);
+    static void Text(AnsiString &s);
+    static void Fail();
+    static void AxleMove(TTrack *from, TTrack *to, TDynamicObject *o);
+    static void TrackClear();
+    static void TrackAdd(TTrack *t);
+    static int TrackIndex(TTrack *t);
+    static TTrack * Track(int i);
+    static bool Save(TGround *g);
+    static bool Load(TGround *g);
+    static bool Keep(TGround *g);
+    static bool Restore(TGround *g);
+};
+
+//---------------------------------------------------------------------------
+#endif
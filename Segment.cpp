@@ -25,6 +25,11 @@ http://mozilla.org/MPL/2.0/.
 // 101206 Ra: trapezoidalne drogi
 // 110806 Ra: odwrcone mapowanie wzdu - Point1 == 1.0
 
+int TSegment::iArcTables = 0;
+int TSegment::iArcNodes = 0;
+double TSegment::fArcError = 0.0;
+TSegment *TSegment::pArcLongest = NULL;
+
 AnsiString Where(vector3 p)
 { // zamiana wsprzdnych na tekst, uywana w bdach
     return AnsiString(p.x) + " " + AnsiString(p.y) + " " + AnsiString(p.z);
@@ -37,6 +42,9 @@ TSegment::TSegment(TTrack *owner)
     fRoll1 = 0;
     fRoll2 = 0;
     fTsBuffer = NULL;
+    fArc = NULL;
+    iArcCount = 0;
+    iRevision = 0;
     fStep = 0;
     pOwner = owner;
 };
@@ -44,6 +52,9 @@ TSegment::TSegment(TTrack *owner)
 TSegment::~TSegment()
 {
     SafeDeleteArray(fTsBuffer);
+    SafeDeleteArray(fArc);
+    if (pArcLongest == this)
+        pArcLongest = NULL;
 };
 
 bool TSegment::Init(vector3 NewPoint1, vector3 NewPoint2, double fNewStep, double fNewRoll1,
@@ -68,6 +79,7 @@ bool TSegment::Init(vector3 &NewPoint1, vector3 NewCPointOut, vector3 NewCPointI
                     vector3 &NewPoint2, double fNewStep, double fNewRoll1, double fNewRoll2,
                     bool bIsCurve)
 { // wersja uniwersalna (dla krzywej i prostego)
+    ++iRevision; // osie na tym odcinku musz przeliczy pooenie od nowa
     Point1 = NewPoint1;
     CPointOut = NewCPointOut;
     CPointIn = NewCPointIn;
@@ -123,6 +135,9 @@ bool TSegment::Init(vector3 &NewPoint1, vector3 NewCPointOut, vector3 NewCPointI
     }
     fStoop = atan2((Point2.y - Point1.y),
                    fLength); // pochylenie toru prostego, eby nie liczy wielokrotnie
+    SafeDeleteArray(fArc);
+    if (bCurve)
+        ArcBuild(); // przed (fTsBuffer), bo ten te uywa GetTFromS()
     SafeDeleteArray(fTsBuffer);
     if ((bCurve) && (fStep > 0))
     { // Ra: prosty dostanie podzia, jak ma rn przechyk na kocach
@@ -201,7 +216,7 @@ double TSegment::RombergIntegral(double fA, double fB)
     return ms_apfRom[0][ms_iOrder - 1];
 }
 
-double TSegment::GetTFromS(double s)
+double TSegment::NewtonTFromS(double s)
 {
     // initial guess for Newton's method
     int it = 0;
@@ -233,6 +248,111 @@ double TSegment::GetTFromS(double s)
     // return -1; //Ra: tu nigdy nie dojdzie
 };
 
+double TSegment::ArcTFromS(double s0, double t0, double s)
+{ // parametr dla odlegoci (s), liczony od znanego punktu (s0,t0), wic caka jest krtka
+    double d = GetFirstDerivative(t0).Length();
+    double t = t0 + (d > 0.0 ? (s - s0) / d : 0.0);
+    for (int it = 0; it < 20; ++it)
+    {
+        double f = s0 + RombergIntegral(t0, t) - s;
+        if (fabs(f) < 1e-6) // dokadno 0.001mm
+            break;
+        d = GetFirstDerivative(t).Length();
+        if (d <= 0.0)
+            break;
+        t -= f / d;
+    }
+    return t;
+};
+
+void TSegment::ArcBuild()
+{ // tabela parametru (t) w rwnych odstpach dugoci, zamiast metody Newtona przy kadym
+    // ustawieniu osi; midzy wzami interpolacja Hermite'a z pochodn dt/ds=1/|P'(t)|
+    iArcCount = ceil(fLength / 4.0); // wzy nie rzadziej ni co 4m
+    if (iArcCount < 4)
+        iArcCount = 4;
+    double h = fLength / iArcCount, t = 0.0, d;
+    int i;
+    fArcScale = 1.0 / h;
+    fArc = new double[2 * iArcCount + 2];
+    for (i = 0; i <= iArcCount; ++i)
+    {
+        if (i)
+            t = ArcTFromS((i - 1) * h, t, i * h);
+        d = GetFirstDerivative(t).Length();
+        fArc[2 * i] = t;
+        fArc[2 * i + 1] = (d > 0.0) ? h / d : 0.0; // pochodna przemnoona przez odstp
+    }
+    for (i = 0; i < iArcCount; ++i)
+    { // sprawdzenie w rodkach odstpw, gdzie bd interpolacji jest najwikszy
+        t = ArcTFromS(i * h, fArc[2 * i], (i + 0.5) * h);
+        d = (RaInterpolate0(GetTFromS((i + 0.5) * h)) - RaInterpolate0(t)).Length();
+        if (d > fArcError)
+            fArcError = d;
+    }
+    ++iArcTables;
+    iArcNodes += iArcCount + 1;
+    if (pArcLongest ? fLength > pArcLongest->fLength : true)
+        pArcLongest = this;
+};
+
+double TSegment::GetTFromS(double s)
+{ // parametr krzywej Beziera dla odlegoci (s) od Point1
+    if (!fArc)
+        return NewtonTFromS(s);
+    double x = s * fArcScale; // pozycja w odstpach tabeli
+    const double *a;
+    if (x <= 0.0) // przed pocztkiem liniowo, jak GetDirection() sprawdza (t<=0)
+        return fArc[0] + x * fArc[1];
+    int i = int(x);
+    if (i >= iArcCount)
+    { // za kocem rwnie liniowo
+        a = fArc + 2 * iArcCount;
+        return a[0] + (x - iArcCount) * a[1];
+    }
+    x -= i;
+    a = fArc + 2 * i;
+    double x2 = x * x, x3 = x2 * x;
+    return a[0] + (a[2] - a[0]) * (3.0 * x2 - 2.0 * x3) + a[1] * (x3 - 2.0 * x2 + x) +
+           a[3] * (x3 - x2);
+};
+
+void TSegment::ArcReport()
+{ // statystyka tabel dugoci uku i porwnanie szybkoci z metod Newtona
+    if (!iArcTables)
+        return;
+    AnsiString info = "Arc length tables: " + AnsiString(iArcTables) + " curves, " +
+                      AnsiString(iArcNodes) + " nodes (" + AnsiString(iArcNodes / 64) +
+                      " kB), max error " + FloatToStrF(1000.0 * fArcError, ffFixed, 7, 4) + " mm";
+    if (pArcLongest)
+    { // pomiar na najduszym uku: tyle ustawie osi, co w wielu krokach fizyki
+        TSegment *g = pArcLongest;
+        double *arc = g->fArc;
+        const int n = 2000;
+        vector3 p, a;
+        LARGE_INTEGER t0, t1, t2, f;
+        int i;
+        QueryPerformanceCounter(&t0);
+        for (i = 0; i < n; ++i)
+            g->RaPositionGet(g->fLength * (i + 0.5) / n, p, a);
+        QueryPerformanceCounter(&t1);
+        g->fArc = NULL; // to samo metod Newtona
+        for (i = 0; i < n; ++i)
+            g->RaPositionGet(g->fLength * (i + 0.5) / n, p, a);
+        QueryPerformanceCounter(&t2);
+        g->fArc = arc;
+        QueryPerformanceFrequency(&f);
+        info += ", axle position " +
+                FloatToStrF(1e6 * double(t1.QuadPart - t0.QuadPart) / double(f.QuadPart) / n,
+                            ffFixed, 7, 3) +
+                " us (Newton " +
+                FloatToStrF(1e6 * double(t2.QuadPart - t1.QuadPart) / double(f.QuadPart) / n,
+                            ffFixed, 7, 3) +
+                " us)";
+    }
+    WriteLog(info);
+};
+
 vector3 TSegment::RaInterpolate(double t)
 { // wyliczenie XYZ na krzywej Beziera z uyciem wspczynnikw
     return t * (t * (t * vA + vB) + vC) + Point1; // 9 mnoe, 9 dodawa
@@ -308,13 +428,7 @@ void TSegment::RaPositionGet(double fDistance, vector3 &p, vector3 &a)
 { // ustalenie pozycji osi na torze, przechyki, pochylenia i kierunku jazdy
     if (bCurve)
     { // mona by wprowadzi uproszczony wzr dla okrgw paskich
-        double t = GetTFromS(fDistance); // aproksymacja dystansu na krzywej Beziera na parametr (t)
-        p = RaInterpolate(t);
-        a.x = (1.0 - t) * fRoll1 + (t)*fRoll2; // przechyka w danym miejscu (zmienia si liniowo)
-        // pochodna jest 3*A*t^2+2*B*t+C
-        a.y = atan(t * (t * 3.0 * vA.y + vB.y + vB.y) + vC.y); // pochylenie krzywej (w pionie)
-        a.z = -atan2(t * (t * 3.0 * vA.x + vB.x + vB.x) + vC.x,
-                     t * (t * 3.0 * vA.z + vB.z + vB.z) + vC.z); // kierunek krzywej w planie
+        RaPositionT(GetTFromS(fDistance), p, a); // aproksymacja dystansu na parametr (t)
     }
     else
     { // wyliczenie dla odcinka prostego jest prostsze
@@ -326,6 +440,18 @@ void TSegment::RaPositionGet(double fDistance, vector3 &p, vector3 &a)
     }
 };
 
+double TSegment::RaPositionT(double t, vector3 &p, vector3 &a)
+{ // pozycja i kty na krzywej dla parametru (t); zwraca pochodn dt/ds do przesuwania osi
+    p = RaInterpolate(t);
+    a.x = (1.0 - t) * fRoll1 + (t)*fRoll2; // przechyka w danym miejscu (zmienia si liniowo)
+    // pochodna jest 3*A*t^2+2*B*t+C
+    vector3 d = t * (t * 3.0 * vA + vB + vB) + vC;
+    a.y = atan(d.y); // pochylenie krzywej (w pionie)
+    a.z = -atan2(d.x, d.z); // kierunek krzywej w planie
+    double l = d.Length();
+    return (l > 0.0) ? 1.0 / l : 0.0;
+};
+
 vector3 TSegment::FastGetPoint(double t)
 {
     // return (bCurve?Interpolate(t,Point1,CPointOut,CPointIn,Point2):((1.0-t)*Point1+(t)*Point2));
@@ -55,6 +55,9 @@ class TSegment
     double fRoll1, fRoll2; // przechyka na kocach
     double fLength; // dugo policzona
     double *fTsBuffer; // wartoci parametru krzywej dla rwnych odcinkw
+    double *fArc; // pary (t, h*dt/ds) w rwnych odstpach dugoci, dla GetTFromS()
+    double fArcScale; // odwrotno odstpu wzw (fArc) [1/m]
+    int iArcCount; // ilo odstpw w (fArc)
     double fStep;
     int iSegCount; // ilo odcinkw do rysowania krzywej
     double fDirection; // Ra: kt prostego w planie; dla uku kt od Point1
@@ -66,13 +69,26 @@ class TSegment
     double fAngle[2]; // kty zakoczenia drogi na przejazdach
     vector3 GetFirstDerivative(double fTime);
     double RombergIntegral(double fA, double fB);
-    double GetTFromS(double s);
+    double NewtonTFromS(double s);
+    double ArcTFromS(double s0, double t0, double s);
+    void ArcBuild();
     vector3 RaInterpolate(double t);
     vector3 RaInterpolate0(double t);
     // TSegment *segNeightbour[2]; //ssiednie odcinki - musi by przeniesione z Track
     // int iNeightbour[2]; //do ktrego koca doczepiony
+    static int iArcTables; // statystyka tabel dugoci uku
+    static int iArcNodes;
+    static double fArcError; // najwiksza odchyka pooenia z tabeli [m]
+    static TSegment *pArcLongest; // najduszy uk, do pomiaru szybkoci
+
   public:
     bool bCurve;
+    int iRevision; // zwikszany przy zmianie ksztatu (obrotnica), uniewania pami osi
+    static void ArcReport();
+    static inline TSegment * ArcLongest()
+    {
+        return pArcLongest;
+    };
     // int iShape; //Ra: flagi ksztatu dadz wicej moliwoci optymalizacji
     // (0-Bezier,1-prosty,2/3-uk w lewo/prawo,6/7-przejciowa w lewo/prawo)
     TSegment(TTrack *owner);
@@ -97,7 +113,9 @@ class TSegment
     };
     vector3 FastGetDirection(double fDistance, double fOffset);
     vector3 GetPoint(double fDistance);
+    double GetTFromS(double s);
     void RaPositionGet(double fDistance, vector3 &p, vector3 &a);
+    double RaPositionT(double t, vector3 &p, vector3 &a);
     vector3 FastGetPoint(double t);
     inline vector3 FastGetPoint_0()
     {
@@ -129,6 +147,7 @@ class TSegment
     };
     void MoveMe(vector3 pPosition)
     {
+        ++iRevision;
         Point1 += pPosition;
         Point2 += pPosition;
         if (bCurve)
@@ -13,6 +13,7 @@ http://mozilla.org/MPL/2.0/.
 
 #include "Timer.h"
 #include "Globals.h"
+#include "Replay.h"
 
 namespace Timer
 {
@@ -89,9 +90,6 @@ void UpdateTimers(bool pause)
     if (!pause)
     {
         DeltaTime = Global::fTimeSpeed * DeltaRenderTime;
-        fSoundTimer += DeltaTime;
-        if (fSoundTimer > 0.1)
-            fSoundTimer = 0;
         /*
           double CurrentTime= double(count)/double(fr);//GetTickCount();
           DeltaTime= (CurrentTime-OldTime);
@@ -114,6 +112,14 @@ void UpdateTimers(bool pause)
         fLastTime = fTime;
         dwFrames = 0L;
     }
+    if (Replay::Recording() || Replay::Playing())
+        Replay::Timers(DeltaTime, DeltaRenderTime, fFPS); // zapis albo podmiana na nagrane
+    if (DeltaTime > 0.0)
+    {
+        fSoundTimer += DeltaTime;
+        if (fSoundTimer > 0.1)
+            fSoundTimer = 0;
+    }
     fSimulationTime += DeltaTime;
 };
 };
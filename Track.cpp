@@ -27,6 +27,9 @@ http://mozilla.org/MPL/2.0/.
 #include "AnimModel.h"
 #include "MemCell.h"
 #include "Event.h"
+#include "TrackGraph.h"
+#include "PhysThread.h"
+#include "SaveState.h"
 
 #pragma package(smart_init)
 
@@ -34,6 +37,7 @@ http://mozilla.org/MPL/2.0/.
 // 110720 Ra: rozprucie zwrotnicy i odcinki izolowane
 
 static const double fMaxOffset = 0.1; // double(0.1f)==0.100000001490116
+const int iBladeVerts = 2 * 2 * 12; // iglica: 2 odcinki amanej, 12 punktw przekroju na obu kocach
 // const int NextMask[4]={0,1,0,1}; //tor nastpny dla stanw 0, 1, 2, 3
 // const int PrevMask[4]={0,0,1,1}; //tor poprzedni dla stanw 0, 1, 2, 3
 const int iLewo4[4] = {5, 3, 4, 6}; // segmenty (1..6) do skrcania w lewo
@@ -47,6 +51,11 @@ const int iProsto3[4] = {1, -1, 2, 1}; // segmenty do jazdy prosto
 const int iEnds3[13] = {3, 0, 2, 1, 2, 0, -1,
                         1, 0, 2, 0, 3, 1}; // numer ssiedniego toru na kocu segmentu "-1"
 TIsolated *TIsolated::pRoot = NULL;
+TIsolated *TIsolated::pChanged = NULL;
+TIsolated *TIsolated::pChangedLast = NULL;
+int TIsolated::iCount = 0;
+unsigned int *TIsolated::pBusy = NULL;
+int TIsolated::iBusySize = 0;
 
 TSwitchExtension::TSwitchExtension(TTrack *owner, int what)
 { // na pocztku wszystko puste
@@ -77,9 +86,12 @@ TSwitchExtension::TSwitchExtension(TTrack *owner, int what)
     evPlus = evMinus = NULL;
     fVelocity = -1.0; // maksymalne ograniczenie prdkoci (ustawianej eventem)
     vTrans = vector3(0, 0, 0); // docelowa translacja przesuwnicy
+    pVerts = NULL; // tworzone w RaArrayFill()
+    iVerts = 0;
 }
 TSwitchExtension::~TSwitchExtension()
 { // nie ma nic do usuwania
+    delete[] pVerts;
     // delete Segments[0];
     // delete Segments[1];
     delete Segments[2];
@@ -98,6 +110,10 @@ TIsolated::TIsolated(const AnsiString &n, TIsolated *i)
     asName = n;
     pNext = i;
     iAxles = 0;
+    iIndex = 0; // nadawany w Find()
+    pNextChanged = NULL;
+    pChanger = NULL;
+    bChanged = false;
     evBusy = evFree = NULL;
     pMemCell = NULL; // podpi istniejc albo utworzy pust
 };
@@ -125,37 +141,72 @@ TIsolated * TIsolated::Find(const AnsiString &n)
         p = p->pNext;
     }
     pRoot = new TIsolated(n, pRoot);
+    pRoot->iIndex = iCount++;
+    if (iCount > 32 * iBusySize)
+    { // powikszenie tablicy bitowej
+        unsigned int *p = new unsigned int[iBusySize + 64];
+        ZeroMemory(p, (iBusySize + 64) * sizeof(unsigned int));
+        if (pBusy)
+        {
+            memcpy(p, pBusy, iBusySize * sizeof(unsigned int));
+            delete[] pBusy;
+        }
+        pBusy = p;
+        iBusySize += 64;
+    }
     return pRoot;
 };
 
 void TIsolated::Modify(int i, TDynamicObject *o)
 { // dodanie lub odjcie osi
-    if (iAxles)
-    { // grupa zajta
-        iAxles += i;
-        if (!iAxles)
+    // zdarzenia s wysyane dopiero w Flush(), wic dugi skad przejedajcy przez kilka
+    // odcinkw w jednym kroku daje po jednym zajciu/zwolnieniu na odcinek
+    iAxles += i;
+    pChanger = o;
+    if (!bChanged)
+    { // dopisanie na koniec listy zmienionych, eby zdarzenia szy w kolejnoci zmian
+        bChanged = true;
+        pNextChanged = NULL;
+        if (pChanged)
+            pChangedLast->pNextChanged = this;
+        else
+            pChanged = this;
+        pChangedLast = this;
+    }
+};
+
+void TIsolated::Flush()
+{ // porwnanie zajtoci z tablic bitow i wysanie zdarze dla zmienionych odcinkw
+    TIsolated *p;
+    while (pChanged)
+    {
+        p = pChanged;
+        pChanged = p->pNextChanged;
+        p->bChanged = false;
+        unsigned int bit = 1u << (p->iIndex & 31);
+        unsigned int &word = pBusy[p->iIndex >> 5];
+        if ((word & bit) ? p->iAxles > 0 : p->iAxles == 0)
+            continue; // stan si nie zmieni (np. o przesza midzy torami tego samego odcinka)
+        word ^= bit;
+        if (p->iAxles == 0)
         { // jeli po zmianie nie ma adnej osi na odcinku izolowanym
-            if (evFree)
-                Global::AddToQuery(evFree, o); // dodanie zwolnienia do kolejki
+            if (p->evFree)
+                Global::AddToQuery(p->evFree, p->pChanger); // dodanie zwolnienia do kolejki
             if (Global::iMultiplayer) // jeli multiplayer
-                Global::pGround->WyslijString(asName, 10); // wysanie pakietu o zwolnieniu
-            if (pMemCell) // w powizanej komrce
-                pMemCell->UpdateValues(NULL, 0, int(pMemCell->Value2()) & ~0xFF,
-                                       update_memval2); //"zerujemy" ostatni warto
+                Global::pGround->WyslijString(p->asName, 10); // wysanie pakietu o zwolnieniu
+            if (p->pMemCell) // w powizanej komrce
+                p->pMemCell->UpdateValues(NULL, 0, int(p->pMemCell->Value2()) & ~0xFF,
+                                          update_memval2); //"zerujemy" ostatni warto
         }
-    }
-    else
-    { // grupa bya wolna
-        iAxles += i;
-        if (iAxles)
-        {
-            if (evBusy)
-                Global::AddToQuery(evBusy, o); // dodanie zajtoci do kolejki
+        else
+        { // grupa bya wolna
+            if (p->evBusy)
+                Global::AddToQuery(p->evBusy, p->pChanger); // dodanie zajtoci do kolejki
             if (Global::iMultiplayer) // jeli multiplayer
-                Global::pGround->WyslijString(asName, 11); // wysanie pakietu o zajciu
-            if (pMemCell) // w powizanej komrce
-                pMemCell->UpdateValues(NULL, 0, int(pMemCell->Value2()) | 1,
-                                       update_memval2); // zmieniamy ostatni warto na nieparzyst
+                Global::pGround->WyslijString(p->asName, 11); // wysanie pakietu o zajciu
+            if (p->pMemCell) // w powizanej komrce
+                p->pMemCell->UpdateValues(NULL, 0, int(p->pMemCell->Value2()) | 1,
+                                          update_memval2); // zmieniamy ostatni warto na nieparzyst
         }
     }
 };
@@ -193,6 +244,7 @@ TTrack::TTrack(TGroundNode *g)
     fRadiusTable[0] = 0; // dwa promienie nawet dla prostego
     fRadiusTable[1] = 0;
     iNumDynamics = 0;
+    bDynamicsSorted = true; // pusta lista jest uporzdkowana
     ScannedFlag = false;
     DisplayListID = 0;
     iTrapezoid = 0; // parametry ksztatu: 0-standard, 1-przechyka, 2-trapez, 3-oba
@@ -206,6 +258,7 @@ TTrack::TTrack(TGroundNode *g)
     pIsolated = NULL;
     pMyNode = g; // Ra: proteza, eby tor zna swoj nazw TODO: odziedziczy TTrack z TGroundNode
     iAction = 0; // normalnie moe by pomijany podczas skanowania
+    iGraph = -1; // graf jest tworzony po wczytaniu wszystkich torw
     fOverhead = -1.0; // mona normalnie pobiera prd (0 dla jazdy bezprdowej po danym odcinku
     nFouling[0] = NULL; // ukres albo kozio od strony Point1
     nFouling[1] = NULL; // ukres albo kozio od strony Point2
@@ -382,6 +435,8 @@ void TTrack::ConnectPrevPrev(TTrack *pTrack, int typ)
         iPrevDirection = ((pTrack->eType == tt_Switch) ? 0 : (typ & 2));
         pTrack->trPrev = this;
         pTrack->iPrevDirection = 0;
+        TTrackGraph::Update(this); // zmiana pocze obu torw
+        TTrackGraph::Update(pTrack);
     }
 }
 void TTrack::ConnectPrevNext(TTrack *pTrack, int typ)
@@ -392,6 +447,8 @@ void TTrack::ConnectPrevNext(TTrack *pTrack, int typ)
         iPrevDirection = typ | 1; // 1:zwyky lub pierwszy zwrotnicy, 3:drugi zwrotnicy
         pTrack->trNext = this;
         pTrack->iNextDirection = 0;
+        TTrackGraph::Update(this); // zmiana pocze obu torw
+        TTrackGraph::Update(pTrack);
         if (bVisible)
             if (pTrack->bVisible)
                 if (eType == tt_Normal) // jeli czone s dwa normalne
@@ -412,6 +469,8 @@ void TTrack::ConnectNextPrev(TTrack *pTrack, int typ)
         iNextDirection = ((pTrack->eType == tt_Switch) ? 0 : (typ & 2));
         pTrack->trPrev = this;
         pTrack->iPrevDirection = 1;
+        TTrackGraph::Update(this); // zmiana pocze obu torw
+        TTrackGraph::Update(pTrack);
         if (bVisible)
             if (pTrack->bVisible)
                 if (eType == tt_Normal) // jeli czone s dwa normalne
@@ -432,6 +491,8 @@ void TTrack::ConnectNextNext(TTrack *pTrack, int typ)
         iNextDirection = typ | 1; // 1:zwyky lub pierwszy zwrotnicy, 3:drugi zwrotnicy
         pTrack->trNext = this;
         pTrack->iNextDirection = 1;
+        TTrackGraph::Update(this); // zmiana pocze obu torw
+        TTrackGraph::Update(pTrack);
     }
 }
 
@@ -1057,20 +1118,17 @@ bool TTrack::AddDynamicObject(TDynamicObject *Dynamic)
             if (pMyNode->asName != "none")
                 Global::pGround->WyslijString(pMyNode->asName,
                                               8); // przekazanie informacji o zajtoci toru
-    if (iNumDynamics < iMaxNumDynamics)
-    { // jeli jest miejsce, dajemy na koniec
-        Dynamics[iNumDynamics++] = Dynamic;
-        Dynamic->MyTrack = this; // ABu: na ktorym torze jestemy
-        if (Dynamic->iOverheadMask) // jeli ma pantografy
-            Dynamic->OverheadTrack(
-                fOverhead); // przekazanie informacji o jedzie bezprdowej na tym odcinku toru
-        return true;
-    }
-    else
-    {
-        Error("Too many dynamics on track " + pMyNode->asName);
-        return false;
-    }
+    TPhysicsThread::TracksLock(); // push_back() moe przenie tablic rysowan przez okno
+    Dynamics.push_back(Dynamic); // dajemy na koniec, miejsce ustali DynamicsSort()
+    iNumDynamics = Dynamics.size();
+    TTrackGraph::Busy(this);
+    TPhysicsThread::TracksUnlock();
+    bDynamicsSorted = false; // przy dodawaniu pooenie osi moe by jeszcze tymczasowe
+    Dynamic->MyTrack = this; // ABu: na ktorym torze jestemy
+    if (Dynamic->iOverheadMask) // jeli ma pantografy
+        Dynamic->OverheadTrack(
+            fOverhead); // przekazanie informacji o jedzie bezprdowej na tym odcinku toru
+    return true;
 };
 
 void TTrack::MoveMe(vector3 pPosition)
@@ -1899,10 +1957,12 @@ bool TTrack::RemoveDynamicObject(TDynamicObject *Dynamic)
     for (int i = 0; i < iNumDynamics; i++)
     { // sprawdzanie wszystkich po kolei
         if (Dynamic == Dynamics[i])
-        { // znaleziony, przepisanie nastpnych, eby dziur nie byo
-            --iNumDynamics;
-            for (i; i < iNumDynamics; i++)
-                Dynamics[i] = Dynamics[i + 1];
+        { // znaleziony, przepisanie nastpnych, eby dziur nie byo (kolejno zostaje)
+            TPhysicsThread::TracksLock();
+            Dynamics.erase(Dynamics.begin() + i);
+            iNumDynamics = Dynamics.size();
+            TTrackGraph::Busy(this);
+            TPhysicsThread::TracksUnlock();
             if (Global::iMultiplayer) // jeli multiplayer
                 if (!iNumDynamics) // jeli ju nie ma adnego
                     if (pMyNode->asName != "none")
@@ -1915,6 +1975,64 @@ bool TTrack::RemoveDynamicObject(TDynamicObject *Dynamic)
     return false;
 }
 
+void TTrack::DynamicsSort()
+{ // uporzdkowanie pojazdw wg pooenia aktywnej osi, przez wstawianie
+    // pojazdy kolejowe na jednym torze nie mog si min, wic kolejno psuje si tylko przy
+    // dodaniu pojazdu albo zmianie jego aktywnej osi i lista jest zwykle prawie uporzdkowana
+    if (bDynamicsSorted)
+        return;
+    std::vector<double> s(iNumDynamics); // pooenia liczone raz
+    int i, j;
+    double k;
+    TDynamicObject *d;
+    for (i = 0; i < iNumDynamics; ++i)
+        s[i] = Dynamics[i]->RaTranslationGet();
+    for (i = 1; i < iNumDynamics; ++i)
+    {
+        k = s[i];
+        d = Dynamics[i];
+        for (j = i; (j > 0) && (s[j - 1] > k); --j)
+        {
+            s[j] = s[j - 1];
+            Dynamics[j] = Dynamics[j - 1];
+        }
+        s[j] = k;
+        Dynamics[j] = d;
+    }
+    bDynamicsSorted = true;
+};
+
+int TTrack::DynamicsUpper(double s)
+{ // indeks pierwszego pojazdu pooonego dalej ni (s), wyszukiwanie powkowe
+    int a = 0, b = iNumDynamics, m;
+    while (a < b)
+    {
+        m = (a + b) >> 1;
+        if (Dynamics[m]->RaTranslationGet() > s)
+            b = m;
+        else
+            a = m + 1;
+    }
+    return a;
+};
+
+int TTrack::DynamicFind(double s, int dir, TDynamicObject *skip)
+{ // najbliszy pojazd od pooenia (s) w stron Point2 (dir>=0) albo Point1 (dir<0),
+    // z pominiciem (skip); zwraca indeks w (Dynamics) albo -1
+    DynamicsSort();
+    int i = DynamicsUpper(s);
+    if (dir >= 0)
+    {
+        while ((i < iNumDynamics) ? Dynamics[i] == skip : false)
+            ++i;
+        return (i < iNumDynamics) ? i : -1;
+    }
+    --i; // ostatni nie dalej ni (s), ale potrzebny jest pooony bliej Point1
+    while ((i >= 0) ? (Dynamics[i] == skip) || (Dynamics[i]->RaTranslationGet() >= s) : false)
+        --i;
+    return i;
+};
+
 bool TTrack::InMovement()
 { // tory animowane (zwrotnica, obrotnica) maj SwitchExtension
     if (SwitchExtension)
@@ -1997,9 +2115,52 @@ int TTrack::RaArrayPrepare()
     return 0;
 };
 
+void BladeLerp(CVertNormTex *v, const CVertNormTex *k, double w)
+{ // iglica dla przesunicia (w) wzgldem pooe kluczowych (k) i (k+iBladeVerts)
+    // punkty zale liniowo od przesunicia, wic wynik jest dokadny rwnie dla (w) poza 0..1
+    // (dociskanie iglicy o fOffsetDelay), a normalne i mapowanie si nie zmieniaj
+    const CVertNormTex *k1 = k + iBladeVerts;
+    float f = w;
+    for (int i = 0; i < iBladeVerts; ++i)
+    {
+        v[i] = k[i];
+        v[i].x += f * (k1[i].x - k[i].x);
+        v[i].y += f * (k1[i].y - k[i].y);
+        v[i].z += f * (k1[i].z - k[i].z);
+    }
+};
+
+double TableAngle(TSegment *s, vector3 &m)
+{ // kierunek toru obrotnicy w poziomie [rad] oraz jego rodek (m)
+    vector3 p1 = s->FastGetPoint_0(), p2 = s->FastGetPoint_1();
+    m = 0.5 * (p1 + p2);
+    return atan2(p2.x - p1.x, p2.z - p1.z);
+};
+
+void TableTransform(CVertNormTex *v, TSwitchExtension *e, TSegment *s)
+{ // siatka obrotnicy dla aktualnego pooenia (s): obrt siatki wzorcowej wok pionu
+    vector3 m;
+    double a = TableAngle(s, m) - e->fVertsAngle;
+    float c = cos(a), n = sin(a);
+    const CVertNormTex *k = e->pVerts;
+    float x, z;
+    for (int i = 0; i < e->iVerts; ++i)
+    {
+        v[i] = k[i]; // mapowanie bez zmian
+        x = k[i].x - e->vVertsMiddle.x;
+        z = k[i].z - e->vVertsMiddle.z;
+        v[i].x = x * c + z * n + m.x;
+        v[i].y = k[i].y - e->vVertsMiddle.y + m.y;
+        v[i].z = z * c - x * n + m.z;
+        v[i].nx = k[i].nx * c + k[i].nz * n;
+        v[i].nz = k[i].nz * c - k[i].nx * n;
+    }
+};
+
 void TTrack::RaArrayFill(CVertNormTex *Vert, const CVertNormTex *Start)
 { // wypenianie tablic VBO
     // Ra: trzeba rozdzieli szyny od podsypki, aby mc grupowa wg tekstur
+    CVertNormTex *pBegin = Vert; // pocztek siatki toru
     double fHTW = 0.5 * fabs(fTrackWidth);
     double side = fabs(fTexWidth); // szerok podsypki na zewntrz szyny albo pobocza
     double slop = fabs(fTexSlope); // brzeg zewntrzny
@@ -2218,6 +2379,34 @@ void TTrack::RaArrayFill(CVertNormTex *Vert, const CVertNormTex *Start)
                     SwitchExtension->Segments[1]->RaRenderLoft(
                         Vert, rpts2, nnumPts, fTexLength); // prawa szyna normalnie caa
                 }
+                // pooenia kluczowe iglic, animacja bdzie je tylko interpolowa: najpierw
+                // iglica z (iLeftVBO) dla fOffset2=0 i fMaxOffset, potem z (iRightVBO) dla
+                // fOffset1=0 i fMaxOffset
+                if (!SwitchExtension->pVerts)
+                    SwitchExtension->pVerts = new CVertNormTex[4 * iBladeVerts];
+                CVertNormTex *k = SwitchExtension->pVerts;
+                if (SwitchExtension->RightSwitch)
+                {
+                    SwitchExtension->Segments[0]->RaRenderLoft(k, rpts3, -nnumPts, fTexLength, 0,
+                                                               2, 0.0);
+                    SwitchExtension->Segments[0]->RaRenderLoft(k, rpts3, -nnumPts, fTexLength, 0,
+                                                               2, fMaxOffset);
+                    SwitchExtension->Segments[1]->RaRenderLoft(k, rpts4, -nnumPts, fTexLength, 0,
+                                                               2, -fMaxOffset);
+                    SwitchExtension->Segments[1]->RaRenderLoft(k, rpts4, -nnumPts, fTexLength, 0,
+                                                               2, 0.0);
+                }
+                else
+                {
+                    SwitchExtension->Segments[0]->RaRenderLoft(k, rpts4, -nnumPts, fTexLength, 0,
+                                                               2, 0.0);
+                    SwitchExtension->Segments[0]->RaRenderLoft(k, rpts4, -nnumPts, fTexLength, 0,
+                                                               2, -fMaxOffset);
+                    SwitchExtension->Segments[1]->RaRenderLoft(k, rpts3, -nnumPts, fTexLength, 0,
+                                                               2, fMaxOffset);
+                    SwitchExtension->Segments[1]->RaRenderLoft(k, rpts3, -nnumPts, fTexLength, 0,
+                                                               2, 0.0);
+                }
             }
             break;
         }
@@ -2432,6 +2621,14 @@ void TTrack::RaArrayFill(CVertNormTex *Vert, const CVertNormTex *Start)
         }
         break;
     }
+    if (eType == tt_Table)
+    { // siatka wzorcowa obrotnicy, animacja bdzie j obraca zamiast generowa od nowa
+        delete[] SwitchExtension->pVerts;
+        SwitchExtension->iVerts = Vert - pBegin;
+        SwitchExtension->pVerts = new CVertNormTex[SwitchExtension->iVerts];
+        memcpy(SwitchExtension->pVerts, pBegin, SwitchExtension->iVerts * sizeof(CVertNormTex));
+        SwitchExtension->fVertsAngle = TableAngle(Segment, SwitchExtension->vVertsMiddle);
+    }
 };
 
 void TTrack::RaRenderVBO(int iPtr)
@@ -2677,8 +2874,10 @@ bool TTrack::Switch(int i, double t, double d)
             if (SwitchExtension->fVelocity <=
                 -2) //-1 oznacza maksymaln prdko, a dalsze ujemne to ograniczenie na bok
                 fVelocity = i ? -SwitchExtension->fVelocity : -1;
-            if (SwitchExtension->pOwner ? SwitchExtension->pOwner->RaTrackAnimAdd(this) :
-                                          true) // jeli nie dodane do animacji
+            TTrackGraph::Update(this); // nowy stan zwrotnicy w grafie
+            if (TSaveState::Loading() ? true : // odczyt stanu bez animacji i jej eventw
+                    (SwitchExtension->pOwner ? SwitchExtension->pOwner->RaTrackAnimAdd(this) :
+                                               true)) // jeli nie dodane do animacji
             { // nie ma si co bawi
                 SwitchExtension->fOffset = SwitchExtension->fDesiredOffset;
                 RaAnimate(); // przeliczenie pooenia iglic; czy zadziaa na niewywietlanym
@@ -2700,9 +2899,13 @@ bool TTrack::Switch(int i, double t, double d)
                         trNext->trNext = NULL; // rozczamy od Point2
                     else
                         trNext->trPrev = NULL; // rozczamy od Point1
+                TTrack *p = trPrev, *n = trNext; // do aktualizacji grafu
                 trNext = trPrev =
                     NULL; // na kocu rozczamy obrotnic (wkaniki do ssiadw ju niepotrzebne)
                 fVelocity = 0.0; // AI, nie ruszaj si!
+                TTrackGraph::Update(p);
+                TTrackGraph::Update(n);
+                TTrackGraph::Update(this);
                 if (SwitchExtension->pOwner)
                     SwitchExtension->pOwner->RaTrackAnimAdd(this); // dodanie do listy animacyjnej
             }
@@ -2725,6 +2928,7 @@ bool TTrack::Switch(int i, double t, double d)
                         Global::AddToQuery(SwitchExtension->evPlus,
                                            NULL); // potwierdzenie wykonania (np. odpala WZ)
                 }
+                TTrackGraph::Update(this); // prdko (poczenia zrobio TrackJoin)
             }
             SwitchExtension->CurrentIndex = i; // zapamitanie stanu zablokowania
             return true;
@@ -2738,10 +2942,14 @@ bool TTrack::Switch(int i, double t, double d)
             trPrev = SwitchExtension->pPrevs[i];
             iNextDirection = SwitchExtension->iNextDirection[i];
             iPrevDirection = SwitchExtension->iPrevDirection[i];
+            TTrackGraph::Update(this);
             return true;
         }
     if (iCategoryFlag == 1)
+    {
         iDamageFlag = (iDamageFlag & 127) + 128 * (i & 1); // przeczanie wykolejenia
+        TTrackGraph::Update(this); // uszkodzony tor ma w grafie prdko zerow
+    }
     else
         Error("Cannot switch normal track");
     return false;
@@ -2864,70 +3072,19 @@ TTrack * TTrack::RaAnimate()
         if (Global::bUseVBO)
         { // dla OpenGL 1.4 odwiey si cay sektor, w pniejszych poprawiamy fragment
             if (Global::bOpenGL_1_5) // dla OpenGL 1.4 to si nie wykona poprawnie
-                if (TextureID1) // Ra: !!!! tu jest do poprawienia
-                { // iglice liczone tylko dla zwrotnic
-                    vector6 rpts3[24], rpts4[24];
-                    double fHTW = 0.5 * fabs(fTrackWidth);
-                    double fHTW2 = fHTW; // Ra: na razie niech tak bdzie
-                    double cos1 = 1.0, sin1 = 0.0, cos2 = 1.0, sin2 = 0.0; // Ra: ...
-                    for (int i = 0; i < 12; ++i)
-                    {
-                        rpts3[i] =
-                            vector6((fHTW + iglica[i].x) * cos1 + iglica[i].y * sin1,
-                                    -(fHTW + iglica[i].x) * sin1 + iglica[i].y * cos1, iglica[i].z);
-                        rpts3[i + 12] =
-                            vector6((fHTW2 + szyna[i].x) * cos2 + szyna[i].y * sin2,
-                                    -(fHTW2 + szyna[i].x) * sin2 + iglica[i].y * cos2, szyna[i].z);
-                        rpts4[11 - i] = vector6((-fHTW - iglica[i].x) * cos1 + iglica[i].y * sin1,
-                                                -(-fHTW - iglica[i].x) * sin1 + iglica[i].y * cos1,
-                                                iglica[i].z);
-                        rpts4[23 - i] =
-                            vector6((-fHTW2 - szyna[i].x) * cos2 + szyna[i].y * sin2,
-                                    -(-fHTW2 - szyna[i].x) * sin2 + iglica[i].y * cos2, szyna[i].z);
-                    }
-                    CVertNormTex Vert[2 * 2 * 12]; // na razie 2 segmenty
-                    CVertNormTex *v = Vert; // bo RaAnimate() modyfikuje wskanik
-                    glGetBufferSubData(
-                        GL_ARRAY_BUFFER, SwitchExtension->iLeftVBO * sizeof(CVertNormTex),
-                        2 * 2 * 12 * sizeof(CVertNormTex), &Vert); // pobranie fragmentu bufora VBO
-                    if (SwitchExtension->RightSwitch)
-                    { // nowa wersja z SPKS, ale odwrotnie lewa/prawa
-                        SwitchExtension->Segments[0]->RaAnimate(v, rpts3, -nnumPts, fTexLength, 0,
-                                                                2, SwitchExtension->fOffset2);
-                        glBufferSubData(GL_ARRAY_BUFFER,
-                                        SwitchExtension->iLeftVBO * sizeof(CVertNormTex),
-                                        2 * 2 * 12 * sizeof(CVertNormTex),
-                                        &Vert); // wysanie fragmentu bufora VBO
-                        v = Vert;
-                        glGetBufferSubData(GL_ARRAY_BUFFER,
-                                           SwitchExtension->iRightVBO * sizeof(CVertNormTex),
-                                           2 * 2 * 12 * sizeof(CVertNormTex),
-                                           &Vert); // pobranie fragmentu bufora VBO
-                        SwitchExtension->Segments[1]->RaAnimate(v, rpts4, -nnumPts, fTexLength, 0,
-                                                                2, -fMaxOffset +
-                                                                       SwitchExtension->fOffset1);
-                    }
-                    else
-                    { // oryginalnie lewa dziaaa lepiej ni prawa
-                        SwitchExtension->Segments[0]->RaAnimate(
-                            v, rpts4, -nnumPts, fTexLength, 0, 2,
-                            -SwitchExtension->fOffset2); // prawa iglica
-                        glBufferSubData(GL_ARRAY_BUFFER,
-                                        SwitchExtension->iLeftVBO * sizeof(CVertNormTex),
-                                        2 * 2 * 12 * sizeof(CVertNormTex),
-                                        &Vert); // wysanie fragmentu bufora VBO
-                        v = Vert;
-                        glGetBufferSubData(GL_ARRAY_BUFFER,
-                                           SwitchExtension->iRightVBO * sizeof(CVertNormTex),
-                                           2 * 2 * 12 * sizeof(CVertNormTex),
-                                           &Vert); // pobranie fragmentu bufora VBO
-                        SwitchExtension->Segments[1]->RaAnimate(
-                            v, rpts3, -nnumPts, fTexLength, 0, 2,
-                            fMaxOffset - SwitchExtension->fOffset1); // lewa iglica
-                    }
-                    glBufferSubData(
-                        GL_ARRAY_BUFFER, SwitchExtension->iRightVBO * sizeof(CVertNormTex),
-                        2 * 2 * 12 * sizeof(CVertNormTex), &Vert); // wysanie fragmentu bufora VBO
+                if (TextureID1 ? SwitchExtension->pVerts != NULL : false)
+                { // iglice interpolowane z pooe kluczowych z RaArrayFill(), bez odczytu VBO
+                    CVertNormTex Vert[iBladeVerts];
+                    BladeLerp(Vert, SwitchExtension->pVerts,
+                              SwitchExtension->fOffset2 / fMaxOffset);
+                    glBufferSubData(GL_ARRAY_BUFFER,
+                                    SwitchExtension->iLeftVBO * sizeof(CVertNormTex),
+                                    sizeof(Vert), Vert); // wysanie tylko zmienionego fragmentu
+                    BladeLerp(Vert, SwitchExtension->pVerts + 2 * iBladeVerts,
+                              SwitchExtension->fOffset1 / fMaxOffset);
+                    glBufferSubData(GL_ARRAY_BUFFER,
+                                    SwitchExtension->iRightVBO * sizeof(CVertNormTex),
+                                    sizeof(Vert), Vert);
                 }
         }
         else // gdy Display List
@@ -2968,19 +3125,17 @@ TTrack * TTrack::RaAnimate()
                     { // dla OpenGL 1.4 odwiey si cay sektor, w pniejszych poprawiamy fragment
                         // aktualizacja pojazdw na torze
                         if (Global::bOpenGL_1_5) // dla OpenGL 1.4 to si nie wykona poprawnie
-                        {
-                            int size =
-                                RaArrayPrepare(); // wielko tabeli potrzebna dla tej obrotnicy
-                            CVertNormTex *Vert = new CVertNormTex[size]; // bufor roboczy
-                            // CVertNormTex *v=Vert; //zmieniane przez
-                            RaArrayFill(Vert,
-                                        Vert -
-                                            SwitchExtension
-                                                ->iLeftVBO); // iLeftVBO powinno zosta niezmienione
-                            glBufferSubData(
-                                GL_ARRAY_BUFFER, SwitchExtension->iLeftVBO * sizeof(CVertNormTex),
-                                size * sizeof(CVertNormTex), Vert); // wysanie fragmentu bufora VBO
-                        }
+                            if (SwitchExtension->pVerts) // siatka wzorcowa z RaArrayFill()
+                            { // tor obrotnicy jest prosty, wic siatk wystarczy obrci i przesun
+                                int size = SwitchExtension->iVerts;
+                                CVertNormTex *Vert = new CVertNormTex[size]; // bufor roboczy
+                                TableTransform(Vert, SwitchExtension, Segment);
+                                glBufferSubData(GL_ARRAY_BUFFER,
+                                                SwitchExtension->iLeftVBO * sizeof(CVertNormTex),
+                                                size * sizeof(CVertNormTex),
+                                                Vert); // wysanie fragmentu bufora VBO
+                                delete[] Vert;
+                            }
                     }
                     else // gdy Display List
                         Release(); // niszczenie skompilowanej listy, aby si wygenerowaa nowa
@@ -3117,10 +3272,14 @@ void TTrack::VelocitySet(float v)
     if (SwitchExtension ? SwitchExtension->fVelocity >= 0.0 : false)
     { // zwrotnica moe mie odgrne ograniczenie, nieprzeskakiwalne eventem
         if (v > SwitchExtension->fVelocity ? true : v < 0.0)
-            return void(fVelocity =
-                            SwitchExtension->fVelocity); // maksymalnie tyle, ile byo we wpisie
+        {
+            fVelocity = SwitchExtension->fVelocity; // maksymalnie tyle, ile byo we wpisie
+            TTrackGraph::Update(this);
+            return;
+        }
     }
     fVelocity = v; // nie ma ograniczenia
+    TTrackGraph::Update(this);
 };
 
 float TTrack::VelocityGet()
@@ -14,6 +14,7 @@ http://mozilla.org/MPL/2.0/.
 #include "ResourceManager.h"
 #include "opengl/glew.h"
 #include <system.hpp>
+#include <vector>
 #include "Classes.h"
 
 class TEvent;
@@ -85,6 +86,10 @@ class TSwitchExtension
     };
     bool bMovement; // czy w trakcie animacji
     int iLeftVBO, iRightVBO; // indeksy iglic w VBO
+    CVertNormTex *pVerts; // zwrotnica: iglice w pooeniach kluczowych, obrotnica: siatka wzorcowa
+    int iVerts; // ilo wierzchokw siatki wzorcowej obrotnicy
+    double fVertsAngle; // kierunek toru obrotnicy dla siatki wzorcowej [rad]
+    vector3 vVertsMiddle; // rodek toru obrotnicy dla siatki wzorcowej
     TSubRect *pOwner; // sektor, ktremu trzeba zgosi animacj
     TTrack *pNextAnim; // nastpny tor do animowania
     TEvent *evPlus, *evMinus; // zdarzenia sygnalizacji rozprucia
@@ -93,13 +98,20 @@ class TSwitchExtension
   private:
 };
 
-const int iMaxNumDynamics = 40; // McZapkie-100303
-
 class TIsolated
 { // obiekt zbierajcy zajtoci z kilku odcinkw
     int iAxles; // ilo osi na odcinkach obsugiwanych przez obiekt
+    int iIndex; // numer odcinka, pozycja w tablicy bitowej zajtoci
     TIsolated *pNext; // odcinki izolowane s trzymane w postaci listy jednikierunkowej
+    TIsolated *pNextChanged; // lista odcinkw ze zmienion iloci osi w biecym kroku
+    TDynamicObject *pChanger; // ostatni pojazd zmieniajcy ilo osi (aktywator eventw)
+    bool bChanged; // czy jest ju na licie zmienionych
     static TIsolated *pRoot; // pocztek listy
+    static TIsolated *pChanged; // pocztek listy zmienionych
+    static TIsolated *pChangedLast; // koniec listy zmienionych
+    static int iCount; // ilo odcinkw
+    static unsigned int *pBusy; // tablica bitowa zajtoci wg (iIndex)
+    static int iBusySize; // rozmiar tablicy w sowach 32-bitowych
   public:
     AnsiString asName; // nazwa obiektu, baza do nazw eventw
     TEvent *evBusy; // zdarzenie wyzwalane po zajciu grupy
@@ -111,9 +123,26 @@ class TIsolated
     static TIsolated * Find(
         const AnsiString &n); // znalezienie obiektu albo utworzenie nowego
     void Modify(int i, TDynamicObject *o); // dodanie lub odjcie osi
+    static void Flush(); // wysanie zdarze zajcia/zwolnienia po kroku fizyki
     bool Busy()
+    { // zajto zgoszona po ostatnim kroku
+        return IsBusy(iIndex);
+    };
+    int Index()
+    {
+        return iIndex;
+    };
+    static bool IsBusy(int i)
+    { // szybkie sprawdzenie zajtoci odcinka o numerze (i)
+        return (pBusy[i >> 5] >> (i & 31)) & 1;
+    };
+    static int Count()
     {
-        return (iAxles > 0);
+        return iCount;
+    };
+    static const unsigned int * BusyBits()
+    { // tablica bitowa do sprawdzania wielu odcinkw naraz
+        return pBusy;
     };
     static TIsolated * Root()
     {
@@ -127,6 +156,7 @@ class TIsolated
 
 class TTrack : public Resource
 { // trajektoria ruchu - opakowanie
+    friend class TTrackGraph; // kompilacja pocze do grafu
   private:
     TSwitchExtension *SwitchExtension; // dodatkowe dane do toru, ktry jest zwrotnic
     TSegment *Segment;
@@ -147,9 +177,10 @@ class TTrack : public Resource
     TIsolated *pIsolated; // obwd izolowany obsugujcy zajcia/zwolnienia grupy torw
     TGroundNode *
         pMyNode; // Ra: proteza, eby tor zna swoj nazw TODO: odziedziczy TTrack z TGroundNode
+    bool bDynamicsSorted; // czy (Dynamics) jest uporzdkowane wg RaTranslationGet()
   public:
-    int iNumDynamics;
-    TDynamicObject *Dynamics[iMaxNumDynamics];
+    int iNumDynamics; // zawsze rwne Dynamics.size()
+    std::vector<TDynamicObject *> Dynamics; // pojazdy na torze, rosnco wg pooenia aktywnej osi
     int iEvents; // Ra: flaga informujca o obecnoci eventw
     TEvent *evEventall0; // McZapkie-140302: wyzwalany gdy pojazd stoi
     TEvent *evEventall1;
@@ -176,6 +207,7 @@ class TTrack : public Resource
     TEnvironmentType eEnvironment; // dwik i owietlenie
     bool bVisible; // czy rysowany
     int iAction; // czy modyfikowany eventami (specjalna obsuga przy skanowaniu)
+    int iGraph; // numer wza w TTrackGraph, -1 gdy poza grafem
     float fOverhead; // informacja o stanie sieci: 0-jazda bezprdowa, >0-z opuszczonym i
     // ograniczeniem prdkoci
   private:
@@ -234,6 +266,12 @@ class TTrack : public Resource
     bool CheckDynamicObject(TDynamicObject *Dynamic);
     bool AddDynamicObject(TDynamicObject *Dynamic);
     bool RemoveDynamicObject(TDynamicObject *Dynamic);
+    inline void DynamicsDirty()
+    { // pojazd zmieni punkt odniesienia, trzeba bdzie posortowa
+        bDynamicsSorted = false;
+    };
+    void DynamicsSort();
+    int DynamicFind(double s, int dir, TDynamicObject *skip);
     void MoveMe(vector3 pPosition);
 
     void Release();
@@ -265,6 +303,14 @@ class TTrack : public Resource
         if (pIsolated)
             pIsolated->Modify(i, o);
     }; // dodanie lub odjcie osi
+    bool IsolatedBusy()
+    { // zajto odcinka izolowanego, do ktrego naley tor (dla AI i sygnalizacji)
+        return pIsolated ? pIsolated->Busy() : false;
+    };
+    int IsolatedIndex()
+    { // numer odcinka w tablicy bitowej TIsolated, -1 gdy tor nie naley do odcinka
+        return pIsolated ? pIsolated->Index() : -1;
+    };
     AnsiString IsolatedName();
     bool IsolatedEventsAssign(TEvent *busy, TEvent *free);
     double WidthTotal();
@@ -283,6 +329,7 @@ class TTrack : public Resource
   private:
     void EnvironmentSet();
     void EnvironmentReset();
+    int DynamicsUpper(double s);
 };
 
 //---------------------------------------------------------------------------
@@ -0,0 +1,281 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#include "system.hpp"
+#include "classes.hpp"
+#pragma hdrstop
+
+#include "TrackGraph.h"
+#include "Track.h"
+#include "Segment.h"
+#include "Ground.h"
+#include "Logs.h"
+
+//---------------------------------------------------------------------------
+#pragma package(smart_init)
+/*
+Graf torw do przeszukiwania.
+Poczenia torw s rozproszone po obiektach TTrack (trNext, trPrev, iNextDirection,
+iPrevDirection) oraz w doklejkach zwrotnic (pNexts, pPrevs, CurrentIndex), wic kade
+skanowanie skacze po pamici przez due obiekty. Tutaj po wczytaniu scenerii (InitTracks)
+tworzone s cige tablice: wze (dugo, prdko, flagi, stan zwrotnicy) na kady tor
+oraz krawdzie na kady koniec toru. Zwrotnica ma na kadym kocu dwie krawdzie, a wybr
+zaley od jej stanu, wic przeoenie zwrotnicy zmienia tylko (iState) wza.
+Zmiany pocze (Connect*, obrotnice), przeoenia i zmiany prdkoci przepisywane s przez
+Update(), krawdzie s nadpisywane w miejscu, bo ich ilo dla toru si nie zmienia.
+Skrzyowanie jest punktem zatrzymania skanowania, bo dalsza droga zaley od trasy przejazdu.
+Graf jest kompilowany zawsze. Czyta go skanowanie do tyu AI (BackwardTraceRoute), ktre
+przez Pass() przeskakuje tory bez eventw i pojazdw, a po wskanikach sprawdza tylko tory,
+na ktrych moe si zatrzyma. Zajto toru (graph_busy) przepisuje Busy().
+Tory tworzone w trakcie jazdy (NullCreate przy wykolejeniu) nie maj wza, wic skanowanie
+koczy si na nich jak na kocu toru.
+*/
+
+TGraphNode *TTrackGraph::pNodes = NULL;
+TGraphEdge *TTrackGraph::pEdges = NULL;
+int *TTrackGraph::pFirst = NULL;
+TTrack **TTrackGraph::pTracks = NULL;
+int TTrackGraph::iNodes = 0;
+
+int TTrackGraph::Target(TTrack *t)
+{ // tory utworzone po kompilacji grafu nie maj wza
+    return t ? t->iGraph : -1;
+};
+
+void TTrackGraph::Fill(int n)
+{ // przepisanie danych toru (n) do wza i krawdzi
+    TTrack *t = pTracks[n];
+    TGraphNode &d = pNodes[n];
+    TGraphEdge *g = pEdges + pFirst[n + n];
+    d.iFlags = (t->iEvents ? graph_events : 0) | (t->iAction ? graph_action : 0) |
+               (t->iNumDynamics ? graph_busy : 0);
+    d.fVelocity = t->VelocityGet();
+    d.iState = 0;
+    if (t->eType == tt_Switch)
+    { // dwa warianty na kadym kocu, aktualny z torw, drugi z doklejki
+        TSwitchExtension *s = t->SwitchExtension;
+        d.iFlags |= graph_switch;
+        d.iState = s->CurrentIndex & 1;
+        for (int i = 0; i < 2; ++i)
+        {
+            d.fLength[i] = s->Segments[i]->GetLength();
+            if (i == d.iState)
+            { // poczenia mogy zosta zmienione przez Connect*()
+                g[i].iNode = Target(t->trPrev);
+                g[i].iEnd = t->iPrevDirection ? 1 : 0;
+                g[2 + i].iNode = Target(t->trNext);
+                g[2 + i].iEnd = t->iNextDirection ? 1 : 0;
+            }
+            else
+            {
+                g[i].iNode = Target(s->pPrevs[i]);
+                g[i].iEnd = s->iPrevDirection[i] ? 1 : 0;
+                g[2 + i].iNode = Target(s->pNexts[i]);
+                g[2 + i].iEnd = s->iNextDirection[i] ? 1 : 0;
+            }
+        }
+        return;
+    }
+    if (t->eType == tt_Cross)
+        d.iFlags |= graph_cross;
+    else if (t->eType == tt_Table)
+        d.iFlags |= graph_table;
+    d.fLength[0] = d.fLength[1] = t->Length();
+    g[0].iNode = Target(t->trPrev);
+    g[0].iEnd = t->iPrevDirection ? 1 : 0; // niezerowy kierunek to doczony Point2 ssiada
+    g[1].iNode = Target(t->trNext);
+    g[1].iEnd = t->iNextDirection ? 1 : 0;
+};
+
+void TTrackGraph::Build(TGroundNode *tracks)
+{ // kompilacja grafu z listy torw scenerii
+    Free();
+    TGroundNode *c;
+    int n = 0, e = 0, i;
+    for (c = tracks; c; c = c->nNext)
+        ++n;
+    if (!n)
+        return;
+    pNodes = new TGraphNode[n];
+    pTracks = new TTrack *[n];
+    pFirst = new int[n + n + 1];
+    for (c = tracks; c; c = c->nNext)
+    {
+        TTrack *t = c->pTrack;
+        i = (t->eType == tt_Switch) ? 2 : 1; // ilo krawdzi na kocu toru
+        t->iGraph = iNodes;
+        pTracks[iNodes] = t;
+        pFirst[iNodes + iNodes] = e;
+        pFirst[iNodes + iNodes + 1] = e + i;
+        e += i + i;
+        ++iNodes;
+    }
+    pFirst[n + n] = e;
+    pEdges = new TGraphEdge[e];
+    for (i = 0; i < n; ++i)
+        Fill(i);
+    WriteLog("Track graph: " + AnsiString(n) + " nodes, " + AnsiString(e) + " edges, " +
+             AnsiString(int((n * (sizeof(TGraphNode) + sizeof(TTrack *)) +
+                             e * sizeof(TGraphEdge) + (n + n + 1) * sizeof(int)) >>
+                            10)) +
+             " kB");
+};
+
+void TTrackGraph::Free()
+{ // tory jeszcze istniej, wic mona im usun numery wzw
+    for (int i = 0; i < iNodes; ++i)
+        pTracks[i]->iGraph = -1;
+    delete[] pNodes;
+    delete[] pEdges;
+    delete[] pFirst;
+    delete[] pTracks;
+    pNodes = NULL;
+    pEdges = NULL;
+    pFirst = NULL;
+    pTracks = NULL;
+    iNodes = 0;
+};
+
+void TTrackGraph::Update(TTrack *t)
+{ // wywoywane z toru po kadej zmianie, przed kompilacj grafu nic nie robi
+    if (t ? t->iGraph >= 0 : false)
+        Fill(t->iGraph);
+};
+
+void TTrackGraph::Busy(TTrack *t)
+{ // wywoywane z toru po dodaniu albo usuniciu pojazdu, przepisywana jest tylko flaga
+    if (t->iGraph >= 0)
+        if (t->iNumDynamics)
+            pNodes[t->iGraph].iFlags |= graph_busy;
+        else
+            pNodes[t->iGraph].iFlags &= ~graph_busy;
+};
+
+int TTrackGraph::Scan(int n, int e, double fMax, int *path, int size, double &fDist)
+{ // przejcie od koca (e) wza (n) na odlego (fMax), zatrzymuje si na skrzyowaniu
+    // w (path) kolejne wzy jako (2*wze+koniec wyjazdowy), w (fDist) przebyta odlego
+    // liczona od koca (e) wza startowego; zwraca ilo wzw w (path)
+    int k = 0, entry;
+    fDist = 0.0;
+    while ((k < size) && (fDist < fMax))
+    {
+        n = Next(n, e, entry);
+        if (n < 0)
+            break; // koniec toru
+        e = entry ^ 1;
+        path[k++] = n + n + e;
+        if (pNodes[n].iFlags & graph_cross)
+            break; // dugo przejazdu przez skrzyowanie zaley od trasy
+        fDist += Length(n);
+    }
+    return k;
+};
+
+int TTrackGraph::Find(int n, int e, double fMax, int mask, double fVel, double &fDist)
+{ // szukanie od koca (e) wza (n) najbliszego toru z flag z (mask) albo z prdkoci
+    // nisz ni (fVel); skrzyowanie te jest zwracane, bo za nim nie wiadomo, co bdzie
+    // w (fDist) odlego do pocztku znalezionego toru, zwraca -1 gdy nic nie ma w zasigu
+    int entry;
+    fDist = 0.0;
+    while (fDist < fMax)
+    {
+        n = Next(n, e, entry);
+        if (n < 0)
+            return -1;
+        const TGraphNode &d = pNodes[n];
+        if (d.iFlags & (mask | graph_cross))
+            return n;
+        if ((d.fVelocity >= 0.0) && (d.fVelocity < fVel))
+            return n;
+        fDist += Length(n);
+        e = entry ^ 1;
+    }
+    return -1;
+};
+
+TTrack * TTrackGraph::Pass(TTrack *t, double &fDir, double &fDist, double &fLength,
+                           double fMax, int mask)
+{ // przejcie od toru (t) w kierunku (fDir) po torach bez flag z (mask), bez skrzyowa
+    // i z niezerow prdkoci, dopki (fDist) jest mniejsze od (fMax); (fLength) to dugo
+    // do przejechania na (t), do (fDist) doliczane s dugoci opuszczonych torw;
+    // zwraca ostatni przejty tor, a (fDir) zmienia znak tak jak przy skanowaniu wskanikami
+    int n = t ? t->iGraph : -1, e, m, entry;
+    if (n < 0)
+        return t; // tor spoza grafu
+    e = (fDir > 0.0) ? 1 : 0;
+    while (fDist < fMax)
+    {
+        m = Next(n, e, entry);
+        if ((m < 0) || (m == n))
+            break; // koniec albo tor poczony sam ze sob - sprawdzi skanowanie wskanikami
+        const TGraphNode &d = pNodes[m];
+        if ((d.iFlags & (mask | graph_cross)) || (d.fVelocity == 0.0f))
+            break; // na tym torze skanowanie moe si zatrzyma
+        fDist += fLength;
+        fLength = Length(m);
+        n = m;
+        e = entry ^ 1;
+    }
+    if ((e == 1) != (fDir > 0.0))
+        fDir = -fDir;
+    return pTracks[n];
+};
+
+void TTrackGraph::Benchmark()
+{ // pomiar: skanowanie 10km do przodu z co najwyej 1000 torw, po grafie oraz po wskanikach
+    // (Neightbour), niezgodno koca skanowania oznacza bd synchronizacji grafu
+    if (!iNodes)
+        return;
+    const int size = 4096;
+    const double range = 10000.0;
+    int *path = new int[size];
+    int step = iNodes / 1000 + 1, i, k, m, scans = 0, nodes = 0, errors = 0;
+    double dist, d, time[2] = {0.0, 0.0};
+    TTrack *t, *last;
+    LARGE_INTEGER t0, t1, f;
+    for (i = 0; i < iNodes; i += step)
+    {
+        if (pNodes[i].iFlags & graph_cross)
+            continue; // z niego kierunek nie jest okrelony
+        QueryPerformanceCounter(&t0);
+        k = Scan(i, 1, range, path, size, dist);
+        QueryPerformanceCounter(&t1);
+        time[0] += double(t1.QuadPart - t0.QuadPart);
+        QueryPerformanceCounter(&t0);
+        t = pTracks[i];
+        last = NULL;
+        d = 1.0; // w stron Point2
+        dist = 0.0;
+        for (m = 0; (m < size) && (dist < range); ++m)
+        {
+            t = t->Neightbour(d > 0.0 ? 1 : -1, d);
+            if (!t)
+                break;
+            last = t;
+            if (t->eType == tt_Cross)
+            {
+                ++m;
+                break;
+            }
+            dist += t->Length();
+        }
+        QueryPerformanceCounter(&t1);
+        time[1] += double(t1.QuadPart - t0.QuadPart);
+        if ((k != m) || (k ? pTracks[path[k - 1] >> 1] != last : last != NULL))
+            ++errors;
+        nodes += k;
+        ++scans;
+    }
+    delete[] path;
+    QueryPerformanceFrequency(&f);
+    WriteLog("Track graph scan: " + AnsiString(scans) + " x 10 km (" + AnsiString(nodes) +
+             " tracks), graph " + FloatToStrF(1000.0 * time[0] / f.QuadPart, ffFixed, 7, 2) +
+             " ms, pointers " + FloatToStrF(1000.0 * time[1] / f.QuadPart, ffFixed, 7, 2) +
+             " ms, mismatches " + AnsiString(errors));
+};
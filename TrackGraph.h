@@ -0,0 +1,83 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef TrackGraphH
+#define TrackGraphH
+
+#include <system.hpp>
+#include "Classes.h"
+//---------------------------------------------------------------------------
+const int graph_events = 1; // tor ma eventy (iEvents)
+const int graph_action = 2; // tor modyfikowany eventami (iAction)
+const int graph_switch = 4; // zwrotnica: krawdzie zalene od stanu (iState)
+const int graph_cross = 8; // skrzyowanie: przejcie zaley od trasy, skanowanie si zatrzymuje
+const int graph_table = 16; // obrotnica: poczenia znikaj podczas obracania
+const int graph_busy = 32; // na torze s pojazdy (iNumDynamics)
+
+struct TGraphNode
+{ // wze grafu - jeden tor
+    float fLength[2]; // dugo toru, dla zwrotnicy osobno dla kadego stanu
+    float fVelocity; // dozwolona prdko (0 dla uszkodzonego)
+    int iFlags; // flagi graph_*
+    int iState; // stan zwrotnicy (0/1), dla pozostaych 0
+};
+
+struct TGraphEdge
+{ // krawd grafu - przejcie na ssiedni tor
+    int iNode; // numer ssiedniego wza, -1 gdy koniec toru
+    int iEnd; // koniec ssiada, ktrym si wjeda (0:Point1, 1:Point2)
+};
+
+class TTrackGraph
+{ // Ra: klasa statyczna - skompilowany graf torw do szybkiego przeszukiwania
+    // wzy i krawdzie s w cigych tablicach (CSR), krawdzie dla koca (e) wza (n)
+    // zaczynaj si od pFirst[2*n+e]; zwrotnica ma dwie krawdzie na kadym kocu
+  private:
+    static TGraphNode *pNodes;
+    static TGraphEdge *pEdges;
+    static int *pFirst; // pocztki krawdzi, ostatni element to ilo krawdzi
+    static TTrack **pTracks; // tory odpowiadajce wzom
+    static int iNodes;
+    static int Target(TTrack *t); // numer wza toru, -1 gdy brak
+    static void Fill(int n); // przepisanie danych toru do wza i jego krawdzi
+  public:
+    static void Build(TGroundNode *tracks);
+    static void Free();
+    static void Update(TTrack *t); // aktualizacja po zmianie pocze, stanu lub prdkoci
+    static void Busy(TTrack *t); // aktualizacja po zmianie iloci pojazdw na torze
+    static inline int Nodes()
+    {
+        return iNodes;
+    };
+    static inline TTrack * Track(int n)
+    {
+        return pTracks[n];
+    };
+    static inline const TGraphNode & Node(int n)
+    {
+        return pNodes[n];
+    };
+    static inline double Length(int n)
+    {
+        return pNodes[n].fLength[pNodes[n].iState];
+    };
+    static inline int Next(int n, int e, int &entry)
+    { // ssiad za kocem (e) wza (n), w (entry) koniec ssiada, ktrym si wjeda
+        const TGraphEdge &g = pEdges[pFirst[n + n + e] + pNodes[n].iState];
+        entry = g.iEnd;
+        return g.iNode;
+    };
+    static int Scan(int n, int e, double fMax, int *path, int size, double &fDist);
+    static int Find(int n, int e, double fMax, int mask, double fVel, double &fDist);
+    static TTrack * Pass(TTrack *t, double &fDir, double &fDist, double &fLength, double fMax,
+                         int mask);
+    static void Benchmark();
+};
+//---------------------------------------------------------------------------
+#endif
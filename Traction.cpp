@@ -21,6 +21,7 @@ http://mozilla.org/MPL/2.0/.
 #include "Globals.h"
 #include "Usefull.h"
 #include "TractionPower.h"
+#include "PowerNet.h"
 
 //---------------------------------------------------------------------------
 
@@ -95,6 +96,8 @@ jawnie nazw
 sekcji z ssiedniego przsa).
 */
 
+int TTraction::iWalkCount = 0;
+
 TTraction::TTraction()
 {
     pPoint1 = pPoint2 = pPoint3 = pPoint4 = vector3(0, 0, 0);
@@ -116,6 +119,11 @@ TTraction::TTraction()
     psPowered = psPower[0] = psPower[1] = NULL; // na pocztku zasilanie nie podczone
     psSection = NULL; // na pocztku nie podczone
     hvParallel = NULL; // normalnie brak bieni wsplnej
+    hvJoin = NULL;
+    iJoin = 0;
+    iWalk = 0;
+    pNet = NULL; // podczane w TPowerNet::Build()
+    iNet = -1;
     fResistance[0] = fResistance[1] = -1.0; // trzeba dopiero policzy
     iTries = 0; // ile razy prbowa podczy, ustawiane pniej
 }
@@ -624,11 +632,13 @@ void TTraction::ResistanceCalc(int d, double r, TTractionPowerSource *ps)
         else
             ps = psPower[d ^ 1]; // zasilacz od przeciwnej strony ni idzie analiza
         d = iNext[d]; // kierunek
+        iWalk = ++iWalkCount; // przsa oznaczone tym numerem zostay ju odwiedzone
         // double r; //sumaryczna rezystancja
         if (DebugModeFlag) // tylko podczas testw
             Material = 4; // pokazanie, e to przso ma podczone zasilanie
-        while (t ? !t->psPower[d] : false) // jeli jest jaki kolejny i nie ma ustalonego zasilacza
+        while (t ? !t->psPower[d] && (t->iWalk != iWalkCount) : false) // kolejny bez zasilacza
         { // ustawienie zasilacza i policzenie rezystancji zastpczej
+            t->iWalk = iWalkCount; // drugi raz nie wejdzie, nawet gdy sie jest zaptlona
             if (DebugModeFlag) // tylko podczas testw
                 if (t->Material != 4) // przsa zasilajcego nie modyfikowa
                 {
@@ -642,7 +652,6 @@ void TTraction::ResistanceCalc(int d, double r, TTractionPowerSource *ps)
             p = t; // zapamitanie dotychczasowego
             t = p->hvNext[d ^ 1]; // podanie w t sam stron
             d = p->iNext[d ^ 1];
-            // w przypadku zaptlenia sieci moe si zawiesi?
         }
     }
     else
@@ -669,8 +678,12 @@ void TTraction::PowerSet(TTractionPowerSource *ps)
     }
 };
 
-double TTraction::VoltageGet(double u, double i)
+double TTraction::VoltageGet(double u, double i, double s)
 { // pobranie napicia na przle po podczeniu do niego rezystancji (res) - na razie jest to prd
+    if (psSection ? psSection->bIsolated : false)
+        return 0.0; // sekcja odczona eventem
+    if (pNet) // sie liczona wzowo, (s) to pooenie lizgu na przle
+        return pNet->VoltageGet(iNet, s, i);
     if (!psSection)
         if (!psPowered)
             return NominalVoltage; // jak nie ma zasilacza, to napicie podane w przle
@@ -17,6 +17,7 @@ http://mozilla.org/MPL/2.0/.
 using namespace Math3D;
 
 class TTractionPowerSource;
+class TPowerNet;
 
 class TTraction
 { // drut zasilajcy, dla wskanikw uywa przedrostka "hv"
@@ -57,6 +58,12 @@ class TTraction
     TTraction *hvParallel; // jednokierunkowa i zaptlona lista przse ewentualnej bieni wsplnej
     float fResistance[2]; // rezystancja zastpcza do punktu zasilania (0: przso zasilane, <0: do
     // policzenia)
+    TTraction *hvJoin; // przso innego segmentu naprania, od ktrego przejto zasilanie
+    int iJoin; // strona przsa (hvJoin), z ktrej przejto zasilanie
+    int iWalk; // znacznik przejcia w ResistanceCalc(), przerywa ptle w sieci
+    static int iWalkCount; // numer biecego przejcia
+    TPowerNet *pNet; // schemat zastpczy sieci, NULL gdy napicie liczone po staremu
+    int iNet; // numer przsa w schemacie zastpczym
     int iTries;
     // bool bVisible;
     // DWORD dwFlags;
@@ -81,7 +88,7 @@ class TTraction
     bool WhereIs();
     void ResistanceCalc(int d = -1, double r = 0, TTractionPowerSource *ps = NULL);
     void PowerSet(TTractionPowerSource *ps);
-    double VoltageGet(double u, double i);
+    double VoltageGet(double u, double i, double s = 0.5);
 };
 //---------------------------------------------------------------------------
 #endif
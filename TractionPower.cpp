@@ -25,6 +25,7 @@ http://mozilla.org/MPL/2.0/.
 
 #include "Usefull.h"
 #include "Ground.h"
+#include "SaveState.h"
 
 //---------------------------------------------------------------------------
 
@@ -39,6 +40,7 @@ TTractionPowerSource::TTractionPowerSource(TGroundNode *node)
     SlowFuseTimeOut = 60;
     Recuperation = false;
 
+    TotalCurrent = 0; // odczytywany przez telemetri przed pierwszym obcieniem
     TotalAdmitance = 1e-10; // 10Mom - jaka tam upywno
     TotalPreviousAdmitance = 1e-10; // zero jest szkodliwe
     OutputVoltage = 0;
@@ -49,10 +51,21 @@ TTractionPowerSource::TTractionPowerSource(TGroundNode *node)
     psNode[0] = NULL; // sekcje zostan podczone do zasilaczy
     psNode[1] = NULL;
     bSection = false; // sekcja nie jest rdem zasilania, tylko grupuje przsa
+    hvArea = NULL; // obszary s ustalane po poczeniu przse
+    iAreaSide = NULL;
+    iArea = 0;
+    bLive = true;
+    bIsolated = false;
+    iTrips = 0;
+    iVehicles = 0;
 	gMyNode = node;
 };
 
-TTractionPowerSource::~TTractionPowerSource(){};
+TTractionPowerSource::~TTractionPowerSource()
+{
+    delete[] hvArea;
+    delete[] iAreaSide;
+};
 
 void TTractionPowerSource::Init(double u, double i)
 { // ustawianie zasilacza przy braku w scenerii
@@ -107,6 +120,7 @@ bool TTractionPowerSource::Update(double dt)
     {
         FastFuse = true;
         FuseCounter += 1;
+        ++iTrips;
         if (FuseCounter > FastFuseRepetition)
         {
             SlowFuse = true;
@@ -133,6 +147,11 @@ bool TTractionPowerSource::Update(double dt)
             FuseCounter = 0; // dajemy znw szans
         }
     }
+    if (fabs(TotalAdmitance) <= 1e-10)
+    { // bezpiecznik albo brak poboru - inaczej zostaby prd ostatniego obcienia
+        TotalCurrent = 0.0;
+        OutputVoltage = (FastFuse || SlowFuse) ? 0.0 : NominalVoltage; // bez spadku na Rw
+    }
     TotalPreviousAdmitance = TotalAdmitance; // uywamy admitancji z poprzedniego kroku
     if (TotalPreviousAdmitance == 0.0)
         TotalPreviousAdmitance = 1e-10; // przynajmniej minimalna upywno
@@ -140,6 +159,25 @@ bool TTractionPowerSource::Update(double dt)
     return true;
 };
 
+bool TTractionPowerSource::State()
+{ // zapis albo odtworzenie stanu bezpiecznikw i obcienia (TSaveState); true, gdy odczyt
+    // zmieni (bLive), czyli obszar zasilania trzeba przeliczy w TGround::TractionRepower()
+    bool live = bLive;
+    TSaveState::Field(&NominalVoltage, sizeof(NominalVoltage)); // moe by zmienione eventem
+    TSaveState::Field(&TotalCurrent, sizeof(TotalCurrent));
+    TSaveState::Field(&TotalAdmitance, sizeof(TotalAdmitance));
+    TSaveState::Field(&TotalPreviousAdmitance, sizeof(TotalPreviousAdmitance));
+    TSaveState::Field(&OutputVoltage, sizeof(OutputVoltage));
+    TSaveState::Field(&FastFuse, sizeof(FastFuse));
+    TSaveState::Field(&SlowFuse, sizeof(SlowFuse));
+    TSaveState::Field(&FuseTimer, sizeof(FuseTimer));
+    TSaveState::Field(&FuseCounter, sizeof(FuseCounter));
+    TSaveState::Field(&bLive, sizeof(bLive));
+    TSaveState::Field(&bIsolated, sizeof(bIsolated));
+    TSaveState::Field(&iTrips, sizeof(iTrips));
+    return TSaveState::Loading() && (bLive != live);
+};
+
 double TTractionPowerSource::CurrentGet(double res)
 { // pobranie wartoci prdu przypadajcego na rezystancj (res)
     // niech pamita poprzedni admitancj i wg niej przydziela prd
@@ -170,6 +208,13 @@ void TTractionPowerSource::PowerSet(TTractionPowerSource *ps)
     // else ErrorLog("nie moe by wicej punktw zasilania ni dwa");
 };
 
+void TTractionPowerSource::CurrentSet(double i, double u)
+{ // prd i napicie wyjciowe policzone w TPowerNet, zamiast sumowania admitancji w CurrentGet()
+    TotalCurrent = i;
+    OutputVoltage = u;
+    TotalAdmitance = (NominalVoltage > 0.0) ? i / NominalVoltage : 0.0; // przecienie w Update()
+};
+
 //---------------------------------------------------------------------------
 
 #pragma package(smart_init)
@@ -12,6 +12,7 @@ http://mozilla.org/MPL/2.0/.
 #include "parser.h" //Tolaris-010603
 
 class TGroundNode;
+class TTraction;
 
 class TTractionPowerSource
 {
@@ -39,6 +40,13 @@ class TTractionPowerSource
   public: // zmienne publiczne
     TTractionPowerSource *psNode[2]; // zasilanie na kocach dla sekcji
     bool bSection; // czy jest sekcj
+    TTraction **hvArea; // przsa zasilane z tego zasilacza po wczytaniu scenerii
+    int *iAreaSide; // strona przsa (psPower[]) dla elementw (hvArea)
+    int iArea; // ilo stron przse w obszarze
+    bool bLive; // stan przy ostatnim przeliczeniu zasilania przse
+    bool bIsolated; // sekcja odczona (napicie zdjte eventem albo bezpiecznik)
+    int iTrips; // ilo zadziaa bezpiecznikw od wczytania scenerii
+    int iVehicles; // pojazdy z pantografem na przsach zasilacza, liczone dla telemetrii
   public:
     // AnsiString asName;
     TTractionPowerSource(TGroundNode *node);
@@ -47,12 +55,42 @@ class TTractionPowerSource
     bool Load(cParser *parser);
     bool Render();
     bool Update(double dt);
+    bool State();
     double CurrentGet(double res);
     void VoltageSet(double v)
     {
         NominalVoltage = v;
     };
     void PowerSet(TTractionPowerSource *ps);
+    void CurrentSet(double i, double u);
+    double VoltageNominal()
+    {
+        return NominalVoltage;
+    };
+    double Resistance()
+    {
+        return InternalRes;
+    };
+    bool Fused()
+    { // czy ktry z bezpiecznikw jest wyczony
+        return FastFuse || SlowFuse;
+    };
+    bool Live()
+    { // czy moe zasila sie: bezpieczniki zaczone i napicie niezerowe
+        return !FastFuse && !SlowFuse && (NominalVoltage > 0.0);
+    };
+    int FuseState()
+    { // bit 0 - bezpiecznik szybki, bit 1 - bezpiecznik zwoczny
+        return (FastFuse ? 1 : 0) | (SlowFuse ? 2 : 0);
+    };
+    double CurrentTotal()
+    {
+        return TotalCurrent;
+    };
+    double VoltageOutput()
+    {
+        return OutputVoltage;
+    };
 };
 
 //---------------------------------------------------------------------------
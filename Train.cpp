@@ -371,7 +371,7 @@ void TTrain::OnKeyDown(int cKey)
     // isEztOer=(mvControlled->TrainType==dt_EZT)&&(mvControlled->Mains)&&(mvOccupied->BrakeSubsystem==ss_ESt)&&(mvControlled->ActiveDir!=0);
     // isEztOer=((mvControlled->TrainType==dt_EZT)&&(mvControlled->Battery==true)&&(mvControlled->EpFuse==true)&&(mvOccupied->BrakeSubsystem==Oerlikon)&&(mvControlled->ActiveDir!=0));
 
-	if (GetAsyncKeyState(VK_SHIFT) < 0)
+	if (Console::Pressed(VK_SHIFT))
 	{ // wcinity [Shift]
 		if (cKey == Global::Keys[k_IncMainCtrlFAST]) // McZapkie-200702: szybkie
 		// przelaczanie na poz.
@@ -386,7 +386,7 @@ void TTrain::OnKeyDown(int cKey)
 		else if (cKey == Global::Keys[k_DirectionBackward])
 		{
 			if (mvOccupied->Radio == false)
-				if (GetAsyncKeyState(VK_CONTROL) >= 0)
+				if (!Console::Pressed(VK_CONTROL))
 				{
 					dsbSwitch->SetVolume(DSBVOLUME_MAX);
 					dsbSwitch->Play(0, 0, 0);
@@ -539,7 +539,7 @@ void TTrain::OnKeyDown(int cKey)
 			int CouplNr = -2;
 			if (!FreeFlyModeFlag)
 			{
-				if (GetAsyncKeyState(VK_CONTROL) < 0)
+				if (Console::Pressed(VK_CONTROL))
 					if (mvOccupied->BrakeDelaySwitch(bdelay_R + bdelay_M))
 					{
 						dsbPneumaticRelay->SetVolume(DSBVOLUME_MAX);
@@ -566,7 +566,7 @@ void TTrain::OnKeyDown(int cKey)
 				}
 				if (temp)
 				{
-					if (GetAsyncKeyState(VK_CONTROL) < 0)
+					if (Console::Pressed(VK_CONTROL))
 						if (temp->MoverParameters->BrakeDelaySwitch(bdelay_R + bdelay_M))
 						{
 							dsbPneumaticRelay->SetVolume(DSBVOLUME_MAX);
@@ -871,7 +871,7 @@ void TTrain::OnKeyDown(int cKey)
 		{
 			if (!mvOccupied->LightsPosNo > 0)
 			{
-				if ((GetAsyncKeyState(VK_CONTROL) < 0) &&
+				if (Console::Pressed(VK_CONTROL) &&
 					(ggRearLeftLightButton.SubModel)) // hunter-230112 - z controlem zapala z tylu
 				{
 					//------------------------------
@@ -992,7 +992,7 @@ void TTrain::OnKeyDown(int cKey)
 				}
 
 			}
-			else if ((GetAsyncKeyState(VK_CONTROL) < 0) &&
+			else if (Console::Pressed(VK_CONTROL) &&
 				(ggRearUpperLightButton.SubModel)) // hunter-230112 - z controlem zapala z tylu
 			{
 				//------------------------------
@@ -1047,7 +1047,7 @@ void TTrain::OnKeyDown(int cKey)
 		{
 			if (!mvOccupied->LightsPosNo > 0)
 			{
-				if ((GetAsyncKeyState(VK_CONTROL) < 0) &&
+				if (Console::Pressed(VK_CONTROL) &&
 					(ggRearRightLightButton.SubModel)) // hunter-230112 - z controlem zapala z tylu
 				{
 					//------------------------------
@@ -1226,7 +1226,7 @@ void TTrain::OnKeyDown(int cKey)
             // World.cpp
             if (!FreeFlyModeFlag)
             {
-                if (GetAsyncKeyState(VK_CONTROL) < 0)
+                if (Console::Pressed(VK_CONTROL))
                     if ((mvOccupied->LocalBrake == ManualBrake) || (mvOccupied->MBrake == true))
                     {
                         mvOccupied->IncManualBrakeLevel(1);
@@ -1244,7 +1244,7 @@ void TTrain::OnKeyDown(int cKey)
             // World.cpp
             if (!FreeFlyModeFlag)
             {
-                if (GetAsyncKeyState(VK_CONTROL) < 0)
+                if (Console::Pressed(VK_CONTROL))
                     if ((mvOccupied->LocalBrake == ManualBrake) || (mvOccupied->MBrake == true))
                         mvOccupied->DecManualBrakeLevel(1);
                     else
@@ -1338,7 +1338,7 @@ void TTrain::OnKeyDown(int cKey)
             // mvOccupied->IncBrakeLevel());
             mvOccupied->BrakeLevelSet(mvOccupied->BrakeCtrlPosNo / 2 +
                                       (mvOccupied->BrakeHandle == FV4a ? 1 : 0));
-            if (GetAsyncKeyState(VK_CONTROL) < 0)
+            if (Console::Pressed(VK_CONTROL))
                 mvOccupied->BrakeLevelSet(
                     mvOccupied->Handle->GetPos(bh_NP)); // yB: czy ten stos funkcji nie
             // powinien by jako oddzielna
@@ -1419,7 +1419,7 @@ void TTrain::OnKeyDown(int cKey)
         else if (cKey == Global::Keys[k_Fuse])
             //---------------
         {
-            if (GetAsyncKeyState(VK_CONTROL) < 0) // z controlem
+            if (Console::Pressed(VK_CONTROL)) // z controlem
             {
                 ggConverterFuseButton.PutValue(1); // hunter-261211
                 if ((mvControlled->Mains == false) && (ggConverterButton.GetValue() == 0) &&
@@ -1460,7 +1460,7 @@ void TTrain::OnKeyDown(int cKey)
         }
         else if (cKey == Global::Keys[k_DirectionBackward]) // r
         {
-            if (GetAsyncKeyState(VK_CONTROL) < 0)
+            if (Console::Pressed(VK_CONTROL))
             { // wcinity [Ctrl]
                 if (mvOccupied->Radio == true)
                 {
@@ -1542,7 +1542,7 @@ void TTrain::OnKeyDown(int cKey)
             int CouplNr = -2;
             if (!FreeFlyModeFlag)
             {
-                if (GetAsyncKeyState(VK_CONTROL) < 0)
+                if (Console::Pressed(VK_CONTROL))
                     if (mvOccupied->BrakeDelaySwitch(bdelay_R))
                     {
                         dsbPneumaticRelay->SetVolume(DSBVOLUME_MAX);
@@ -1569,7 +1569,7 @@ void TTrain::OnKeyDown(int cKey)
                 }
                 if (temp)
                 {
-                    if (GetAsyncKeyState(VK_CONTROL) < 0)
+                    if (Console::Pressed(VK_CONTROL))
                         if (temp->MoverParameters->BrakeDelaySwitch(bdelay_R))
                         {
                             dsbPneumaticRelay->SetVolume(DSBVOLUME_MAX);
@@ -2079,7 +2079,7 @@ if
 		{
 			if (!mvOccupied->LightsPosNo > 0)
 			{
-				if ((GetAsyncKeyState(VK_CONTROL) < 0) &&
+				if (Console::Pressed(VK_CONTROL) &&
 					(ggRearLeftLightButton.SubModel)) // hunter-230112 - z controlem gasi z tylu
 				{
 					//------------------------------
@@ -2198,7 +2198,7 @@ if
 					SetLights();
 				}
 			}
-			else if ((GetAsyncKeyState(VK_CONTROL) < 0) &&
+			else if (Console::Pressed(VK_CONTROL) &&
 				(ggRearUpperLightButton.SubModel)) // hunter-230112 - z controlem gasi z tylu
             {
                 //------------------------------
@@ -2252,7 +2252,7 @@ if
 		{
 			if (!mvOccupied->LightsPosNo > 0)
 			{
-				if ((GetAsyncKeyState(VK_CONTROL) < 0) &&
+				if (Console::Pressed(VK_CONTROL) &&
 					(ggRearRightLightButton.SubModel)) // hunter-230112 - z controlem gasi z tylu
 				{
 					//------------------------------
@@ -2479,7 +2479,7 @@ if
 
 void TTrain::OnKeyUp(int cKey)
 { // zwolnienie klawisza
-    if (GetAsyncKeyState(VK_SHIFT) < 0)
+    if (Console::Pressed(VK_SHIFT))
     { // wcinity [Shift]
     }
     else
@@ -2600,9 +2600,9 @@ void TTrain::UpdateMechPosition(double dt)
         if (pMechOffset.y < Cabine[iCabn].CabPos1.y + 0.5)
             pMechOffset.y = Cabine[iCabn].CabPos2.y + 0.5;
     }
-    pMechPosition = DynamicObject->mMatrix *
+    pMechPosition = DynamicObject->mRenderMatrix *
                     pNewMechPosition; // pooenie wzgldem rodka pojazdu w ukadzie scenerii
-    pMechPosition += DynamicObject->GetPosition();
+    pMechPosition += DynamicObject->vRenderPos; // tak jak pojazd jest rysowany
 };
 
 bool TTrain::Update()
@@ -6004,11 +6004,11 @@ vector3 TTrain::MirrorPosition(bool lewe)
     switch (iCabn)
     {
     case 1: // przednia (1)
-        return DynamicObject->mMatrix *
+        return DynamicObject->mRenderMatrix *
                vector3(lewe ? Cabine[iCabn].CabPos2.x : Cabine[iCabn].CabPos1.x,
                        1.5 + Cabine[iCabn].CabPos1.y, Cabine[iCabn].CabPos2.z);
     case 2: // tylna (-1)
-        return DynamicObject->mMatrix *
+        return DynamicObject->mRenderMatrix *
                vector3(lewe ? Cabine[iCabn].CabPos1.x : Cabine[iCabn].CabPos2.x,
                        1.5 + Cabine[iCabn].CabPos1.y, Cabine[iCabn].CabPos1.z);
     }
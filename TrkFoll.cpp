@@ -27,6 +27,9 @@ http://mozilla.org/MPL/2.0/.
 #include "Ground.h"
 #include "Event.h"
 #include "Driver.h"
+#include "SaveState.h"
+
+int TTrackFollower::iCacheMax = 16;
 
 TTrackFollower::TTrackFollower()
 {
@@ -36,6 +39,10 @@ TTrackFollower::TTrackFollower()
     pPosition = vAngles = vector3(0, 0, 0);
     fDirection = 1; // jest przodem do Point2
     fOffsetH = 0.0; // na starcie stoi na rodku
+    pCacheSegment = NULL; // pooenie nie byo jeszcze liczone
+    iCacheRevision = 0;
+    fCacheDistance = fCacheDirection = fCacheT = fCacheDtDs = 0.0;
+    iCacheSteps = 0;
 }
 
 TTrackFollower::~TTrackFollower()
@@ -304,7 +311,32 @@ bool TTrackFollower::ComputatePosition()
 { // ustalenie wsprzdnych XYZ
     if (pCurrentSegment) // o ile jest tor
     {
-        pCurrentSegment->RaPositionGet(fCurrentDistance, pPosition, vAngles);
+        bool same = (pCurrentSegment == pCacheSegment) &&
+                    (pCurrentSegment->iRevision == iCacheRevision); // ten sam ksztat
+        if (same && (fCurrentDistance == fCacheDistance) && (fDirection == fCacheDirection))
+            return true; // o stoi, pozycja i kty s z poprzedniego przeliczenia
+        if (!pCurrentSegment->bCurve)
+            pCurrentSegment->RaPositionGet(fCurrentDistance, pPosition, vAngles);
+        else
+        { // na uku parametr jest przesuwany wg pochodnej, a dokadnie z tabeli segmentu
+            // po zmianie segmentu, wikszym przesuniciu albo co (iCacheMax) krokw
+            double ds = fCurrentDistance - fCacheDistance;
+            if (same && (iCacheSteps < iCacheMax) && (fabs(ds) < 1.0))
+            {
+                fCacheT += fCacheDtDs * ds;
+                ++iCacheSteps;
+            }
+            else
+            {
+                fCacheT = pCurrentSegment->GetTFromS(fCurrentDistance);
+                iCacheSteps = 0;
+            }
+            fCacheDtDs = pCurrentSegment->RaPositionT(fCacheT, pPosition, vAngles);
+        }
+        pCacheSegment = pCurrentSegment;
+        iCacheRevision = pCurrentSegment->iRevision;
+        fCacheDistance = fCurrentDistance;
+        fCacheDirection = fDirection;
         if (fDirection < 0) // kty zale jeszcze od zwrotu na torze
         { // kty s w przedziale <-M_PI;M_PI>
             vAngles.x = -vAngles.x; // przechyka jest w przecinw stron
@@ -319,6 +351,78 @@ bool TTrackFollower::ComputatePosition()
     }
     return false;
 }
+
+void TTrackFollower::State()
+{ // zapis albo odtworzenie pooenia osi (TSaveState)
+    int track = TSaveState::TrackIndex(pCurrentTrack);
+    TSaveState::Field(&track, sizeof(track));
+    TSaveState::Field(&fCurrentDistance, sizeof(fCurrentDistance));
+    TSaveState::Field(&fDirection, sizeof(fDirection));
+    TSaveState::Field(&iEventFlag, sizeof(iEventFlag));
+    TSaveState::Field(&iEventallFlag, sizeof(iEventallFlag));
+    TSaveState::Field(&iSegment, sizeof(iSegment));
+    TSaveState::Field(&fOffsetH, sizeof(fOffsetH));
+    if (!TSaveState::Loading())
+        return;
+    TTrack *t = TSaveState::Track(track);
+    if (!t) // tor wykolejenia nie jest zapisywany, o zostaje na obecnym
+        WriteLog("State: " + Owner->asName + " axle kept on its current track");
+    else if (t != pCurrentTrack)
+    { // liczniki osi dopiero po udanym odczycie caego stanu
+        TSaveState::AxleMove(pCurrentTrack, t, Owner);
+        pCurrentTrack = t;
+    }
+    if (pCurrentTrack ? (pCurrentTrack->eType == tt_Cross) && iSegment : false)
+        pCurrentTrack->SwitchForced(abs(iSegment) - 1, NULL); // wybr zapamitanego segmentu
+    pCurrentSegment = (pCurrentTrack ? pCurrentTrack->CurrentSegment() : NULL);
+    ComputatePosition();
+};
+
+void TTrackFollower::Benchmark(TSegment *s)
+{ // pomiar: skad 100 wagonw (200 osi) jadcy maymi krokami po uku (s), liczony przyrostowo
+    // oraz za kadym razem z tabeli segmentu; odchyka pokazuje dryf metody przyrostowej
+    if (!s)
+        return;
+    const int n = 200, steps = 500;
+    double ds = 0.05; // 180km/h przy kroku 1ms
+    if (ds * steps > 0.5 * s->GetLength())
+        ds = 0.5 * s->GetLength() / steps;
+    TTrackFollower *a = new TTrackFollower[2 * n]; // przyrostowo oraz dokadnie
+    int i, j, k, max = iCacheMax;
+    double time[2], drift = 0.0;
+    LARGE_INTEGER t0, t1, f;
+    for (k = 0; k < 2; ++k)
+    {
+        iCacheMax = k ? 0 : max; // 0 oznacza zawsze dokadnie
+        TTrackFollower *b = a + k * n;
+        for (i = 0; i < n; ++i)
+        {
+            b[i].pCurrentSegment = s;
+            b[i].fCurrentDistance = 0.5 * s->GetLength() * i / n;
+            b[i].ComputatePosition();
+        }
+        QueryPerformanceCounter(&t0);
+        for (j = 0; j < steps; ++j)
+            for (i = 0; i < n; ++i)
+            {
+                b[i].fCurrentDistance += ds;
+                b[i].ComputatePosition();
+            }
+        QueryPerformanceCounter(&t1);
+        time[k] = double(t1.QuadPart - t0.QuadPart);
+    }
+    iCacheMax = max;
+    for (i = 0; i < n; ++i)
+        if (drift < (a[i].pPosition - a[n + i].pPosition).Length())
+            drift = (a[i].pPosition - a[n + i].pPosition).Length();
+    delete[] a;
+    QueryPerformanceFrequency(&f);
+    WriteLog("Axle positioning: " + AnsiString(n) + " axles x " + AnsiString(steps) +
+             " steps, incremental " + FloatToStrF(1000.0 * time[0] / f.QuadPart, ffFixed, 7, 2) +
+             " ms, exact " + FloatToStrF(1000.0 * time[1] / f.QuadPart, ffFixed, 7, 2) +
+             " ms, drift " + FloatToStrF(1000.0 * drift, ffFixed, 7, 4) + " mm");
+};
+
 #if RENDER_CONE
 #include "opengl/glew.h"
 #include "opengl/glut.h"
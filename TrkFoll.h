@@ -27,6 +27,14 @@ class TTrackFollower
     int iEventallFlag;
     int iSegment; // ktry segment toru jest uywany (eby nie przeskakiwao po przestawieniu
     // zwrotnicy pod taborem)
+    TSegment *pCacheSegment; // segment, dla ktrego pamitane jest ostatnie pooenie
+    int iCacheRevision; // (iRevision) segmentu przy ostatnim przeliczeniu
+    double fCacheDistance; // (fCurrentDistance) przy ostatnim przeliczeniu
+    double fCacheDirection; // (fDirection) przy ostatnim przeliczeniu
+    double fCacheT; // parametr krzywej Beziera dla (fCacheDistance)
+    double fCacheDtDs; // pochodna parametru po drodze w tym miejscu
+    int iCacheSteps; // ilo krokw przyrostowych od dokadnego przeliczenia
+    static int iCacheMax; // co ile krokw dokadnie z tabeli segmentu
   public:
     double fOffsetH; // Ra: odlego rodka osi od osi toru (dla samochodw) - uy do wykowania
     vector3 pPosition; // wsprzdne XYZ w ukadzie scenerii
@@ -56,7 +64,9 @@ class TTrackFollower
     //{ return pCurrentSegment->ComputeLength(p1,cp1,cp2,p2); };
     // inline double GetRadius(double L, double d);  //McZapkie-150503
     bool Init(TTrack *pTrack, TDynamicObject *NewOwner, double fDir);
+    void State();
     void Render(float fNr);
+    static void Benchmark(TSegment *s);
 };
 //---------------------------------------------------------------------------
 #endif
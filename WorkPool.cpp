@@ -0,0 +1,112 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#include "system.hpp"
+#include "classes.hpp"
+#pragma hdrstop
+
+#include "WorkPool.h"
+#include "Logs.h"
+
+//---------------------------------------------------------------------------
+#pragma package(smart_init)
+/*
+Pula wtkw do oblicze, ktre da si podzieli na niezalene zadania.
+Kady wtek dostaje cigy zakres numerw zada i pobiera je po kolei. Gdy swj
+zakres wyczerpie, podkrada zadania z zakresw pozostaych wtkw, wic nierwne
+zadania (np. skady o rnej dugoci) nie blokuj caoci na najwolniejszym.
+Pobieranie jest przez InterlockedIncrement() i nie wymaga sekcji krytycznych.
+*/
+
+TWorkPool::TWorkPool(int n)
+{
+    IsMultiThread = true; // meneder pamici Pascala musi blokowa, bo fizyka alokuje teksty
+    iThreads = n < 1 ? 1 : n;
+    pRanges = new TWorkRange[iThreads];
+    hThreads = new HANDLE[iThreads];
+    hStart = new HANDLE[iThreads];
+    hDone = CreateEvent(NULL, FALSE, FALSE, NULL);
+    lRunning = 0;
+    lStarted = 0;
+    fJob = NULL;
+    pData = NULL;
+    bExit = false;
+    DWORD id;
+    for (int i = 1; i < iThreads; ++i) // zerowy jest wtek wywoujcy
+        hStart[i] = CreateEvent(NULL, FALSE, FALSE, NULL); // wszystkie przed uruchomieniem wtkw
+    for (int i = 1; i < iThreads; ++i)
+        hThreads[i] = CreateThread(NULL, 0, ThreadProc, this, 0, &id);
+    WriteLog("Work pool: " + AnsiString(iThreads) + " threads");
+};
+
+TWorkPool::~TWorkPool()
+{
+    bExit = true;
+    for (int i = 1; i < iThreads; ++i)
+        SetEvent(hStart[i]);
+    if (iThreads > 1)
+        WaitForMultipleObjects(iThreads - 1, hThreads + 1, TRUE, 5000);
+    for (int i = 1; i < iThreads; ++i)
+    {
+        CloseHandle(hThreads[i]);
+        CloseHandle(hStart[i]);
+    }
+    CloseHandle(hDone);
+    delete[] hThreads;
+    delete[] hStart;
+    delete[] pRanges;
+};
+
+DWORD WINAPI TWorkPool::ThreadProc(LPVOID p)
+{ // ptla wtku pomocniczego
+    TWorkPool *pool = (TWorkPool *)p;
+    int t = InterlockedIncrement(&pool->lStarted); // numery od 1
+    while (true)
+    {
+        WaitForSingleObject(pool->hStart[t], INFINITE);
+        if (pool->bExit)
+            return 0;
+        pool->Work(t);
+        if (!InterlockedDecrement(&pool->lRunning))
+            SetEvent(pool->hDone); // ostatni zgasza zakoczenie
+    }
+};
+
+void TWorkPool::Work(int t)
+{ // wykonywanie zada: najpierw swoich, potem podkradanych
+    long k;
+    for (int i = 0; i < iThreads; ++i)
+    {
+        TWorkRange &r = pRanges[(t + i) % iThreads];
+        while ((k = InterlockedIncrement(&r.lNext) - 1) < r.lEnd)
+            fJob(pData, k);
+    }
+};
+
+void TWorkPool::Run(TWorkJob job, void *data, int count)
+{ // rozdzielenie (count) zada na wtki i wykonanie
+    if ((iThreads < 2) || (count < 2))
+    { // nie ma co dzieli
+        for (int i = 0; i < count; ++i)
+            job(data, i);
+        return;
+    }
+    fJob = job;
+    pData = data;
+    for (int i = 0; i < iThreads; ++i)
+    { // rwne zakresy, podkradanie wyrwna reszt
+        pRanges[i].lNext = (count * i) / iThreads;
+        pRanges[i].lEnd = (count * (i + 1)) / iThreads;
+    }
+    lRunning = iThreads - 1;
+    for (int i = 1; i < iThreads; ++i)
+        SetEvent(hStart[i]);
+    Work(0);
+    WaitForSingleObject(hDone, INFINITE);
+};
@@ -0,0 +1,50 @@
+/*
+This Source Code Form is subject to the
+terms of the Mozilla Public License, v.
+2.0. If a copy of the MPL was not
+distributed with this file, You can
+obtain one at
+http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef WorkPoolH
+#define WorkPoolH
+
+#include <system.hpp>
+//---------------------------------------------------------------------------
+typedef void (*TWorkJob)(void *data, int index); // zadanie numer (index)
+
+struct TWorkRange
+{ // zakres zada przydzielony wtkowi, pozostae wtki mog z niego podkrada
+    volatile long lNext; // nastpne zadanie do pobrania
+    long lEnd; // koniec zakresu
+    char cPad[56]; // eby zakresy rnych wtkw nie dzieliy linii pamici podrcznej
+};
+
+class TWorkPool
+{ // Ra: pula wtkw z podkradaniem zada, wtek wywoujcy Run() te pracuje
+  private:
+    int iThreads; // ilo wtkw cznie z wywoujcym
+    HANDLE *hThreads; // wtki pomocnicze
+    HANDLE *hStart; // zdarzenia uruchamiajce wtki pomocnicze
+    HANDLE hDone; // ustawiane przez ostatni koczcy wtek pomocniczy
+    volatile long lRunning; // ilo pracujcych wtkw pomocniczych
+    volatile long lStarted; // do nadania numerw wtkom
+    TWorkRange *pRanges; // zakresy zada dla wtkw
+    TWorkJob fJob; // biece zadanie
+    void *pData; // dane dla zadania
+    bool bExit; // zakoczenie wtkw
+    static DWORD WINAPI ThreadProc(LPVOID p);
+    void Work(int t);
+
+  public:
+    TWorkPool(int n);
+    ~TWorkPool();
+    int Threads()
+    {
+        return iThreads;
+    };
+    void Run(TWorkJob job, void *data, int count); // wykonanie (count) zada, czeka na koniec
+};
+//---------------------------------------------------------------------------
+#endif
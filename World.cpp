@@ -31,6 +31,14 @@ http://mozilla.org/MPL/2.0/.
 #include "Train.h"
 #include "Driver.h"
 #include "Console.h"
+#include "Consist.h"
+#include "PhysThread.h"
+#include "Replay.h"
+#include "SaveState.h"
+#include "Segment.h"
+#include "TrackGraph.h"
+#include "PowerNet.h"
+#include "PowerTelemetry.h"
 
 #define TEXTURE_FILTER_CONTROL_EXT 0x8500
 #define TEXTURE_LOD_BIAS_EXT 0x8501
@@ -64,17 +72,25 @@ TWorld::TWorld()
     pDynamicNearest = NULL;
     fTimeBuffer = 0.0; // bufor czasu aktualizacji dla staego kroku fizyki
     fMaxDt = 0.01; //[s] pocztkowy krok czasowy fizyki
+    pPhysics = NULL; // fizyka w ptli okna, dopki Init() nie uruchomi wtku
+    fFastLeft = fFastDone = 0.0; // czas rzeczywisty
+    iFastStart = 0;
+    bFastQuit = false;
+    bFastSound = Global::bSoundEnabled;
     fTime50Hz = 0.0; // bufor czasu dla komunikacji z PoKeys
 }
 
 TWorld::~TWorld()
 {
+    delete pPhysics; // zatrzymanie wtku fizyki przed usuwaniem czegokolwiek
+    pPhysics = NULL;
     Global::bManageNodes = false; // Ra: wyczenie wyrejestrowania, bo si sypie
     TrainDelete();
     // Ground.Free(); //Ra: usunicie obiektw przed usuniciem dwikw - sypie si
     TSoundsManager::Free();
     TModelsManager::Free();
     TTexturesManager::Free();
+    TConsist::LogClose();
     glDeleteLists(base, 96);
     if (hinstGLUT32)
         FreeLibrary(hinstGLUT32);
@@ -569,6 +585,14 @@ bool TWorld::Init(HWND NhWnd, HDC hDC)
     //    Global::tSinceStart= 0;
     Clouds.Init();
     WriteLog("Ground init OK");
+    Ground.Interpolate(-1, -1, 1.0); // pooenia do rysowania, od nich ustawiana jest kamera
+    if (Global::fPhysicsStep > 0.0)
+        fMaxDt = Global::fPhysicsStep; // krok wymuszony w eu07.ini
+    else
+        fMaxDt = Global::iIntegrator ? 0.05 : 0.01; // pjawny jest stabilny przy duszym kroku
+    Global::fPhysicsStep = fMaxDt; // do zapisu w consistlog.csv
+    WriteLog(AnsiString(Global::iIntegrator ? "Implicit" : "Explicit") +
+             " integrator, physics step " + FloatToStrF(fMaxDt, ffFixed, 7, 3) + "s");
     if (Global::detonatoryOK)
     {
         glRasterPos2f(-0.25f, -0.17f);
@@ -672,13 +696,131 @@ bool TWorld::Init(HWND NhWnd, HDC hDC)
     ResetTimers();
     WriteLog("Load time: " + FloatToStrF((86400.0 * ((double)Now() - time)), ffFixed, 7, 1) +
              " seconds");
+    if ((Global::fBenchmark > 0.0) || DebugModeFlag)
+    { // pomiary tylko na danie, nie przy kadym wczytaniu
+        TSegment::ArcReport(); // dokadno i szybko tabel dugoci ukw
+        TTrackFollower::Benchmark(TSegment::ArcLongest()); // przesuwanie osi po uku
+        TTrackGraph::Benchmark(); // skanowanie po grafie i po wskanikach
+        Ground.MeshBenchmark(); // siatki torw sektora w wtkach
+        Ground.TractionBenchmark(); // awaria i powrt najwikszego zasilacza
+        if (Ground.PowerNet())
+            Ground.PowerNet()->Benchmark(); // przypadki kontrolne i 100 pocigw w sieci
+        Ground.PantBenchmark(); // styk z drutem dla 200 elektrycznych zespow
+        Ground.ConsistBenchmark(); // siy na sprzgach z TConsist i z Mover dla tego samego stanu
+        TConsist::Compare(); // cakowanie pjawne wzgldem jawnego na skadzie prbnym
+        TConsist::PipeCompare(); // przewd gwny 60 wagonw niejawnie i wagon po wagonie
+        Ground.SleepBenchmark(); // 30s fizyki scenerii z usypianiem stojcych grup i bez
+    }
     if (DebugModeFlag) // w Debugmode automatyczne wczenie AI
         if (Train)
             if (Train->Dynamic()->Mechanik)
                 Train->Dynamic()->Mechanik->TakeControl(true);
+    if (TSaveState::bLoadRequested && !Replay::Playing())
+        TSaveState::Load(&Ground); // kontynuacja zapisanej sesji
+    if (Global::fBenchmark > 0.0)
+        FastForward(Global::fBenchmark, true); // pomiar wydajnoci i zakoczenie
+    else if (Global::fFastForward > 0.0)
+        FastForward(60.0 * Global::fFastForward); // przewinicie o zadan ilo minut
+    if (Global::bPhysicsThread) // na kocu, bo wczeniej sceneri zmienia si bez blokady
+        if (Replay::Recording() || Replay::Playing()) // nagranie wymaga krokw zgodnych z klatkami
+            WriteLog("Physics thread disabled during replay");
+        else
+        {
+            Ground.bDynamicRemoveLater = true; // pojazdw uywa wtek okna, wic on je usuwa
+            pPhysics = new TPhysicsThread(this, fMaxDt);
+        }
+    return true;
+};
+
+void TWorld::FastForward(double t, bool quit)
+{ // przewinicie (t) sekund czasu symulacji bez renderowania i dwikw, (t)<=0 przerywa
+    if (t <= 0.0)
+    {
+        if (fFastLeft > 0.0)
+            FastForwardEnd();
+        return;
+    }
+    if (Replay::Recording() || Replay::Playing())
+    { // nagranie wymaga krokw zgodnych z klatkami
+        WriteLog("Fast forward disabled during replay");
+        return;
+    }
+    if (fFastLeft <= 0.0)
+    { // rozpoczcie
+        LARGE_INTEGER t0;
+        QueryPerformanceCounter(&t0);
+        iFastStart = t0.QuadPart;
+        fFastDone = 0.0;
+        Ground.Silence(Camera.Pos); // zatrzymanie grajcych dwikw
+        bFastSound = Global::bSoundEnabled;
+        Global::bSoundEnabled = false; // eventy i pojazdy nie bd ich uruchamia
+        Ground.PoolAll(); // grupy pojazdw na wszystkich procesorach
+    }
+    fFastLeft = t;
+    bFastQuit = quit;
+    WriteLog("Fast forward: " + FloatToStrF(t, ffFixed, 7, 0) + "s, step " +
+             FloatToStrF(fMaxDt, ffFixed, 7, 3) + "s");
+};
+
+bool TWorld::FastForwardStep()
+{ // porcja przewijania: fizyka, eventy i AI przez ok. 0.1s czasu rzeczywistego, potem postp
+    // na ekranie i powrt do ptli komunikatw (mona przerwa klawiszem [Esc])
+    LARGE_INTEGER f, t0, t1;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t0);
+    double dt = fMaxDt; // najwikszy stabilny krok, wynikajcy z integratora
+    int n;
+    do
+    { // Ground::Update() przy kilku krokach liczy grupy pojazdw w wtkach
+        n = 20;
+        if (n * dt > fFastLeft)
+            n = int(ceil(fFastLeft / dt)); // kocwka
+        Ground.Update(dt, n);
+        Ground.CheckQuery();
+        Timer::SetSimulationTime(Timer::GetSimulationTime() + n * dt);
+        GlobalTime->UpdateMTableTime(n * dt); // czas rozkadowy
+        fFastDone += n * dt;
+        fFastLeft -= n * dt;
+        QueryPerformanceCounter(&t1);
+    } while ((fFastLeft > 0.0) && (t1.QuadPart - t0.QuadPart < f.QuadPart / 10));
+    double wall = double(t1.QuadPart - iFastStart) / double(f.QuadPart);
+    double rate = wall > 0.0 ? fFastDone / wall : 0.0; // sekund symulacji na sekund
+    if (fFastLeft <= 0.0)
+    {
+        WriteLog("Fast forward: " + FloatToStrF(fFastDone, ffFixed, 7, 1) + "s simulated in " +
+                 FloatToStrF(wall, ffFixed, 7, 1) + "s, " + FloatToStrF(rate, ffFixed, 7, 1) +
+                 " sim s/s, physics " + FloatToStrF(Ground.fPhysicsTime, ffFixed, 7, 3) +
+                 "ms/step");
+        FastForwardEnd();
+        return !bFastQuit; // po pomiarze zakoczenie programu
+    }
+    AnsiString s = "Przewijanie / Fast forward: " + AnsiString(GlobalTime->hh) + ":" +
+                   AnsiString(GlobalTime->mm < 10 ? "0" : "") + AnsiString(GlobalTime->mm) +
+                   ", " + FloatToStrF(fFastLeft / 60.0, ffFixed, 7, 1) + " min left, x" +
+                   FloatToStrF(rate, ffFixed, 7, 0) + " [Esc]";
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glTranslatef(0.0f, 0.0f, -0.50f);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_FOG);
+    glDisable(GL_TEXTURE_2D);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glRasterPos2f(-0.25f, 0.0f);
+    glPrint(s.c_str());
+    glPopAttrib();
     return true;
 };
 
+void TWorld::FastForwardEnd()
+{ // powrt do czasu rzeczywistego
+    fFastLeft = 0.0;
+    Global::bSoundEnabled = bFastSound;
+    Ground.PoolFree(); // wtki utworzone tylko na czas przewijania
+    UpdateTimers(true); // bez skoku czasu za okres przewijania
+};
+
 void TWorld::OnKeyDown(int cKey)
 { //(cKey) to kod klawisza, cyfrowe i literowe si zgadzaj
     // Ra 2014-09: tu by mona doda tabel konwersji: 256 wirtualnych kodw w kontekcie dwch
@@ -686,6 +828,12 @@ void TWorld::OnKeyDown(int cKey)
     // na kady kod wirtualny niech przypadaj 4 bajty: 2 dla nacinicia i 2 dla zwolnienia
     // powtrzone 256 razy da 1kB na kady stan przecznikw, cznie bdzie 4kB pierwszej tabeli
     // przekodowania
+    if (fFastLeft > 0.0)
+    { // podczas przewijania czasu mona je tylko przerwa
+        if (cKey == VK_ESCAPE)
+            FastForward(0.0);
+        return;
+    }
     if (!Global::iPause)
     { // podczas pauzy klawisze nie dziaaj
         AnsiString info = "Key pressed: [";
@@ -809,6 +957,24 @@ void TWorld::OnKeyDown(int cKey)
         case VK_F4:
             InOutKey();
             break;
+        case VK_F11: // zapis i odczyt stanu sesji
+            if (Console::Pressed(VK_CONTROL))
+            {
+                if (!Console::Pressed(VK_SHIFT))
+                    TSaveState::Save(&Ground);
+                else if (!Replay::Recording() && !Replay::Playing()) // nagranie by si rozjechao
+                    TSaveState::Load(&Ground);
+            }
+            break;
+        case VK_F7: // [Ctrl]+[F7] - zapis statystyk dla autorw scenerii, samo [F7] to siatki
+            if (Console::Pressed(VK_CONTROL))
+            {
+                if (DebugModeFlag || Global::bEventProfile)
+                    Ground.EventProfileDump();
+                if (Global::fPowerTelemetry > 0.0)
+                    PowerTelemetry::Dump(); // obcienie zasilaczy
+            }
+            break;
         case VK_F6:
             if (DebugModeFlag)
             { // przyspieszenie symulacji do testowania scenerii... uwaga na FPS!
@@ -856,7 +1022,13 @@ void TWorld::OnKeyDown(int cKey)
         if (Train)
             if (Controlled)
                 if ((Controlled->Controller == Humandriver) ? true : DebugModeFlag || (cKey == 'Q'))
-                    Train->OnKeyDown(cKey); // przekazanie klawisza do kabiny
+                    if (pPhysics)
+                    { // kabin obsuguje wtek fizyki, midzy krokami
+                        TPhysicsCommand c = {cKey, true};
+                        pPhysics->Commands.Push(c);
+                    }
+                    else
+                        Train->OnKeyDown(cKey); // przekazanie klawisza do kabiny
     if (FreeFlyModeFlag) // aby nie odluniao wagonu za lokomotyw
     { // operacje wykonywane na dowolnym pojedzie, przeniesione tu z kabiny
         if (cKey == Global::Keys[k_Releaser]) // odluniacz
@@ -864,7 +1036,7 @@ void TWorld::OnKeyDown(int cKey)
             TDynamicObject *temp = Global::DynamicNearest();
             if (temp)
             {
-                if (GetAsyncKeyState(VK_CONTROL) < 0) // z ctrl odcinanie
+                if (Console::Pressed(VK_CONTROL)) // z ctrl odcinanie
                 {
                     temp->MoverParameters->BrakeStatus ^= 128;
                 }
@@ -904,9 +1076,9 @@ void TWorld::OnKeyDown(int cKey)
                     CouplNr = 0; // z [-1,1] zrobi [0,1]
                 int mask, set = 0; // Ra: [Shift]+[Ctrl]+[T] odpala mi jak idiotyczn zmian
                 // tapety pulpitu :/
-                if (GetAsyncKeyState(VK_SHIFT) < 0) // z [Shift] zapalanie
+                if (Console::Pressed(VK_SHIFT)) // z [Shift] zapalanie
                     set = mask = 64; // bez [Ctrl] zaoy tabliczki
-                else if (GetAsyncKeyState(VK_CONTROL) < 0)
+                else if (Console::Pressed(VK_CONTROL))
                     set = mask = 2 + 32; // z [Ctrl] zapali wiata czerwone
                 else
                     mask = 2 + 32 + 64; // wyczanie ciga wszystko
@@ -926,7 +1098,7 @@ void TWorld::OnKeyDown(int cKey)
             TDynamicObject *temp = Global::DynamicNearest();
             if (temp)
             {
-                if (GetAsyncKeyState(VK_CONTROL) < 0)
+                if (Console::Pressed(VK_CONTROL))
                     if ((temp->MoverParameters->LocalBrake == ManualBrake) ||
                         (temp->MoverParameters->MBrake == true))
                         temp->MoverParameters->IncManualBrakeLevel(1);
@@ -946,7 +1118,7 @@ void TWorld::OnKeyDown(int cKey)
             TDynamicObject *temp = Global::DynamicNearest();
             if (temp)
             {
-                if (GetAsyncKeyState(VK_CONTROL) < 0)
+                if (Console::Pressed(VK_CONTROL))
                     if ((temp->MoverParameters->LocalBrake == ManualBrake) ||
                         (temp->MoverParameters->MBrake == true))
                         temp->MoverParameters->DecManualBrakeLevel(1);
@@ -975,7 +1147,13 @@ void TWorld::OnKeyUp(int cKey)
         if (Train)
             if (Controlled)
                 if ((Controlled->Controller == Humandriver) ? true : DebugModeFlag || (cKey == 'Q'))
-                    Train->OnKeyUp(cKey); // przekazanie zwolnienia klawisza do kabiny
+                    if (pPhysics)
+                    {
+                        TPhysicsCommand c = {cKey, false};
+                        pPhysics->Commands.Push(c);
+                    }
+                    else
+                        Train->OnKeyUp(cKey); // przekazanie zwolnienia klawisza do kabiny
 };
 
 void TWorld::OnMouseMove(double x, double y)
@@ -1018,19 +1196,19 @@ void TWorld::DistantView()
     if (Controlled) // jest pojazd do prowadzenia?
     { // na prowadzony
         Camera.Pos =
-            Controlled->GetPosition() +
+            Controlled->vRenderPos +
             (Controlled->MoverParameters->ActiveCab >= 0 ? 30 : -30) * Controlled->VectorFront() +
             vector3(0, 5, 0);
-        Camera.LookAt = Controlled->GetPosition();
+        Camera.LookAt = Controlled->vRenderPos;
         Camera.RaLook(); // jednorazowe przestawienie kamery
     }
     else if (pDynamicNearest) // jeli jest pojazd wykryty blisko
     { // patrzenie na najbliszy pojazd
-        Camera.Pos = pDynamicNearest->GetPosition() +
+        Camera.Pos = pDynamicNearest->vRenderPos +
                      (pDynamicNearest->MoverParameters->ActiveCab >= 0 ? 30 : -30) *
                          pDynamicNearest->VectorFront() +
                      vector3(0, 5, 0);
-        Camera.LookAt = pDynamicNearest->GetPosition();
+        Camera.LookAt = pDynamicNearest->vRenderPos;
         Camera.RaLook(); // jednorazowe przestawienie kamery
     }
 };
@@ -1101,6 +1279,13 @@ bool TWorld::Update()
         WriteLog("Scenery moved");
     };
 #endif
+    if (fFastLeft > 0.0)
+    { // bez renderowania, fizyka liczona w wtku okna
+        Lock();
+        bool ok = FastForwardStep();
+        Unlock();
+        return ok;
+    }
     if (iCheckFPS)
         --iCheckFPS;
     else
@@ -1152,10 +1337,14 @@ bool TWorld::Update()
         */
         iCheckFPS = 0.25 * GetFPS(); // tak za 0.25 sekundy sprawdzi ponownie (jeszcze przycina?)
     }
+    Lock(); // zegar i usuwanie pojazdw zmieniaj stan scenerii
+    Ground.DynamicRemoveDisabled(); // pojazdy wyczone przez wtek fizyki
     UpdateTimers(Global::iPause);
     if (!Global::iPause)
-    { // jak pauza, to nie ma po co tego przelicza
         GlobalTime->UpdateMTableTime(GetDeltaTime()); // McZapkie-300302: czas rozkladowy
+    Unlock();
+    if (!Global::iPause)
+    { // jak pauza, to nie ma po co tego przelicza
         // Ra 2014-07: przeliczenie kta czasu (do animacji zalenych od czasu)
         Global::fTimeAngleDeg =
             GlobalTime->hh * 15.0 + GlobalTime->mm * 0.25 + GlobalTime->mr / 240.0;
@@ -1265,16 +1454,25 @@ bool TWorld::Update()
         }
     } // koniec dziaa niewykonywanych podczas pauzy
     // Console::Update(); //tu jest zalene od FPS, co nie jest korzystne
+    { // pooenia pojazdw do rysowania, przed ustawieniem kamery i kabiny
+        int k0 = -1, k1 = -1;
+        double a = 1.0;
+        if (pPhysics)
+            if (!pPhysics->Interpolation(k0, k1, a))
+                k0 = -1; // jeszcze nie ma dwch migawek
+        Ground.Interpolate(k0, k1, a);
+    }
     if (Global::bActive)
     { // obsuga ruchu kamery tylko gdy okno jest aktywne
         if (Console::Pressed(VK_LBUTTON))
         {
             Camera.Reset(); // likwidacja obrotw - patrzy horyzontalnie na poudnie
+            TPhysicsThread::TracksLock(); // DynamicNearest() przeglda pojazdy na torach
             // if (!FreeFlyModeFlag) //jeli wewntrz - patrzymy do tyu
             // Camera.LookAt=Train->pMechPosition-Normalize(Train->GetDirection())*10;
             if (Controlled ? LengthSquared3(Controlled->GetPosition() - Camera.Pos) < 2250000 :
                              false) // gdy bliej ni 1.5km
-                Camera.LookAt = Controlled->GetPosition();
+                Camera.LookAt = Controlled->vRenderPos;
             else
             {
                 TDynamicObject *d =
@@ -1290,13 +1488,18 @@ bool TWorld::Update()
                 if (d)
                     pDynamicNearest = d; // zmiana na nowy, jeli co znaleziony niepusty
                 if (pDynamicNearest)
-                    Camera.LookAt = pDynamicNearest->GetPosition();
+                    Camera.LookAt = pDynamicNearest->vRenderPos;
             }
+            TPhysicsThread::TracksUnlock();
             if (FreeFlyModeFlag)
                 Camera.RaLook(); // jednorazowe przestawienie kamery
         }
         else if (Console::Pressed(VK_RBUTTON)) //||Console::Pressed(VK_F4))
+        {
+            TPhysicsThread::TracksLock();
             FollowView(false); // bez wyciszania dwikw
+            TPhysicsThread::TracksUnlock();
+        }
         else if (Global::iTextMode == -1)
         { // tu mozna dodac dopisywanie do logu przebiegu lokomotywy
             WriteLog("Number of textures used: " + AnsiString(Global::iTextures));
@@ -1358,16 +1561,21 @@ bool TWorld::Update()
     // else n=1;
     // blablabla
     // Ground.UpdatePhys(dt,n); //na razie tu //2014-12: yB przenis do Ground.Update() :(
-    Ground.Update(dt, n); // tu zrobi tylko coklatkow aktualizacj przesuni
-    if (DebugModeFlag)
-        if (Global::bActive) // nie przyspiesza, gdy jedzie w tle :)
-            if (GetAsyncKeyState(VK_ESCAPE) < 0)
-            { // yB doda przyspieszacz fizyki
-                Ground.Update(dt, n);
-                Ground.Update(dt, n);
-                Ground.Update(dt, n);
-                Ground.Update(dt, n); // 5 razy
-            }
+    if (!pPhysics) // przy wtku fizyki sceneri przelicza PhysicsStep()
+    {
+        Ground.Update(dt, n); // tu zrobi tylko coklatkow aktualizacj przesuni
+        if (Global::bConsistLog && Controlled)
+            TConsist::Log(Controlled->MoverParameters); // przebieg si w prowadzonym skadzie
+        if (DebugModeFlag)
+            if (Global::bActive) // nie przyspiesza, gdy jedzie w tle :)
+                if (Console::Pressed(VK_ESCAPE))
+                { // yB doda przyspieszacz fizyki
+                    Ground.Update(dt, n);
+                    Ground.Update(dt, n);
+                    Ground.Update(dt, n);
+                    Ground.Update(dt, n); // 5 razy
+                }
+    }
     dt = GetDeltaTime(); // czas niekwantowany
     if (Camera.Type == tp_Follow)
     {
@@ -1396,7 +1604,7 @@ bool TWorld::Update()
 #else
                 // Camera.Yaw powinno by wyzerowane, aby po powrocie patrze do przodu
                 Camera.Pos =
-                    Controlled->GetPosition() + Train->MirrorPosition(lr); // pozycja lusterka
+                    Controlled->vRenderPos + Train->MirrorPosition(lr); // pozycja lusterka
                 Camera.Yaw = 0; // odchylenie na bok od Camera.LookAt
                 if (Train->Dynamic()->MoverParameters->ActiveCab == 0)
                     Camera.LookAt = Camera.Pos - Train->GetDirection(); // gdy w korytarzu
@@ -1462,7 +1670,8 @@ bool TWorld::Update()
     { // kamera nieruchoma
         Global::SetCameraRotation(Camera.Yaw - M_PI);
     }
-    Ground.CheckQuery();
+    if (!pPhysics)
+        Ground.CheckQuery();
     // przy 0.25 smuga ganie o 6:37 w Quarku, a mogaby ju 5:40
     // Ra 2014-12: przy 0.15 si skaryli, e nie wida smug => zmieniem na 0.25
     if (Train) // jeli nie usunity
@@ -1484,13 +1693,13 @@ bool TWorld::Update()
         if ((Train->Dynamic()->mdKabina != Train->Dynamic()->mdModel) &&
             Train->Dynamic()->bDisplayCab && !FreeFlyModeFlag)
         {
-            vector3 pos = Train->Dynamic()->GetPosition(); // wszprzdne pojazdu z kabin
+            vector3 pos = Train->Dynamic()->vRenderPos; // wszprzdne pojazdu z kabin
             // glTranslatef(pos.x,pos.y,pos.z); //przesunicie o wektor (tak byo i trzso)
             // aby pozby si cho troch trzsienia, trzeba by nie przelicza kabiny do punktu
             // zerowego scenerii
             glLoadIdentity(); // zacz od macierzy jedynkowej
             Camera.SetCabMatrix(pos); // widok z kamery po przesuniciu
-            glMultMatrixd(Train->Dynamic()->mMatrix.getArray()); // ta macierz nie ma przesunicia
+            glMultMatrixd(Train->Dynamic()->mRenderMatrix.getArray()); // bez przesunicia
 
             //*yB: moje smuuugi 1
             if (Global::bSmudge)
@@ -1737,6 +1946,11 @@ bool TWorld::Update()
             OutText1 += " (slowmotion " + AnsiString(Global::iSlowMotion) + ")";
         OutText1 += ", sectors: ";
         OutText1 += AnsiString(Ground.iRendered);
+        if (Ground.iSleeping)
+            OutText1 += ", sleeping: " + AnsiString(Ground.iSleeping);
+        if (Ground.iDistant)
+            OutText1 += ", distant: " + AnsiString(Ground.iDistant);
+        OutText1 += ", physics: " + FloatToStrF(Ground.fPhysicsTime, ffFixed, 7, 3) + "ms";
     }
 
     // if (Console::Pressed(VK_F7))
@@ -1784,6 +1998,7 @@ bool TWorld::Update()
        OutText1+= FloatToStrF(Global::ABuDebug,ffFixed,6,15);
     };
     */
+    Lock(); // zmiana pojazdu i ekrany tekstowe (take [F5] przesiadka) korzystaj ze scenerii
     if (Global::changeDynObj)
     { // ABu zmiana pojazdu - przejcie do innego
         // Ra: to nie moe by tak robione, to zbytnia proteza jest
@@ -2603,10 +2818,55 @@ bool TWorld::Update()
     // WriteLog("Pressed function key F"+AnsiString(Global::iViewMode-111));
     // Global::iTextMode=Global::iViewMode;
     //}
+    Unlock();
     glEnable(GL_LIGHTING);
     return (true);
 };
 
+void TWorld::PhysicsStep(double dt, int n, int k)
+{ // (n) krokw fizyki po (dt) wywoywanych z wtku fizyki, migawka pooe do bufora (k)
+    if (fFastLeft > 0.0)
+        return; // czas przewija wtek okna
+    TPhysicsCommand c;
+    while (pPhysics->Commands.Pop(c))
+        if (c.evEvent) // event dodany przez wtek okna
+            Ground.AddToQuery(c.evEvent, c.dynActivator);
+        else if (Train) // moga zosta opuszczona w midzyczasie
+            if (c.bDown)
+                Train->OnKeyDown(c.iKey);
+            else
+                Train->OnKeyUp(c.iKey);
+    Ground.Update(dt, n);
+    if (Global::bConsistLog && Controlled)
+        TConsist::Log(Controlled->MoverParameters); // przebieg si w prowadzonym skadzie
+    Ground.CheckQuery();
+    Ground.Snapshot(k);
+};
+
+void TWorld::Lock()
+{ // zablokowanie scenerii dla wtku okna na czas jej zmiany (klawisze, polecenia, zegar)
+    if (pPhysics)
+        pPhysics->Lock();
+};
+
+void TWorld::Unlock()
+{
+    if (pPhysics)
+        pPhysics->Unlock();
+};
+
+bool TWorld::EventToPhysics(TEvent *e, TDynamicObject *who)
+{ // przekazanie eventu dodawanego przez wtek okna (np. podczas rysowania) do wtku fizyki
+    if (!pPhysics)
+        return false; // jest tylko jeden wtek
+    if (pPhysics->InThread())
+        return false; // fizyka dodaje sama
+    TPhysicsCommand c = {0, false, e, who};
+    if (!pPhysics->Commands.Push(c))
+        ErrorLog("Physics thread: command queue full, event lost: " + e->asName);
+    return true;
+};
+
 bool TWorld::Render()
 {
     glColor3b(255, 255, 255);
@@ -2616,6 +2876,7 @@ bool TWorld::Render()
     glLoadIdentity();
     Camera.SetMatrix(); // ustawienie macierzy kamery wzgldem pocztku scenerii
     glLightfv(GL_LIGHT0, GL_POSITION, Global::lightPos);
+    // pooenia pojazdw do rysowania s ju wyliczone w Update(), przed ustawieniem kamery
 
     if (!Global::bWireFrame)
     { // bez nieba w trybie rysowania linii
@@ -2623,24 +2884,23 @@ bool TWorld::Render()
         Clouds.Render();
         glEnable(GL_FOG);
     }
-    if (Global::bUseVBO)
-    { // renderowanie przez VBO
-        if (!Ground.RenderVBO(Camera.Pos))
-            return false;
-        if (!Ground.RenderAlphaVBO(Camera.Pos))
-            return false;
-    }
-    else
-    { // renderowanie przez Display List
-        if (!Ground.RenderDL(Camera.Pos))
-            return false;
-        if (!Ground.RenderAlphaDL(Camera.Pos))
-            return false;
-    }
+    bool ok;
+    TPhysicsThread::TracksLock(); // fizyka nie przeniesie teraz pojazdu na inny tor
+    if (Global::bUseVBO) // renderowanie przez VBO
+        ok = Ground.RenderVBO(Camera.Pos) && Ground.RenderAlphaVBO(Camera.Pos);
+    else // renderowanie przez Display List
+        ok = Ground.RenderDL(Camera.Pos) && Ground.RenderAlphaDL(Camera.Pos);
+    TPhysicsThread::TracksUnlock(); // przed Lock(), bo fizyka bierze je w odwrotnej kolejnoci
+    if (!ok)
+        return false;
     TSubModel::iInstance = (int)(Train ? Train->Dynamic() : 0); //eby nie robi cudzych animacji
     // if (Camera.Type==tp_Follow)
     if (Train)
+    { // kabina zmienia stan pojazdu
+        Lock();
         Train->Update();
+        Unlock();
+    }
     // if (Global::bRenderAlpha)
     // if (Controlled)
     //  Train->RenderAlpha();
@@ -2952,6 +3212,26 @@ void TWorld::OnCommandGet(DaneRozkaz *pRozkaz)
 			}
 			//    Ground.IsolatedBusy(AnsiString(pRozkaz->cString+1,(unsigned)(pRozkaz->cString[0])));
 			break;
+        case 14: // przewinicie czasu do godziny podanej jak w ramce 5 (uamek doby), 0 przerywa
+            CommLog(AnsiString(Now()) + " " + IntToStr(pRozkaz->iComm) + " fast forward " +
+                    FloatToStrF(pRozkaz->fPar[0], ffFixed, 7, 4) + " rcvd");
+            if (pRozkaz->fPar[0] > 0.0)
+            {
+                double t = 86400.0 * (pRozkaz->fPar[0] - floor(pRozkaz->fPar[0])) -
+                           (3600.0 * GlobalTime->hh + 60.0 * GlobalTime->mm + GlobalTime->mr);
+                if (t < 0.0)
+                    t += 86400.0; // nastpnego dnia
+                FastForward(t);
+            }
+            else
+                FastForward(0.0);
+            break;
+        case 15: // stan i telemetria zasilacza sieci trakcyjnej o podanej nazwie
+            CommLog(AnsiString(Now()) + " " + IntToStr(pRozkaz->iComm) + " " +
+                    AnsiString(pRozkaz->cString + 1, (unsigned)(pRozkaz->cString[0])) + " rcvd");
+            Ground.WyslijZasilanie(
+                AnsiString(pRozkaz->cString + 1, (unsigned)(pRozkaz->cString[0])));
+            break;
 		}
 };
 
@@ -36,6 +36,10 @@ class TWorld
     void OnMouseMove(double x, double y);
     void OnCommandGet(DaneRozkaz *pRozkaz);
     bool Update();
+    void PhysicsStep(double dt, int n, int k);
+    void Lock();
+    void Unlock();
+    bool EventToPhysics(TEvent *e, TDynamicObject *who);
     void TrainDelete(TDynamicObject *d = NULL);
     TWorld();
     ~TWorld();
@@ -61,6 +65,14 @@ class TWorld
     double fTime50Hz; // bufor czasu dla komunikacji z PoKeys
     double fTimeBuffer; // bufor czasu aktualizacji dla staego kroku fizyki
     double fMaxDt; //[s] krok czasowy fizyki (0.01 dla normalnych warunkw)
+    TPhysicsThread *pPhysics; // wtek fizyki, NULL gdy fizyka liczona w oknie
+    double fFastLeft; //[s] czas symulacji pozostay do przewinicia (0 - czas rzeczywisty)
+    double fFastDone; //[s] czas symulacji ju przewinity
+    __int64 iFastStart; // licznik QPC na pocztku przewijania
+    bool bFastQuit; // zakoczenie programu po przewiniciu (pomiar wydajnoci)
+    bool bFastSound; // stan dwiku sprzed przewijania
+    bool FastForwardStep();
+    void FastForwardEnd();
     int iPause; // wykrywanie zmian w zapauzowaniu
     double VelPrev; // poprzednia prdko
     int tprev; // poprzedni czas
@@ -69,6 +81,7 @@ class TWorld
     void ModifyTGA(const AnsiString &dir = "");
     void CreateE3D(const AnsiString &dir = "", bool dyn = false);
     void CabChange(TDynamicObject *old, TDynamicObject *now);
+    void FastForward(double t, bool quit = false);
 };
 //---------------------------------------------------------------------------
 #endif